@@ -764,6 +764,7 @@ void Copter::update_altitude()
 #if HAL_LOGGING_ENABLED
     if (should_log(MASK_LOG_CTUN)) {
         Log_Write_Control_Tuning();
+        Log_Write_Land_Detector();
         if (!should_log(MASK_LOG_FTN_FAST)) {
 #if AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
             AP::ins().write_notch_log_messages();
@@ -68,6 +68,7 @@
 #include <AC_Sprayer/AC_Sprayer.h>          // Crop sprayer library
 #include <AP_ADSB/AP_ADSB.h>                // ADS-B RF based collision avoidance module library
 #include <AP_Proximity/AP_Proximity.h>      // ArduPilot proximity sensor library
+#include <AC_LandDetector/AC_GroundPlane.h> // plane fit to the returns below the vehicle
 #include <AC_PrecLand/AC_PrecLand_config.h>
 #include <AP_OpticalFlow/AP_OpticalFlow.h>
 #include <AP_Winch/AP_Winch_config.h>
@@ -262,6 +263,14 @@ private:
         int8_t glitch_count;    // non-zero number indicates rangefinder is glitching
         uint32_t glitch_cleared_ms; // system time glitch cleared
         float terrain_offset_cm;    // filtered terrain offset (e.g. terrain's height above EKF origin)
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+        const AP_RangeFinder_Backend *sample_backend; // backend the samples below were read from
+        uint32_t sample_seq;        // next sample to read from sample_backend
+        uint32_t last_sample_us;    // time of the last sample applied to alt_cm_filt
+#endif
+#if AP_RANGEFINDER_FUSION_ENABLED
+        RangeFinder::Fused fused;   // all instances with this orientation combined, used if RNGFND_FUSE is set
+#endif
     } rangefinder_state, rangefinder_up_state;
 
     // return rangefinder height interpolated using inertial altitude
@@ -822,6 +831,11 @@ private:
     // landing_detector.cpp
     void update_land_and_crash_detectors();
     void update_land_detector();
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+    void update_ground_plane();
+    bool get_ground_plane(AC_GroundPlane::Estimate &plane) const;
+    bool get_ground_plane_height_cm(int32_t &height_cm) const;
+#endif
     void set_land_complete(bool b);
     void set_land_complete_maybe(bool b);
     void update_throttle_mix();
@@ -844,6 +858,7 @@ private:
 
     // Log.cpp
     void Log_Write_Control_Tuning();
+    void Log_Write_Land_Detector();
     void Log_Write_Attitude();
     void Log_Write_EKF_POS();
     void Log_Write_PIDS();
@@ -926,6 +941,10 @@ private:
     void read_barometer(void);
     void init_rangefinder(void);
     void read_rangefinder(void);
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    bool filter_rangefinder_samples(RangeFinderState &rf_state, enum Rotation orientation, float tilt_correction);
+    void skip_rangefinder_samples(RangeFinderState &rf_state, enum Rotation orientation);
+#endif
     bool rangefinder_alt_ok() const;
     bool rangefinder_up_ok() const;
     void update_rangefinder_terrain_offset();
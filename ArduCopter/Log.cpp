@@ -405,6 +405,42 @@ void Copter::Log_Write_Guided_Attitude_Target(ModeGuided::SubMode target_type, f
     logger.WriteBlock(&pkt, sizeof(pkt));
 }
 
+struct PACKED log_Land_Detector {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float gnd_contact;
+    float plane_height;
+    float plane_roughness;
+};
+
+// Write the land detector inputs which can't be reconstructed from other messages
+void Copter::Log_Write_Land_Detector()
+{
+    float gnd_contact = logger.quiet_nanf();
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+    if (rangefinder.ground_contact_valid_orient(ROTATION_PITCH_270)) {
+        gnd_contact = rangefinder.ground_contact_confidence_orient(ROTATION_PITCH_270);
+    }
+#endif
+    float plane_height = logger.quiet_nanf();
+    float plane_roughness = logger.quiet_nanf();
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+    AC_GroundPlane::Estimate plane;
+    if (get_ground_plane(plane)) {
+        plane_height = plane.height_m;
+        plane_roughness = plane.roughness_m;
+    }
+#endif
+    const struct log_Land_Detector pkt {
+        LOG_PACKET_HEADER_INIT(LOG_LAND_DETECTOR_MSG),
+        time_us         : AP_HAL::micros64(),
+        gnd_contact     : gnd_contact,
+        plane_height    : plane_height,
+        plane_roughness : plane_roughness,
+    };
+    logger.WriteBlock(&pkt, sizeof(pkt));
+}
+
 // type and unit information can be found in
 // libraries/AP_Logger/Logstructure.h; search for "log_Units" for
 // units and "Format characters" for field type information
@@ -558,6 +594,16 @@ const struct LogStructure Copter::log_structure[] = {
 
     { LOG_GUIDED_ATTITUDE_TARGET_MSG, sizeof(log_Guided_Attitude_Target),
       "GUIA",  "QBffffffff",    "TimeUS,Type,Roll,Pitch,Yaw,RollRt,PitchRt,YawRt,Thrust,ClimbRt", "s-dddkkk-n", "F-000000-0" , true },
+
+// @LoggerMessage: LDET
+// @Description: Land detector ground contact inputs
+// @Field: TimeUS: Time since system startup
+// @Field: GCon: downward rangefinder ground contact confidence, NaN if not available
+// @Field: GPH: height above the ground plane, NaN if there is no recent estimate
+// @Field: GPR: ground plane roughness, NaN if there is no recent estimate
+
+    { LOG_LAND_DETECTOR_MSG, sizeof(log_Land_Detector),
+      "LDET",  "Qfff",    "TimeUS,GCon,GPH,GPR", "s-mm", "F-00" , true },
 };
 
 uint8_t Copter::get_num_log_structures() const
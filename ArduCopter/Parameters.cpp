@@ -1249,6 +1249,26 @@ const AP_Param::GroupInfo ParametersG2::var_info2[] = {
     // @User: Advanced
     AP_GROUPINFO("FS_EKF_FILT", 8, ParametersG2, fs_ekf_filt_hz, FS_EKF_FILT_DEFAULT),
 
+#if RANGEFINDER_ENABLED == ENABLED
+    // @Param: RNGFND_DELAY
+    // @DisplayName: Rangefinder delay
+    // @Description: Time from a rangefinder measurement being taken to it being received. Rangefinder readings are compared with the inertial altitude this long before they were received, so that height above ground and surface tracking are not affected by the sensor's latency while climbing or descending
+    // @Units: ms
+    // @Range: 0 250
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("RNGFND_DELAY", 9, ParametersG2, rangefinder_delay_ms, RANGEFINDER_DELAY_MS_DEFAULT),
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+    // @Param: RNGFND_FUSE
+    // @DisplayName: Rangefinder fusion
+    // @Description: Combine all rangefinders facing down (or up) into one altitude instead of using the first healthy one. Each reading is weighted by its sensor's measured noise and readings which disagree with the others are ignored
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("RNGFND_FUSE", 10, ParametersG2, rangefinder_fusion, 0),
+#endif
+#endif
+
     // ID 62 is reserved for the AP_SUBGROUPEXTENSION
 
     AP_GROUPEND
@@ -666,6 +666,10 @@ public:
 
 #if RANGEFINDER_ENABLED == ENABLED
     AP_Float rangefinder_filt;
+    AP_Int16 rangefinder_delay_ms;
+#if AP_RANGEFINDER_FUSION_ENABLED
+    AP_Int8 rangefinder_fusion;
+#endif
 #endif
 
 #if MODE_GUIDED_ENABLED == ENABLED
@@ -86,6 +86,10 @@
  # define RANGEFINDER_FILT_DEFAULT 0.5f     // filter for rangefinder distance
 #endif
 
+#ifndef RANGEFINDER_DELAY_MS_DEFAULT
+ # define RANGEFINDER_DELAY_MS_DEFAULT 0    // rangefinder latency beyond the driver's timestamps
+#endif
+
 #ifndef SURFACE_TRACKING_TIMEOUT_MS
  # define SURFACE_TRACKING_TIMEOUT_MS  1000 // surface tracking target alt will reset to current rangefinder alt after this many milliseconds without a good rangefinder alt
 #endif
@@ -373,6 +377,12 @@
 #ifndef LAND_AIRMODE_DETECTOR_TRIGGER_SEC
  # define LAND_AIRMODE_DETECTOR_TRIGGER_SEC 3.0f    // number of seconds to detect a landing in air mode
 #endif
+#ifndef LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC
+ # define LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC 0.5f   // number of seconds to detect a landing once the rangefinder has settled at ground clearance
+#endif
+#ifndef LAND_DETECTOR_GND_CONTACT_MIN
+ # define LAND_DETECTOR_GND_CONTACT_MIN     0.5f    // rangefinder ground contact confidence needed to count as on the ground
+#endif
 #ifndef LAND_DETECTOR_MAYBE_TRIGGER_SEC
  # define LAND_DETECTOR_MAYBE_TRIGGER_SEC   0.2f    // number of seconds that means we might be landed (used to reset horizontal position targets to prevent tipping over)
 #endif
@@ -382,6 +392,15 @@
 #ifndef LAND_DETECTOR_ACCEL_MAX
 # define LAND_DETECTOR_ACCEL_MAX            1.0f    // vehicle acceleration must be under 1m/s/s
 #endif
+#ifndef LAND_GROUND_PLANE_ENABLED
+ # define LAND_GROUND_PLANE_ENABLED         RANGEFINDER_ENABLED // fit a plane to the downward rangefinder and proximity returns for landing
+#endif
+#ifndef LAND_GROUND_PLANE_MARGIN_CM
+ # define LAND_GROUND_PLANE_MARGIN_CM       10.0f   // ground plane height above rangefinder ground clearance which counts as on the ground
+#endif
+#ifndef LAND_GROUND_PLANE_ROUGHNESS_MAX_CM
+ # define LAND_GROUND_PLANE_ROUGHNESS_MAX_CM 10.0f  // ground plane is not used by the land detector on surfaces rougher than this
+#endif
 
 //ADDED BY FRANKY/////////////////////////////////////////////
 #ifndef LAND_DETECTOR_RNGFND_DEFAULT
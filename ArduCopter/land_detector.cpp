@@ -1,6 +1,8 @@
 #include "Copter.h"
 
 #include <AP_Stats/AP_Stats.h>              // statistics library
+#include <AC_LandDetector/AC_LandDetector.h>
+#include <AP_RangeFinder/AP_RangeFinder_Backend.h>
 
 // Code to detect a crash main ArduCopter code
 #define LAND_CHECK_ANGLE_ERROR_DEG  30.0f       // maximum angle error to be considered landing
@@ -9,7 +11,18 @@
 
 
 // counter to verify landings
-static uint32_t land_detector_count = 0;
+static AC_LandDetector land_detector;
+
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+// plane fitted to the returns below the vehicle
+static AC_GroundPlane ground_plane;
+// time of the last reading from each rangefinder added to ground_plane
+static uint32_t ground_plane_reading_ms[RANGEFINDER_MAX_INSTANCES];
+#define GROUND_PLANE_PROXIMITY_RADIUS_M     3.0f    // radius around the vehicle from which proximity returns are passed to the ground plane
+#define GROUND_PLANE_FIT_INTERVAL_MS        20      // minimum time between ground plane fits
+#define GROUND_PLANE_DESCENT_RATE_CMS       -10.0f  // climb rate below which the vehicle is considered to be descending
+static uint32_t ground_plane_fit_ms;
+#endif
 
 // run land and crash detectors
 // called at MAIN_LOOP_RATE
@@ -20,6 +33,9 @@ void Copter::update_land_and_crash_detectors()
     accel_ef.z += GRAVITY_MSS;
     land_accel_ef_filter.apply(accel_ef, scheduler.get_loop_period_s());
 
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+    update_ground_plane();
+#endif
     update_land_detector();
 
 #if PARACHUTE == ENABLED
@@ -62,7 +78,7 @@ void Copter::update_land_detector()
         }
     } else if (standby_active) {
         // land detector will not run in standby mode
-        land_detector_count = 0;
+        land_detector.reset();
     } else {
 
         float land_trigger_sec = LAND_DETECTOR_TRIGGER_SEC;
@@ -100,63 +116,141 @@ void Copter::update_land_detector()
         }
 #endif
 
-        // check that the airframe is not accelerating (not falling or braking after fast forward flight)
-        bool accel_stationary = (land_accel_ef_filter.get().length() <= LAND_DETECTOR_ACCEL_MAX * land_detector_scalar);
-
-        // check that vertical speed is within 1m/s of zero
-        bool descent_rate_low = fabsf(inertial_nav.get_velocity_z_up_cms()) < 100 * land_detector_scalar;
-
-            
-// ADDED BY FRANKY <
-        // if we have a healthy rangefinder only allow landing detection below 2 meters
- 		int32_t height=rangefinder_state.alt_cm_filt.get();
-        bool rangefinder_check = (!rangefinder_alt_ok() || height < LAND_RANGEFINDER_MIN_ALT_CM);
-
-		// Check the Motor throttle and add 5% as limit (for use with range finder only)	
-		float mot_throttle =  motors->get_throttle_out(); // in order to be able to add this value in the log for investigation purpose
-		bool land_mot_low = mot_throttle <  g.land_detector_mot_low; // mot_low will be used instead of  motor_at_lower_limit this value must be between motor_at_lower_limit and hoover
-
-		// Check if the range finder distance is below GNDCLEAR and > 0 : this condition will allow Landed_Complete regardless the AccStationary 
-		int16_t gnd_clear = copter.rangefinder.ground_clearance_cm_orient(ROTATION_PITCH_270);  // in order to be able to add this value in the log for investigation purpose
-		bool height_gnd_clear = height < gnd_clear && height > 0; // checking if height above ground is lower than RNGFND1_GNDCLEAR param, only usefull with a RNGFND and LAND_RNGFND = 1
-			
-		bool test_mode = g.land_detector_rngfnd==1;	//checks if we are in mode Land_detector (using) RNGFND
-// ADDED BY FRANKY >
-
-
+        AC_LandDetector::Inputs in {};
+        in.motor_at_lower_limit = motor_at_lower_limit;
+        in.throttle_mix_at_min = throttle_mix_at_min;
+        in.scalar = land_detector_scalar;
+        in.accel_ef_filt_length = land_accel_ef_filter.get().length();
+        in.climb_rate_cms = inertial_nav.get_velocity_z_up_cms();
+        // height brought up to date with the inertial altitude, as the
+        // rangefinder only updates at 20Hz and lags behind. Otherwise the
+        // last filtered height, e.g. once the sensor is below its minimum range
+        in.rangefinder_alt_ok = get_rangefinder_height_interpolated_cm(in.rangefinder_alt_cm);
+        if (!in.rangefinder_alt_ok) {
+            in.rangefinder_alt_cm = rangefinder_state.alt_cm_filt.get();
+        }
+        in.throttle_out = motors->get_throttle_out();
+        in.gnd_clear_cm = copter.rangefinder.ground_clearance_cm_orient(ROTATION_PITCH_270);
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+        // without readings fall back to the ground clearance test
+        in.gnd_contact_valid = copter.rangefinder.ground_contact_valid_orient(ROTATION_PITCH_270);
+        in.gnd_contact = copter.rangefinder.ground_contact_confidence_orient(ROTATION_PITCH_270);
+#endif
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+        AC_GroundPlane::Estimate plane;
+        if (get_ground_plane(plane)) {
+            in.ground_plane_valid = true;
+            in.ground_plane_height_cm = plane.height_m * 100.0f;
+            in.ground_plane_roughness_cm = plane.roughness_m * 100.0f;
+        }
+#endif
 
         // if we have weight on wheels (WoW) or ambiguous unknown. never no WoW
 #if AP_LANDINGGEAR_ENABLED
-        const bool WoW_check = (landinggear.get_wow_state() == AP_LandingGear::LG_WOW || landinggear.get_wow_state() == AP_LandingGear::LG_WOW_UNKNOWN);
+        in.wow_check = (landinggear.get_wow_state() == AP_LandingGear::LG_WOW || landinggear.get_wow_state() == AP_LandingGear::LG_WOW_UNKNOWN);
 #else
-        const bool WoW_check = true;
+        in.wow_check = true;
 #endif
 
+        const AC_LandDetector::Params params {
+            use_rangefinder : g.land_detector_rngfnd == 1,
+            mot_low : g.land_detector_mot_low,
+            rangefinder_min_alt_cm : LAND_RANGEFINDER_MIN_ALT_CM,
+            accel_max : LAND_DETECTOR_ACCEL_MAX,
+            gnd_contact_min : LAND_DETECTOR_GND_CONTACT_MIN,
+            ground_plane_margin_cm : LAND_GROUND_PLANE_MARGIN_CM,
+            ground_plane_roughness_max_cm : LAND_GROUND_PLANE_ROUGHNESS_MAX_CM,
+            gnd_contact_trigger_sec : LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC,
+        };
+
+        land_trigger_sec = AC_LandDetector::trigger_sec(params, in, land_trigger_sec);
+
+        // count loops with the landed criteria met (reset on movement up or down) and check if we've triggered
+        uint32_t steps_used;
+        const uint32_t trigger_count = ceilf(land_trigger_sec*scheduler.get_loop_rate_hz());
+        if (land_detector.update(AC_LandDetector::criteria_met(params, in), 1, trigger_count, steps_used)) {
+            set_land_complete(true);
+        }
+    }
 
-// ADDED BY FRANKY >
+    set_land_complete_maybe(ap.land_complete || (land_detector.get_count() >= LAND_DETECTOR_MAYBE_TRIGGER_SEC*scheduler.get_loop_rate_hz()));
+}
 
-            
-        if ((motor_at_lower_limit && accel_stationary && descent_rate_low && throttle_mix_at_min && rangefinder_check && WoW_check)|| 	// that condition will get TRUE as initial (probably not with large prop's)
-			(test_mode && land_mot_low && descent_rate_low && throttle_mix_at_min && rangefinder_check && WoW_check && height_gnd_clear))	// g.land_detector_rngfnd==1 && AccStationary is not tested in RNGFND LAND MODE
-			 {
- // ADDED BY FRANKY <    
-                 
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+// add new downward rangefinder readings to the ground plane and refit it
+// called at MAIN_LOOP_RATE. The plane is only used near touchdown, so it is
+// fitted at most every GROUND_PLANE_FIT_INTERVAL_MS while armed and landing or descending
+void Copter::update_ground_plane()
+{
+    if (!motors->armed() || ap.land_complete) {
+        return;
+    }
+    if (!flightmode->is_landing() && !ap.land_complete_maybe &&
+        (inertial_nav.get_velocity_z_up_cms() > GROUND_PLANE_DESCENT_RATE_CMS)) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - ground_plane_fit_ms < GROUND_PLANE_FIT_INTERVAL_MS) {
+        return;
+    }
+    ground_plane_fit_ms = now_ms;
 
-            // landed criteria met - increment the counter and check if we've triggered
-            if( land_detector_count < land_trigger_sec*scheduler.get_loop_rate_hz()) {
-                land_detector_count++;
-            } else {
-                set_land_complete(true);
-            }
-        } else {
-            // we've sensed movement up or down so reset land_detector
-            land_detector_count = 0;
+    Vector3f vehicle_pos_ned_m;
+    if (!ahrs.get_relative_position_NED_origin(vehicle_pos_ned_m)) {
+        return;
+    }
+    const Matrix3f &body_to_ned = ahrs.get_rotation_body_to_ned();
+    // fit around the downward rangefinder's mount rather than the vehicle
+    // origin, so the plane height is comparable with its ground clearance
+    const Vector3f ref_pos_ned_m = vehicle_pos_ned_m + body_to_ned * rangefinder.get_pos_offset_orient(ROTATION_PITCH_270);
+
+    for (uint8_t i = 0; i < MIN(rangefinder.num_sensors(), RANGEFINDER_MAX_INSTANCES); i++) {
+        const AP_RangeFinder_Backend *backend = rangefinder.get_backend(i);
+        if ((backend == nullptr) || (backend->status() != RangeFinder::Status::Good) ||
+            (backend->last_reading_ms() == ground_plane_reading_ms[i])) {
+            continue;
         }
+        ground_plane_reading_ms[i] = backend->last_reading_ms();
+
+        // only use sensors pointing at the ground, e.g. downward or tilted forward
+        Vector3f dir_ned {1, 0, 0};
+        dir_ned.rotate(backend->orientation());
+        dir_ned = body_to_ned * dir_ned;
+        if (dir_ned.z < 0.5f) {
+            continue;
+        }
+        const Vector3f point_ned_m = vehicle_pos_ned_m + body_to_ned * backend->get_pos_offset() + dir_ned * backend->distance();
+        ground_plane.add_point(point_ned_m, ground_plane_reading_ms[i]);
     }
 
-    set_land_complete_maybe(ap.land_complete || (land_detector_count >= LAND_DETECTOR_MAYBE_TRIGGER_SEC*scheduler.get_loop_rate_hz()));
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // returns from a scanning lidar accumulated over its last few revolutions
+    Vector3f points[AC_GROUNDPLANE_MAX_POINTS];
+    const uint16_t num_points = g2.proximity.pointcloud.get_points(ref_pos_ned_m, GROUND_PLANE_PROXIMITY_RADIUS_M, points, ARRAY_SIZE(points));
+    ground_plane.update(ref_pos_ned_m, now_ms, points, num_points);
+#else
+    ground_plane.update(ref_pos_ned_m, now_ms);
+#endif
+}
+
+// get the most recent ground plane fit, returns false if there is no recent estimate
+bool Copter::get_ground_plane(AC_GroundPlane::Estimate &plane) const
+{
+    return ground_plane.get_estimate(plane, AP_HAL::millis());
 }
 
+// get the downward rangefinder's height above the ground plane in cm, returns false if there is no recent estimate
+bool Copter::get_ground_plane_height_cm(int32_t &height_cm) const
+{
+    AC_GroundPlane::Estimate plane;
+    if (!get_ground_plane(plane)) {
+        return false;
+    }
+    height_cm = plane.height_m * 100.0f;
+    return true;
+}
+#endif
+
 // set land_complete flag and disarm motors if disarm-on-land is configured
 void Copter::set_land_complete(bool b)
 {
@@ -164,7 +258,7 @@ void Copter::set_land_complete(bool b)
     if( ap.land_complete == b )
         return;
 
-    land_detector_count = 0;
+    land_detector.reset();
 
 #if HAL_LOGGING_ENABLED
     if(b){
@@ -637,8 +637,19 @@ void Mode::land_run_vertical_control(bool pause_descent)
     bool ignore_descent_limit = false;
     if (!pause_descent) {
 
+        // a plane fitted to the returns below the vehicle is steadier than a single
+        // beam when the ground is uneven or the airframe is rocking. It is only
+        // trusted when get_alt_above_ground_cm() would use the rangefinder
+        int32_t alt_above_ground_cm;
+#if LAND_GROUND_PLANE_ENABLED == ENABLED
+        if (!copter.rangefinder_alt_ok() || !copter.get_ground_plane_height_cm(alt_above_ground_cm))
+#endif
+        {
+            alt_above_ground_cm = get_alt_above_ground_cm();
+        }
+
         // do not ignore limits until we have slowed down for landing
-        ignore_descent_limit = (MAX(g2.land_alt_low,100) > get_alt_above_ground_cm()) || copter.ap.land_complete_maybe;
+        ignore_descent_limit = (MAX(g2.land_alt_low,100) > alt_above_ground_cm) || copter.ap.land_complete_maybe;
 
         float max_land_descent_velocity;
         if (g.land_speed_high > 0) {
@@ -651,7 +662,7 @@ void Mode::land_run_vertical_control(bool pause_descent)
         max_land_descent_velocity = MIN(max_land_descent_velocity, -abs(g.land_speed));
 
         // Compute a vertical velocity demand such that the vehicle approaches g2.land_alt_low. Without the below constraint, this would cause the vehicle to hover at g2.land_alt_low.
-        cmb_rate = sqrt_controller(MAX(g2.land_alt_low,100)-get_alt_above_ground_cm(), pos_control->get_pos_z_p().kP(), pos_control->get_max_accel_z_cmss(), G_Dt);
+        cmb_rate = sqrt_controller(MAX(g2.land_alt_low,100)-alt_above_ground_cm, pos_control->get_pos_z_p().kP(), pos_control->get_max_accel_z_cmss(), G_Dt);
 
         // Constrain the demanded vertical velocity so that it is between the configured maximum descent speed and the configured minimum descent speed.
         cmb_rate = constrain_float(cmb_rate, max_land_descent_velocity, -abs(g.land_speed));
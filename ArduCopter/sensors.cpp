@@ -1,5 +1,7 @@
 #include "Copter.h"
 
+#include <AP_RangeFinder/AP_RangeFinder_Backend.h>
+
 // return barometric altitude in centimeters
 void Copter::read_barometer(void)
 {
@@ -16,6 +18,11 @@ void Copter::init_rangefinder(void)
    rangefinder_state.alt_cm_filt.set_cutoff_frequency(g2.rangefinder_filt);
    rangefinder_state.enabled = rangefinder.has_orientation(ROTATION_PITCH_270);
 
+   // past inertial altitudes to compare downward readings with, see read_rangefinder()
+   if (rangefinder_state.enabled && !inertial_nav.init_alt_history()) {
+       gcs().send_text(MAV_SEVERITY_WARNING, "RangeFinder: no memory for altitude history");
+   }
+
    // upward facing range finder
    rangefinder_up_state.alt_cm_filt.set_cutoff_frequency(g2.rangefinder_filt);
    rangefinder_up_state.enabled = rangefinder.has_orientation(ROTATION_PITCH_90);
@@ -45,15 +52,35 @@ void Copter::read_rangefinder(void)
         RangeFinderState &rf_state = rngfnd[i].state;
         enum Rotation rf_orient = rngfnd[i].orientation;
 
-        // update health
-        rf_state.alt_healthy = ((rangefinder.status_orient(rf_orient) == RangeFinder::Status::Good) &&
-                                (rangefinder.range_valid_count_orient(rf_orient) >= RANGEFINDER_HEALTH_MAX));
+#if AP_RANGEFINDER_FUSION_ENABLED
+        const bool fusing = (g2.rangefinder_fusion == 1);
+#else
+        const bool fusing = false;
+#endif
+        uint32_t last_reading_ms = 0;
+        if (fusing) {
+#if AP_RANGEFINDER_FUSION_ENABLED
+            // combine every instance with this orientation
+            const bool fused_ok = rangefinder.fuse_orient(rf_orient, ahrs.get_rotation_body_to_ned(), rf_state.fused);
+            rf_state.alt_healthy = fused_ok && (rf_state.fused.range_valid_count >= RANGEFINDER_HEALTH_MAX);
+            rf_state.alt_cm = tilt_correction * rf_state.fused.distance_m * 100.0f;
+            last_reading_ms = rf_state.fused.last_reading_ms;
+#endif
+        } else {
+            // update health
+            rf_state.alt_healthy = ((rangefinder.status_orient(rf_orient) == RangeFinder::Status::Good) &&
+                                    (rangefinder.range_valid_count_orient(rf_orient) >= RANGEFINDER_HEALTH_MAX));
 
-        // tilt corrected but unfiltered, not glitch protected alt
-        rf_state.alt_cm = tilt_correction * rangefinder.distance_cm_orient(rf_orient);
+            // tilt corrected but unfiltered, not glitch protected alt
+            rf_state.alt_cm = tilt_correction * rangefinder.distance_cm_orient(rf_orient);
+            last_reading_ms = rangefinder.last_reading_ms(rf_orient);
+        }
 
-        // remember inertial alt to allow us to interpolate rangefinder
-        rf_state.inertial_alt_cm = inertial_nav.get_position_z_up_cm();
+        // remember inertial alt at the time the reading was measured to allow us to interpolate rangefinder
+        const uint32_t measured_us = (last_reading_ms - uint32_t(MAX(g2.rangefinder_delay_ms.get(), 0))) * 1000U;
+        if (!inertial_nav.get_position_z_up_cm_at(measured_us, rf_state.inertial_alt_cm)) {
+            rf_state.inertial_alt_cm = inertial_nav.get_position_z_up_cm();
+        }
 
         // glitch handling.  rangefinder readings more than RANGEFINDER_GLITCH_ALT_CM from the last good reading
         // are considered a glitch and glitch_count becomes non-zero
@@ -87,10 +114,25 @@ void Copter::read_rangefinder(void)
                 reset_terrain_offset = true;
 
             } else {
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+                // filter every reading since the last update at its own
+                // time step rather than only the latest (averaged) one.
+                // Samples are per instance so are not used when fusing
+                if (fusing || !filter_rangefinder_samples(rf_state, rf_orient, tilt_correction)) {
+                    rf_state.alt_cm_filt.apply(rf_state.alt_cm, 0.05f);
+                }
+#else
                 rf_state.alt_cm_filt.apply(rf_state.alt_cm, 0.05f);
+#endif
             }
             rf_state.last_healthy_ms = now;
         }
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+        if (!rf_state.alt_healthy || timed_out) {
+            // samples from before the reset must not be applied later
+            skip_rangefinder_samples(rf_state, rf_orient);
+        }
+#endif
 
         // handle reset of terrain offset
         if (reset_terrain_offset) {
@@ -126,6 +168,65 @@ void Copter::read_rangefinder(void)
 #endif
 }
 
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+// apply the readings received since the last call to the altitude
+// filter, each with the time step since the one before. Each reading is
+// moved by the inertial climb between when it was measured and when the
+// latest reading was, so the filter holds the altitude at the time of
+// rf_state.inertial_alt_cm. Readings which would count as a glitch
+// against the protected altitude are skipped. Returns false if none
+// were applied
+bool Copter::filter_rangefinder_samples(RangeFinderState &rf_state, enum Rotation orientation, float tilt_correction)
+{
+    const uint32_t delay_us = MAX(g2.rangefinder_delay_ms.get(), 0) * 1000U;
+    // readings are distances down to the ground or up to the ceiling
+    const float climb_sign = (orientation == ROTATION_PITCH_90) ? -1.0f : 1.0f;
+
+    const AP_RangeFinder_Backend *backend = rangefinder.find_instance(orientation);
+    if (backend == nullptr) {
+        return false;
+    }
+    if (backend != rf_state.sample_backend) {
+        rf_state.sample_backend = backend;
+        rf_state.sample_seq = backend->sample_seq();
+        return false;
+    }
+    RangeFinder::SampleSpan spans[2];
+    const uint8_t num_spans = backend->get_samples(rf_state.sample_seq, spans);
+    bool applied = false;
+    for (uint8_t s=0; s<num_spans; s++) {
+        for (uint16_t i=0; i<spans[s].count; i++) {
+            const RangeFinder::Sample &sample = spans[s].samples[i];
+            const float dt = constrain_float((sample.time_us - rf_state.last_sample_us) * 1.0e-6f, 0.001f, 0.1f);
+            float inertial_alt_cm;
+            if (!inertial_nav.get_position_z_up_cm_at(sample.time_us - delay_us, inertial_alt_cm)) {
+                inertial_alt_cm = rf_state.inertial_alt_cm;
+            }
+            const float climb_cm = rf_state.inertial_alt_cm - inertial_alt_cm;
+            const float alt_cm = tilt_correction * sample.distance_m * 100;
+            if (fabsf(alt_cm - rf_state.alt_cm_glitch_protected) >= RANGEFINDER_GLITCH_ALT_CM) {
+                // the same glitch rejection as the latest reading
+                continue;
+            }
+            rf_state.alt_cm_filt.apply(alt_cm + climb_sign * climb_cm, dt);
+            rf_state.last_sample_us = sample.time_us;
+            applied = true;
+        }
+    }
+    return applied;
+}
+
+// discard unread samples, e.g. when the altitude filter is reset
+void Copter::skip_rangefinder_samples(RangeFinderState &rf_state, enum Rotation orientation)
+{
+    rf_state.sample_backend = rangefinder.find_instance(orientation);
+    if (rf_state.sample_backend != nullptr) {
+        rf_state.sample_seq = rf_state.sample_backend->sample_seq();
+    }
+    rf_state.last_sample_us = AP_HAL::micros();
+}
+#endif
+
 // return true if rangefinder_alt can be used
 bool Copter::rangefinder_alt_ok() const
 {
@@ -158,7 +259,8 @@ void Copter::update_rangefinder_terrain_offset()
 
 /*
   get inertially interpolated rangefinder height. Inertial height is
-  recorded whenever we update the rangefinder height, then we use the
+  recorded whenever we update the rangefinder height, as it was when the
+  reading was measured (allowing for RNGFND_DELAY), then we use the
   difference between the inertial height at that time and the current
   inertial height to give us interpolation of height from rangefinder
  */
@@ -0,0 +1,259 @@
+#include "LD_Evaluator.h"
+
+#include <inttypes.h>
+
+LD_Evaluator::LD_Evaluator(const LD_UserParam *_overrides) :
+    overrides(_overrides)
+{
+    rotation.identity();
+    handle_params(LD_LogParams{}, 0);
+}
+
+void LD_Evaluator::handle_params(const LD_LogParams &log_params, uint8_t rangefinder_instance)
+{
+    LD_LogParams params = log_params;
+    for (const LD_UserParam *u=overrides; u; u=u->next) {
+        params.set(u->name, u->value);
+    }
+
+    ld_params.use_rangefinder = is_equal(params.land_det_rngfnd, 1.0f);
+    ld_params.mot_low = params.land_det_mot_low;
+    ld_params.rangefinder_min_alt_cm = params.rangefinder_min_alt_cm;
+    ld_params.accel_max = LD_ACCEL_MAX_DEFAULT;
+    ld_params.gnd_contact_min = params.gnd_contact_min;
+    ld_params.ground_plane_margin_cm = params.ground_plane_margin_cm;
+    ld_params.ground_plane_roughness_max_cm = params.ground_plane_roughness_max_cm;
+    ld_params.gnd_contact_trigger_sec = params.gnd_contact_trigger_sec;
+    loop_rate_hz = MAX(params.loop_rate_hz, 1);
+    trigger_sec = params.trigger_sec;
+    gnd_clear_cm = params.gnd_clear_cm[MIN(rangefinder_instance, LD_MAX_RANGEFINDERS-1)];
+    rangefinder.alt_cm_filt.set_cutoff_frequency(params.rangefinder_filt_hz);
+
+    // keep the loop index continuous across a loop rate change
+    last_loop = last_us * loop_rate_hz / 1000000ULL;
+}
+
+/*
+  run the detector for every main loop between the last message and
+  time_us.  All inputs are constant over that interval, so the
+  criteria are evaluated once and the counter advanced in one step
+ */
+void LD_Evaluator::advance(uint64_t time_us)
+{
+    const uint64_t loop = time_us * loop_rate_hz / 1000000ULL;
+    if (!started) {
+        started = true;
+        last_loop = loop;
+    }
+    last_us = MAX(last_us, time_us);
+    if (loop <= last_loop) {
+        return;
+    }
+    const uint32_t steps = MIN(loop - last_loop, UINT32_MAX);
+
+    if (armed && !land_complete) {
+        AC_LandDetector::Inputs in {};
+        in.motor_at_lower_limit = thr_out < 0.125f * thr_hover;
+        in.throttle_mix_at_min = target_climb_cms < 0 || thr_in <= 0;
+        in.rangefinder_alt_ok = rangefinder.healthy;
+        in.wow_check = true;
+        in.scalar = 1;
+        in.accel_ef_filt_length = accel_ef_filter.get().length();
+        in.climb_rate_cms = climb_cms;
+        in.throttle_out = thr_out;
+        in.rangefinder_alt_cm = rangefinder.alt_cm_filt.get();
+        in.gnd_clear_cm = gnd_clear_cm;
+        if (time_us - ldet.time_us < LD_LDET_TIMEOUT_US) {
+            in.gnd_contact_valid = !isnan(ldet.gnd_contact);
+            in.gnd_contact = in.gnd_contact_valid ? ldet.gnd_contact : 0;
+            in.ground_plane_valid = !isnan(ldet.plane_height_m);
+            if (in.ground_plane_valid) {
+                in.ground_plane_height_cm = ldet.plane_height_m * 100;
+                in.ground_plane_roughness_cm = ldet.plane_roughness_m * 100;
+            }
+        }
+
+        const bool criteria = AC_LandDetector::criteria_met(ld_params, in);
+        const uint32_t trigger_count = ceilf(AC_LandDetector::trigger_sec(ld_params, in, trigger_sec) * loop_rate_hz);
+        uint32_t steps_used;
+        const bool landed = detector.update(criteria, steps, trigger_count, steps_used);
+        if (trace != nullptr) {
+            ::fprintf(trace, "%" PRIu64 ",%u,%u\n", time_us, unsigned(detector.get_count()), unsigned(criteria));
+        }
+        if (landed) {
+            set_land_complete((last_loop + steps_used) * 1000000ULL / loop_rate_hz);
+        }
+    }
+
+    last_loop = loop;
+}
+
+void LD_Evaluator::set_land_complete(uint64_t time_us)
+{
+    land_complete = true;
+    detector.reset();
+    if (!in_flight || detect_us != 0) {
+        return;
+    }
+    result.landings++;
+    detect_us = time_us;
+    detect_alt_m = alt_m;
+    const float ttl_s = (time_us - MIN(last_moving_us, time_us)) * 1.0e-6f;
+    result.ttl_sum_s += ttl_s;
+    result.ttl_max_s = MAX(result.ttl_max_s, ttl_s);
+}
+
+void LD_Evaluator::end_flight()
+{
+    if (!in_flight) {
+        return;
+    }
+    in_flight = false;
+    if (detect_us == 0) {
+        result.missed++;
+    } else if (logged_land_us != 0) {
+        result.logged_delta_sum_s += (int64_t(detect_us) - int64_t(logged_land_us)) * 1.0e-6f;
+        result.logged_delta_count++;
+    }
+}
+
+void LD_Evaluator::handle_ctun(uint64_t time_us, float _thr_in, float _thr_out, float _thr_hover, float _alt_m, int16_t _target_climb_cms, int16_t _climb_cms)
+{
+    advance(time_us);
+    thr_in = _thr_in;
+    thr_out = _thr_out;
+    thr_hover = _thr_hover;
+    alt_m = _alt_m;
+    target_climb_cms = _target_climb_cms;
+    climb_cms = _climb_cms;
+
+    if (fabsf(climb_cms) > touchdown_climb_cms) {
+        last_moving_us = time_us;
+    }
+    if (in_flight && detect_us != 0 && !false_positive_counted &&
+        alt_m > detect_alt_m + fp_alt_margin_m) {
+        // we declared a landing but the vehicle is still flying
+        result.false_positives++;
+        false_positive_counted = true;
+    }
+}
+
+void LD_Evaluator::handle_rfnd(uint64_t time_us, uint16_t dist_cm, bool status_good)
+{
+    advance(time_us);
+    if (status_good) {
+        rangefinder.valid_count = MIN(rangefinder.valid_count + 1, UINT8_MAX);
+    } else {
+        rangefinder.valid_count = 0;
+    }
+    rangefinder.healthy = status_good && rangefinder.valid_count >= LD_RANGEFINDER_HEALTH_MAX;
+    if (!rangefinder.healthy) {
+        return;
+    }
+    // tilt corrected as in Copter::read_rangefinder()
+    const float alt_cm = MAX(0.707f, rotation.c.z) * dist_cm;
+    if (time_us - rangefinder.last_healthy_us > LD_RANGEFINDER_TIMEOUT_US) {
+        rangefinder.alt_cm_filt.reset(alt_cm);
+    } else {
+        rangefinder.alt_cm_filt.apply(alt_cm, 0.05f);
+    }
+    rangefinder.last_healthy_us = time_us;
+}
+
+void LD_Evaluator::handle_ldet(uint64_t time_us, float gnd_contact, float plane_height_m, float plane_roughness_m)
+{
+    advance(time_us);
+    ldet.gnd_contact = gnd_contact;
+    ldet.plane_height_m = plane_height_m;
+    ldet.plane_roughness_m = plane_roughness_m;
+    ldet.time_us = time_us;
+}
+
+void LD_Evaluator::handle_att(uint64_t time_us, float roll_deg, float pitch_deg)
+{
+    advance(time_us);
+    rotation.from_euler(radians(roll_deg), radians(pitch_deg), 0);
+}
+
+void LD_Evaluator::apply_accel(uint64_t time_us, const Vector3f &accel_ef)
+{
+    if (last_accel_us != 0 && time_us > last_accel_us) {
+        accel_ef_filter.apply(accel_ef, (time_us - last_accel_us) * 1.0e-6f);
+    }
+    last_accel_us = time_us;
+}
+
+void LD_Evaluator::handle_imu(uint64_t time_us, const Vector3f &accel)
+{
+    advance(time_us);
+    have_imu = true;
+    // yaw does not change the length of the gravity compensated vector
+    Vector3f accel_ef = rotation * accel;
+    accel_ef.z += GRAVITY_MSS;
+    apply_accel(time_us, accel_ef);
+}
+
+void LD_Evaluator::handle_rate(uint64_t time_us, float accel_up_cmss)
+{
+    advance(time_us);
+    if (have_imu) {
+        return;
+    }
+    // RATE.A is -(accel_ef.z + GRAVITY_MSS) in cm/s/s
+    apply_accel(time_us, Vector3f(0, 0, -accel_up_cmss * 0.01f));
+}
+
+void LD_Evaluator::handle_armed(uint64_t time_us, bool _armed)
+{
+    advance(time_us);
+    if (armed == _armed) {
+        return;
+    }
+    armed = _armed;
+    if (!armed) {
+        // if disarmed, always landed
+        end_flight();
+        land_complete = true;
+        detector.reset();
+    }
+}
+
+void LD_Evaluator::handle_logged_land_complete(uint64_t time_us)
+{
+    advance(time_us);
+    result.logged_landings++;
+    if (in_flight && logged_land_us == 0) {
+        logged_land_us = time_us;
+    }
+}
+
+/*
+  take-off detection happens at the flight mode level which we can't
+  reconstruct, so follow the vehicle's own NOT_LANDED events
+ */
+void LD_Evaluator::handle_logged_not_landed(uint64_t time_us)
+{
+    advance(time_us);
+    if (!armed) {
+        return;
+    }
+    end_flight();
+    in_flight = true;
+    result.flights++;
+    land_complete = false;
+    detector.reset();
+    detect_us = 0;
+    logged_land_us = 0;
+    false_positive_counted = false;
+    last_moving_us = time_us;
+}
+
+void LD_Evaluator::finish()
+{
+    advance(last_us);
+    if (in_flight && detect_us == 0) {
+        // log ended in the air, that isn't a missed landing
+        in_flight = false;
+    }
+    end_flight();
+}
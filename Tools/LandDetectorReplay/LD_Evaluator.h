@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdio.h>
+#include <Filter/LowPassFilter.h>
+#include <AC_LandDetector/AC_LandDetector.h>
+
+#include "LD_Sink.h"
+
+/*
+  evaluate ArduCopter's landing detector against values decoded from
+  a log.  Inputs are held between messages and the detector is advanced
+  by the number of main loops between consecutive message timestamps,
+  so the cost is per message rather than per loop.
+
+  The ground contact confidence and ground plane come from LDET and are
+  passed through AC_LandDetector as on the vehicle, including the
+  shortened trigger time.  Logs from before LDET have neither.
+
+  Some inputs are not logged and are reconstructed:
+   - motor_at_lower_limit: CTUN.ThO below 12.5% of CTUN.ThH
+   - throttle_mix_at_min: descent demanded (CTUN.DCRt < 0) or zero pilot throttle
+   - filtered earth-frame accel: IMU[0] rotated by ATT, or RATE.A when IMU is not logged
+ */
+class LD_Evaluator : public LD_Sink
+{
+public:
+
+    struct Result {
+        uint32_t flights;               // logged takeoffs
+        uint32_t landings;              // land_complete from the evaluated detector
+        uint32_t false_positives;       // landings followed by a climb while still flying
+        uint32_t missed;                // disarms without an evaluated landing
+        uint32_t logged_landings;       // LAND_COMPLETE events in the log
+        float ttl_sum_s;                // sum of touchdown to land_complete times
+        float ttl_max_s;
+        float logged_delta_sum_s;       // sum of evaluated minus logged land_complete times
+        uint32_t logged_delta_count;
+    };
+
+    // overrides are applied on top of the parameters found in the log
+    LD_Evaluator(const LD_UserParam *_overrides);
+
+    // emit the land_detector_count trajectory as CSV
+    void set_trace(FILE *f) { trace = f; }
+
+    void handle_params(const LD_LogParams &params, uint8_t rangefinder_instance) override;
+    void handle_ctun(uint64_t time_us, float thr_in, float thr_out, float thr_hover, float alt_m, int16_t target_climb_cms, int16_t climb_cms) override;
+    void handle_rfnd(uint64_t time_us, uint16_t dist_cm, bool status_good) override;
+    void handle_ldet(uint64_t time_us, float gnd_contact, float plane_height_m, float plane_roughness_m) override;
+    void handle_att(uint64_t time_us, float roll_deg, float pitch_deg) override;
+    void handle_imu(uint64_t time_us, const Vector3f &accel) override;
+    void handle_rate(uint64_t time_us, float accel_up_cmss) override;
+    void handle_armed(uint64_t time_us, bool armed) override;
+    void handle_logged_land_complete(uint64_t time_us) override;
+    void handle_logged_not_landed(uint64_t time_us) override;
+
+    // close any flight still open at the end of the log
+    void finish();
+
+    const Result &get_result() const { return result; }
+
+private:
+    const LD_UserParam *overrides;
+    Result result {};
+    FILE *trace = nullptr;
+
+    // scoring thresholds
+    // a landing is false if the vehicle climbs by this much before disarm or takeoff
+    static constexpr float fp_alt_margin_m = 0.5f;
+    // climb rate below which the vehicle is considered to have touched down
+    static constexpr float touchdown_climb_cms = 20.0f;
+
+    // configuration derived from the log parameters and overrides
+    AC_LandDetector::Params ld_params;
+    float trigger_sec = 0;
+    uint16_t loop_rate_hz = 0;
+    int16_t gnd_clear_cm = 0;
+
+    AC_LandDetector detector;
+
+    // step the detector up to time_us using the inputs held so far
+    void advance(uint64_t time_us);
+    void set_land_complete(uint64_t time_us);
+    void end_flight();
+    void apply_accel(uint64_t time_us, const Vector3f &accel_ef);
+
+    uint64_t last_loop = 0;             // loop index reached by advance()
+    uint64_t last_us = 0;
+    bool started = false;
+
+    // vehicle state
+    bool armed = false;
+    bool land_complete = true;
+
+    // held inputs
+    float thr_in = 0;
+    float thr_out = 0;
+    float thr_hover = 0;
+    float alt_m = 0;
+    int16_t target_climb_cms = 0;
+    int16_t climb_cms = 0;
+    Matrix3f rotation;
+    bool have_imu = false;
+
+    // from LDET, NaN if not available
+    struct {
+        float gnd_contact = NAN;
+        float plane_height_m = NAN;
+        float plane_roughness_m = NAN;
+        uint64_t time_us = 0;
+    } ldet;
+
+    LowPassFilterVector3f accel_ef_filter{LD_ACCEL_LPF_CUTOFF};
+    uint64_t last_accel_us = 0;
+
+    struct {
+        bool healthy = false;
+        uint8_t valid_count = 0;
+        uint64_t last_healthy_us = 0;
+        LowPassFilterFloat alt_cm_filt;
+    } rangefinder;
+
+    // scoring
+    bool in_flight = false;             // between a logged takeoff and the next disarm or takeoff
+    uint64_t last_moving_us = 0;        // last time |climb rate| exceeded touchdown_climb_cms
+    uint64_t detect_us = 0;             // evaluated land_complete in this flight
+    float detect_alt_m = 0;
+    bool false_positive_counted = false;
+    uint64_t logged_land_us = 0;        // logged land_complete in this flight
+};
@@ -0,0 +1,189 @@
+#include "LD_LogData.h"
+#include "LD_LogReader.h"
+
+#include <string.h>
+
+LD_LogData::LD_LogData(const char *_filename) :
+    filename(strdup(_filename))
+{
+}
+
+LD_LogData::~LD_LogData()
+{
+    free(filename);
+}
+
+bool LD_LogData::load()
+{
+    {
+        LD_LogReader reader{*this};
+        if (!reader.open_log(filename)) {
+            return false;
+        }
+        while (reader.update()) {
+        }
+    }
+    shrink();
+    return ok;
+}
+
+void LD_LogData::shrink()
+{
+    order.shrink();
+    time_us.shrink();
+    ctun.thr_in.shrink();
+    ctun.thr_out.shrink();
+    ctun.thr_hover.shrink();
+    ctun.alt_m.shrink();
+    ctun.target_climb_cms.shrink();
+    ctun.climb_cms.shrink();
+    rfnd.dist_cm.shrink();
+    rfnd.status_good.shrink();
+    ldet.gnd_contact.shrink();
+    ldet.plane_height_m.shrink();
+    ldet.plane_roughness_m.shrink();
+    att.roll_deg.shrink();
+    att.pitch_deg.shrink();
+    imu.accel.shrink();
+    rate.accel_up_cmss.shrink();
+    params.shrink();
+}
+
+size_t LD_LogData::bytes() const
+{
+    return order.bytes() + time_us.bytes() +
+        ctun.thr_in.bytes() + ctun.thr_out.bytes() + ctun.thr_hover.bytes() +
+        ctun.alt_m.bytes() + ctun.target_climb_cms.bytes() + ctun.climb_cms.bytes() +
+        rfnd.dist_cm.bytes() + rfnd.status_good.bytes() +
+        ldet.gnd_contact.bytes() + ldet.plane_height_m.bytes() + ldet.plane_roughness_m.bytes() +
+        att.roll_deg.bytes() + att.pitch_deg.bytes() +
+        imu.accel.bytes() + rate.accel_up_cmss.bytes() + params.bytes();
+}
+
+void LD_LogData::add(Kind kind, uint64_t t)
+{
+    ok &= order.push(kind);
+    ok &= time_us.push(t);
+}
+
+void LD_LogData::handle_params(const LD_LogParams &p, uint8_t rangefinder_instance)
+{
+    add(Kind::PARAMS, time_us.size() ? time_us[time_us.size()-1] : 0);
+    ok &= params.push(Params{p, rangefinder_instance});
+}
+
+void LD_LogData::handle_ctun(uint64_t t, float thr_in, float thr_out, float thr_hover, float alt_m, int16_t target_climb_cms, int16_t climb_cms)
+{
+    add(Kind::CTUN, t);
+    ok &= ctun.thr_in.push(thr_in);
+    ok &= ctun.thr_out.push(thr_out);
+    ok &= ctun.thr_hover.push(thr_hover);
+    ok &= ctun.alt_m.push(alt_m);
+    ok &= ctun.target_climb_cms.push(target_climb_cms);
+    ok &= ctun.climb_cms.push(climb_cms);
+}
+
+void LD_LogData::handle_rfnd(uint64_t t, uint16_t dist_cm, bool status_good)
+{
+    add(Kind::RFND, t);
+    ok &= rfnd.dist_cm.push(dist_cm);
+    ok &= rfnd.status_good.push(status_good);
+}
+
+void LD_LogData::handle_ldet(uint64_t t, float gnd_contact, float plane_height_m, float plane_roughness_m)
+{
+    add(Kind::LDET, t);
+    ok &= ldet.gnd_contact.push(gnd_contact);
+    ok &= ldet.plane_height_m.push(plane_height_m);
+    ok &= ldet.plane_roughness_m.push(plane_roughness_m);
+}
+
+void LD_LogData::handle_att(uint64_t t, float roll_deg, float pitch_deg)
+{
+    add(Kind::ATT, t);
+    ok &= att.roll_deg.push(roll_deg);
+    ok &= att.pitch_deg.push(pitch_deg);
+}
+
+void LD_LogData::handle_imu(uint64_t t, const Vector3f &accel)
+{
+    add(Kind::IMU, t);
+    ok &= imu.accel.push(accel);
+}
+
+void LD_LogData::handle_rate(uint64_t t, float accel_up_cmss)
+{
+    add(Kind::RATE, t);
+    ok &= rate.accel_up_cmss.push(accel_up_cmss);
+}
+
+void LD_LogData::handle_armed(uint64_t t, bool armed)
+{
+    add(armed ? Kind::ARMED : Kind::DISARMED, t);
+}
+
+void LD_LogData::handle_logged_land_complete(uint64_t t)
+{
+    add(Kind::LAND_COMPLETE, t);
+}
+
+void LD_LogData::handle_logged_not_landed(uint64_t t)
+{
+    add(Kind::NOT_LANDED, t);
+}
+
+void LD_LogData::replay(LD_Sink &sink) const
+{
+    uint32_t i_params = 0, i_ctun = 0, i_rfnd = 0, i_ldet = 0, i_att = 0, i_imu = 0, i_rate = 0;
+
+    for (uint32_t i=0; i<order.size(); i++) {
+        const uint64_t t = time_us[i];
+        switch (order[i]) {
+        case Kind::PARAMS: {
+            const Params &p = params[i_params++];
+            sink.handle_params(p.params, p.rangefinder_instance);
+            break;
+        }
+        case Kind::CTUN:
+            sink.handle_ctun(t,
+                             ctun.thr_in[i_ctun],
+                             ctun.thr_out[i_ctun],
+                             ctun.thr_hover[i_ctun],
+                             ctun.alt_m[i_ctun],
+                             ctun.target_climb_cms[i_ctun],
+                             ctun.climb_cms[i_ctun]);
+            i_ctun++;
+            break;
+        case Kind::RFND:
+            sink.handle_rfnd(t, rfnd.dist_cm[i_rfnd], rfnd.status_good[i_rfnd]);
+            i_rfnd++;
+            break;
+        case Kind::LDET:
+            sink.handle_ldet(t, ldet.gnd_contact[i_ldet], ldet.plane_height_m[i_ldet], ldet.plane_roughness_m[i_ldet]);
+            i_ldet++;
+            break;
+        case Kind::ATT:
+            sink.handle_att(t, att.roll_deg[i_att], att.pitch_deg[i_att]);
+            i_att++;
+            break;
+        case Kind::IMU:
+            sink.handle_imu(t, imu.accel[i_imu++]);
+            break;
+        case Kind::RATE:
+            sink.handle_rate(t, rate.accel_up_cmss[i_rate++]);
+            break;
+        case Kind::ARMED:
+            sink.handle_armed(t, true);
+            break;
+        case Kind::DISARMED:
+            sink.handle_armed(t, false);
+            break;
+        case Kind::LAND_COMPLETE:
+            sink.handle_logged_land_complete(t);
+            break;
+        case Kind::NOT_LANDED:
+            sink.handle_logged_not_landed(t);
+            break;
+        }
+    }
+}
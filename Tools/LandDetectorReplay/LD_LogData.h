@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "LD_Sink.h"
+
+/*
+  growable array used for the columns of LD_LogData
+ */
+template <typename T>
+class LD_Column
+{
+public:
+    LD_Column() {}
+    ~LD_Column() { free(data); }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(LD_Column);
+
+    bool push(const T &v) {
+        if (count == allocated) {
+            const uint32_t new_allocated = MAX(allocated * 2, 256U);
+            T *new_data = (T *)realloc(data, new_allocated * sizeof(T));
+            if (new_data == nullptr) {
+                return false;
+            }
+            data = new_data;
+            allocated = new_allocated;
+        }
+        data[count++] = v;
+        return true;
+    }
+
+    // release unused space once decoding is finished
+    void shrink() {
+        if (count == 0 || count == allocated) {
+            return;
+        }
+        T *new_data = (T *)realloc(data, count * sizeof(T));
+        if (new_data != nullptr) {
+            data = new_data;
+            allocated = count;
+        }
+    }
+
+    const T &operator[](uint32_t i) const { return data[i]; }
+    uint32_t size() const { return count; }
+    size_t bytes() const { return allocated * sizeof(T); }
+
+private:
+    T *data = nullptr;
+    uint32_t count = 0;
+    uint32_t allocated = 0;
+};
+
+/*
+  the land detector inputs of one log decoded into compact columns.
+  A log is decoded once by LD_LogReader and can then be replayed into
+  any number of LD_Evaluators; replay() only reads the data so one
+  LD_LogData can be shared between threads
+ */
+class LD_LogData final : public LD_Sink
+{
+public:
+    LD_LogData(const char *_filename);
+    ~LD_LogData();
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(LD_LogData);
+
+    void handle_params(const LD_LogParams &params, uint8_t rangefinder_instance) override;
+    void handle_ctun(uint64_t time_us, float thr_in, float thr_out, float thr_hover, float alt_m, int16_t target_climb_cms, int16_t climb_cms) override;
+    void handle_rfnd(uint64_t time_us, uint16_t dist_cm, bool status_good) override;
+    void handle_ldet(uint64_t time_us, float gnd_contact, float plane_height_m, float plane_roughness_m) override;
+    void handle_att(uint64_t time_us, float roll_deg, float pitch_deg) override;
+    void handle_imu(uint64_t time_us, const Vector3f &accel) override;
+    void handle_rate(uint64_t time_us, float accel_up_cmss) override;
+    void handle_armed(uint64_t time_us, bool armed) override;
+    void handle_logged_land_complete(uint64_t time_us) override;
+    void handle_logged_not_landed(uint64_t time_us) override;
+
+    // decode filename, returns false if it could not be opened or memory ran out
+    bool load();
+
+    // feed the decoded messages to sink in log order
+    void replay(LD_Sink &sink) const;
+
+    const char *get_filename() const { return filename; }
+    size_t bytes() const;
+
+private:
+    char *filename;
+    bool ok = true;
+
+    enum class Kind : uint8_t {
+        PARAMS = 0,
+        CTUN,
+        RFND,
+        LDET,
+        ATT,
+        IMU,
+        RATE,
+        ARMED,
+        DISARMED,
+        LAND_COMPLETE,
+        NOT_LANDED,
+    };
+
+    // message order; each entry consumes the next row of its kind's columns
+    LD_Column<Kind> order;
+
+    // all timestamps, one per entry in order
+    LD_Column<uint64_t> time_us;
+
+    struct {
+        LD_Column<float> thr_in;
+        LD_Column<float> thr_out;
+        LD_Column<float> thr_hover;
+        LD_Column<float> alt_m;
+        LD_Column<int16_t> target_climb_cms;
+        LD_Column<int16_t> climb_cms;
+    } ctun;
+
+    struct {
+        LD_Column<uint16_t> dist_cm;
+        LD_Column<bool> status_good;
+    } rfnd;
+
+    struct {
+        LD_Column<float> gnd_contact;
+        LD_Column<float> plane_height_m;
+        LD_Column<float> plane_roughness_m;
+    } ldet;
+
+    struct {
+        LD_Column<float> roll_deg;
+        LD_Column<float> pitch_deg;
+    } att;
+
+    struct {
+        LD_Column<Vector3f> accel;
+    } imu;
+
+    struct {
+        LD_Column<float> accel_up_cmss;
+    } rate;
+
+    struct Params {
+        LD_LogParams params;
+        uint8_t rangefinder_instance;
+    };
+    LD_Column<Params> params;
+
+    void add(Kind kind, uint64_t t);
+    void shrink();
+};
@@ -0,0 +1,169 @@
+#include "LD_LogReader.h"
+
+#include <AP_Logger/AP_Logger.h>
+
+// RFND.Stat for RangeFinder::Status::Good
+#define LD_RANGEFINDER_STATUS_GOOD 4
+
+LD_LogReader::LD_LogReader(LD_Sink &_sink) :
+    AP_LoggerFileReader(),
+    sink(_sink)
+{
+    set_quiet(true);
+}
+
+void LD_LogReader::send_params()
+{
+    sink.handle_params(params, MAX(rfnd_instance, 0));
+}
+
+bool LD_LogReader::handle_log_format_msg(const struct log_Format &f)
+{
+    static const struct {
+        const char *name;
+        MsgType msg_type;
+        const char *labels[7];
+    } msgs[] {
+        { "CTUN", MsgType::CTUN, { "ThI", "ThO", "ThH", "Alt", "DCRt", "CRt" } },
+        { "RFND", MsgType::RFND, { "Instance", "Dist", "Stat", "Orient" } },
+        { "LDET", MsgType::LDET, { "GCon", "GPH", "GPR" } },
+        { "ATT",  MsgType::ATT,  { "Roll", "Pitch" } },
+        { "IMU",  MsgType::IMU,  { "I", "AccX", "AccY", "AccZ" } },
+        { "RATE", MsgType::RATE, { "A" } },
+        { "EV",   MsgType::EV,   { "Id" } },
+        { "ARM",  MsgType::ARM,  { "ArmState" } },
+        { "PARM", MsgType::PARM, { "Name", "Value" } },
+    };
+
+    char name[5] {};
+    memcpy(name, f.name, 4);
+
+    Decoder &d = decoders[f.type];
+    d.msg_type = MsgType::NONE;
+    for (const auto &m : msgs) {
+        if (!streq(name, m.name)) {
+            continue;
+        }
+        MsgHandler handler{formats[f.type]};
+        if (!handler.field_offset("TimeUS", d.time_us.type, d.time_us.offset)) {
+            return true;
+        }
+        for (uint8_t i=0; i<ARRAY_SIZE(m.labels) && m.labels[i] != nullptr; i++) {
+            if (!handler.field_offset(m.labels[i], d.f[i].type, d.f[i].offset)) {
+                // older log without a field we need; ignore the message
+                // (IMU instance may be absent in single-IMU logs)
+                if (m.msg_type != MsgType::IMU || i != 0) {
+                    return true;
+                }
+                d.f[i].offset = 0;
+            }
+        }
+        d.msg_type = m.msg_type;
+        break;
+    }
+    return true;
+}
+
+bool LD_LogReader::handle_msg(const struct log_Format &f, uint8_t *msg)
+{
+    const Decoder &d = decoders[f.type];
+    if (d.msg_type == MsgType::NONE) {
+        return true;
+    }
+    const uint64_t time_us = get<uint64_t>(msg, d.time_us);
+
+    switch (d.msg_type) {
+    case MsgType::NONE:
+        break;
+
+    case MsgType::CTUN:
+        sink.handle_ctun(time_us,
+                              get<float>(msg, d.f[0]),
+                              get<float>(msg, d.f[1]),
+                              get<float>(msg, d.f[2]),
+                              get<float>(msg, d.f[3]),
+                              get<int16_t>(msg, d.f[4]),
+                              get<int16_t>(msg, d.f[5]));
+        break;
+
+    case MsgType::RFND: {
+        const uint8_t instance = get<uint8_t>(msg, d.f[0]);
+        if (rfnd_instance == -1) {
+            if (get<uint8_t>(msg, d.f[3]) != ROTATION_PITCH_270) {
+                break;
+            }
+            // first instance with a downward orientation, as RangeFinder::find_instance()
+            rfnd_instance = instance;
+            send_params();
+        }
+        if (instance != rfnd_instance) {
+            break;
+        }
+        sink.handle_rfnd(time_us,
+                              get<uint16_t>(msg, d.f[1]),
+                              get<uint8_t>(msg, d.f[2]) == LD_RANGEFINDER_STATUS_GOOD);
+        break;
+    }
+
+    case MsgType::LDET:
+        sink.handle_ldet(time_us,
+                              get<float>(msg, d.f[0]),
+                              get<float>(msg, d.f[1]),
+                              get<float>(msg, d.f[2]));
+        break;
+
+    case MsgType::ATT:
+        sink.handle_att(time_us,
+                             get<int16_t>(msg, d.f[0]) * 0.01f,
+                             get<int16_t>(msg, d.f[1]) * 0.01f);
+        break;
+
+    case MsgType::IMU:
+        if (d.f[0].offset != 0 && get<uint8_t>(msg, d.f[0]) != 0) {
+            // primary IMU only
+            break;
+        }
+        sink.handle_imu(time_us, Vector3f(get<float>(msg, d.f[1]),
+                                               get<float>(msg, d.f[2]),
+                                               get<float>(msg, d.f[3])));
+        break;
+
+    case MsgType::RATE:
+        sink.handle_rate(time_us, get<float>(msg, d.f[0]));
+        break;
+
+    case MsgType::EV:
+        switch (LogEvent(get<uint8_t>(msg, d.f[0]))) {
+        case LogEvent::ARMED:
+            sink.handle_armed(time_us, true);
+            break;
+        case LogEvent::DISARMED:
+            sink.handle_armed(time_us, false);
+            break;
+        case LogEvent::LAND_COMPLETE:
+            sink.handle_logged_land_complete(time_us);
+            break;
+        case LogEvent::NOT_LANDED:
+            sink.handle_logged_not_landed(time_us);
+            break;
+        default:
+            break;
+        }
+        break;
+
+    case MsgType::ARM:
+        sink.handle_armed(time_us, get<uint8_t>(msg, d.f[0]) != 0);
+        break;
+
+    case MsgType::PARM: {
+        char name[17] {};
+        memcpy(name, &msg[d.f[0].offset], 16);
+        if (params.set(name, get<float>(msg, d.f[1]))) {
+            send_params();
+        }
+        break;
+    }
+    }
+
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../Replay/DataFlashFileReader.h"
+#include "../Replay/MsgHandler.h"
+#include "LD_Sink.h"
+
+/*
+  decode the messages used by the land detector from a log and feed
+  them to an LD_Sink.  Field offsets are resolved once per format
+  so the per-message cost is a handful of loads
+ */
+class LD_LogReader : public AP_LoggerFileReader
+{
+public:
+    LD_LogReader(LD_Sink &_sink);
+
+    bool handle_log_format_msg(const struct log_Format &f) override;
+    bool handle_msg(const struct log_Format &f, uint8_t *msg) override;
+
+private:
+    LD_Sink &sink;
+    LD_LogParams params;
+
+    enum class MsgType : uint8_t {
+        NONE = 0,
+        CTUN,
+        RFND,
+        LDET,
+        ATT,
+        IMU,
+        RATE,
+        EV,
+        ARM,
+        PARM,
+    };
+
+    struct Field {
+        uint8_t type;
+        uint8_t offset;
+    };
+
+    // fields of interest; the meaning of each slot depends on the message type
+    struct Decoder {
+        MsgType msg_type;
+        Field time_us;
+        Field f[7];
+    } decoders[LOGREADER_MAX_FORMATS] {};
+
+    // instance number of the first downward facing rangefinder
+    int16_t rfnd_instance = -1;
+
+    void send_params();
+
+    template<typename R>
+    R get(uint8_t *msg, const Field &field) {
+        R ret;
+        MsgHandler::field_value_at(msg, field.type, field.offset, ret);
+        return ret;
+    }
+};
@@ -0,0 +1,41 @@
+#include "LD_Sink.h"
+
+#include <string.h>
+
+#define streq(x, y) (!strcmp(x, y))
+
+bool LD_LogParams::set(const char *name, float value)
+{
+    if (streq(name, "LAND_DET_RNGFND")) {
+        land_det_rngfnd = value;
+    } else if (streq(name, "LAND_DET_MOT_LOW")) {
+        land_det_mot_low = value;
+    } else if (streq(name, "SCHED_LOOP_RATE")) {
+        loop_rate_hz = value;
+    } else if (streq(name, "RNGFND_FILT")) {
+        rangefinder_filt_hz = value;
+    } else if (streq(name, "LAND_DETECTOR_TRIGGER_SEC")) {
+        trigger_sec = value;
+    } else if (streq(name, "LAND_RANGEFINDER_MIN_ALT_CM")) {
+        rangefinder_min_alt_cm = value;
+    } else if (streq(name, "LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC")) {
+        gnd_contact_trigger_sec = value;
+    } else if (streq(name, "LAND_DETECTOR_GND_CONTACT_MIN")) {
+        gnd_contact_min = value;
+    } else if (streq(name, "LAND_GROUND_PLANE_MARGIN_CM")) {
+        ground_plane_margin_cm = value;
+    } else if (streq(name, "LAND_GROUND_PLANE_ROUGHNESS_MAX_CM")) {
+        ground_plane_roughness_max_cm = value;
+    } else if (strncmp(name, "RNGFND", 6) == 0 && name[6] != 0 && streq(&name[7], "_GNDCLEAR")) {
+        // RNGFND1_GNDCLEAR .. RNGFND9_GNDCLEAR and RNGFNDA_GNDCLEAR
+        const char c = name[6];
+        const uint8_t instance = (c == 'A') ? 9 : c - '1';
+        if (instance >= LD_MAX_RANGEFINDERS) {
+            return false;
+        }
+        gnd_clear_cm[instance] = value;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+// defaults matching ArduCopter/config.h and Parameters.cpp
+#define LD_LOOP_RATE_DEFAULT            400
+#define LD_TRIGGER_SEC_DEFAULT          1.0f    // LAND_DETECTOR_TRIGGER_SEC
+#define LD_ACCEL_LPF_CUTOFF             1.0f    // LAND_DETECTOR_ACCEL_LPF_CUTOFF
+#define LD_ACCEL_MAX_DEFAULT            1.0f    // LAND_DETECTOR_ACCEL_MAX
+#define LD_RANGEFINDER_MIN_ALT_CM       200     // LAND_RANGEFINDER_MIN_ALT_CM
+#define LD_RANGEFINDER_FILT_DEFAULT     0.5f    // RANGEFINDER_FILT_DEFAULT
+#define LD_RANGEFINDER_HEALTH_MAX       3       // RANGEFINDER_HEALTH_MAX
+#define LD_RANGEFINDER_TIMEOUT_US       1000000 // RANGEFINDER_TIMEOUT_MS
+#define LD_GND_CLEAR_DEFAULT_CM         10      // RNGFNDx_GNDCLEAR default
+#define LD_MOT_LOW_DEFAULT              0.1f    // LAND_DETECTOR_MOT_LOW_DEFAULT
+#define LD_GND_CONTACT_TRIGGER_SEC      0.5f    // LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC
+#define LD_GND_CONTACT_MIN              0.5f    // LAND_DETECTOR_GND_CONTACT_MIN
+#define LD_GROUND_PLANE_MARGIN_CM       10.0f   // LAND_GROUND_PLANE_MARGIN_CM
+#define LD_GROUND_PLANE_ROUGHNESS_MAX_CM 10.0f  // LAND_GROUND_PLANE_ROUGHNESS_MAX_CM
+#define LD_LDET_TIMEOUT_US              1000000 // LDET values older than this are not used
+
+#define LD_MAX_RANGEFINDERS 10
+
+// parameter given on the command line or by a sweep, overriding the value in the log
+struct LD_UserParam {
+    LD_UserParam *next;
+    char name[17];
+    float value;
+};
+
+/*
+  parameters the evaluator needs, taken from PARM messages.  The
+  compile-time constants LAND_DETECTOR_TRIGGER_SEC,
+  LAND_RANGEFINDER_MIN_ALT_CM, LAND_DETECTOR_GND_CONTACT_TRIGGER_SEC,
+  LAND_DETECTOR_GND_CONTACT_MIN, LAND_GROUND_PLANE_MARGIN_CM and
+  LAND_GROUND_PLANE_ROUGHNESS_MAX_CM can be set by name as if they were
+  parameters so they can be overridden
+ */
+struct LD_LogParams {
+    float land_det_rngfnd = 0;
+    float land_det_mot_low = LD_MOT_LOW_DEFAULT;
+    float loop_rate_hz = LD_LOOP_RATE_DEFAULT;
+    float rangefinder_filt_hz = LD_RANGEFINDER_FILT_DEFAULT;
+    float trigger_sec = LD_TRIGGER_SEC_DEFAULT;
+    float rangefinder_min_alt_cm = LD_RANGEFINDER_MIN_ALT_CM;
+    float gnd_contact_trigger_sec = LD_GND_CONTACT_TRIGGER_SEC;
+    float gnd_contact_min = LD_GND_CONTACT_MIN;
+    float ground_plane_margin_cm = LD_GROUND_PLANE_MARGIN_CM;
+    float ground_plane_roughness_max_cm = LD_GROUND_PLANE_ROUGHNESS_MAX_CM;
+    float gnd_clear_cm[LD_MAX_RANGEFINDERS] = {
+        LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM,
+        LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM,
+        LD_GND_CLEAR_DEFAULT_CM, LD_GND_CLEAR_DEFAULT_CM,
+    };
+
+    // set a parameter by name, returns false if it isn't one we use
+    bool set(const char *name, float value);
+};
+
+/*
+  consumer of the log values used by the land detector
+ */
+class LD_Sink
+{
+public:
+    // rangefinder_instance is the first downward facing rangefinder
+    virtual void handle_params(const LD_LogParams &params, uint8_t rangefinder_instance) = 0;
+    virtual void handle_ctun(uint64_t time_us, float thr_in, float thr_out, float thr_hover, float alt_m, int16_t target_climb_cms, int16_t climb_cms) = 0;
+    virtual void handle_rfnd(uint64_t time_us, uint16_t dist_cm, bool status_good) = 0;
+    // ground contact confidence and ground plane from LDET, NaN if not available
+    virtual void handle_ldet(uint64_t time_us, float gnd_contact, float plane_height_m, float plane_roughness_m) = 0;
+    virtual void handle_att(uint64_t time_us, float roll_deg, float pitch_deg) = 0;
+    virtual void handle_imu(uint64_t time_us, const Vector3f &accel) = 0;
+    virtual void handle_rate(uint64_t time_us, float accel_up_cmss) = 0;
+    virtual void handle_armed(uint64_t time_us, bool armed) = 0;
+    virtual void handle_logged_land_complete(uint64_t time_us) = 0;
+    virtual void handle_logged_not_landed(uint64_t time_us) = 0;
+};
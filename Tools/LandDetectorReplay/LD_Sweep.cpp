@@ -0,0 +1,195 @@
+#include "LD_Sweep.h"
+
+#include <stdio.h>
+#include <string.h>
+
+LD_Sweep::~LD_Sweep()
+{
+    for (uint32_t i=0; i<num_logs; i++) {
+        delete logs[i];
+    }
+    free(logs);
+    free(results);
+}
+
+bool LD_Sweep::add_axis(const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    if (num_axes >= LD_SWEEP_MAX_AXES || eq == nullptr || size_t(eq - spec) >= sizeof(axes[0].name)) {
+        return false;
+    }
+    Axis &a = axes[num_axes];
+    memset(a.name, 0, sizeof(a.name));
+    strncpy(a.name, spec, eq - spec);
+    a.count = 0;
+
+    float start, stop, step;
+    if (sscanf(eq+1, "%f:%f:%f", &start, &stop, &step) == 3) {
+        if (step <= 0 || stop < start) {
+            return false;
+        }
+        // include stop, allowing for rounding in the step
+        for (float v=start; v <= stop + step*0.001f && a.count < LD_SWEEP_MAX_VALUES; v += step) {
+            a.values[a.count++] = v;
+        }
+    } else {
+        const char *p = eq+1;
+        while (*p && a.count < LD_SWEEP_MAX_VALUES) {
+            char *end;
+            a.values[a.count++] = strtof(p, &end);
+            if (end == p) {
+                return false;
+            }
+            p = (*end == ',') ? end+1 : end;
+        }
+    }
+    if (a.count == 0) {
+        return false;
+    }
+    num_axes++;
+    return true;
+}
+
+void LD_Sweep::add_log(const char *filename)
+{
+    LD_LogData **new_logs = (LD_LogData **)realloc(logs, (num_logs+1) * sizeof(LD_LogData *));
+    if (new_logs == nullptr) {
+        ::printf("out of memory\n");
+        exit(1);
+    }
+    logs = new_logs;
+    logs[num_logs++] = new LD_LogData(filename);
+}
+
+uint32_t LD_Sweep::grid_size() const
+{
+    uint32_t n = 1;
+    for (uint8_t i=0; i<num_axes; i++) {
+        n *= axes[i].count;
+    }
+    return n;
+}
+
+void LD_Sweep::grid_point(uint32_t idx, LD_UserParam params[], const LD_UserParam *fixed) const
+{
+    const LD_UserParam *next = fixed;
+    for (uint8_t i=0; i<num_axes; i++) {
+        const Axis &a = axes[i];
+        LD_UserParam &p = params[i];
+        memcpy(p.name, a.name, sizeof(p.name));
+        p.value = a.values[idx % a.count];
+        p.next = (LD_UserParam *)next;
+        next = &p;
+        idx /= a.count;
+    }
+}
+
+void LD_Sweep::accumulate(LD_Evaluator::Result &total, const LD_Evaluator::Result &r)
+{
+    total.flights += r.flights;
+    total.landings += r.landings;
+    total.false_positives += r.false_positives;
+    total.missed += r.missed;
+    total.logged_landings += r.logged_landings;
+    total.ttl_sum_s += r.ttl_sum_s;
+    total.ttl_max_s = MAX(total.ttl_max_s, r.ttl_max_s);
+    total.logged_delta_sum_s += r.logged_delta_sum_s;
+    total.logged_delta_count += r.logged_delta_count;
+}
+
+void LD_Sweep::load_task(uint32_t t, uint8_t worker)
+{
+    LD_LogData *log = logs[t];
+    if (!log->load()) {
+        ::fprintf(stderr, "%s: failed to load\n", log->get_filename());
+        delete log;
+        logs[t] = nullptr;
+    }
+}
+
+void LD_Sweep::eval_task(uint32_t t, uint8_t worker)
+{
+    const LD_LogData *log = logs[t / num_grid];
+    if (log == nullptr) {
+        return;
+    }
+    const uint32_t g = t % num_grid;
+
+    LD_UserParam params[LD_SWEEP_MAX_AXES];
+    grid_point(g, params, fixed_params);
+
+    LD_Evaluator evaluator{num_axes > 0 ? &params[num_axes-1] : fixed_params};
+    log->replay(evaluator);
+    evaluator.finish();
+
+    accumulate(results[worker * num_grid + g], evaluator.get_result());
+}
+
+void LD_Sweep::run(uint8_t num_threads, const LD_UserParam *fixed)
+{
+    // an axis must not also be a fixed override, as the order they
+    // are applied in would decide which wins
+    for (const LD_UserParam *u=fixed; u; u=u->next) {
+        for (uint8_t i=0; i<num_axes; i++) {
+            if (strcmp(u->name, axes[i].name) == 0) {
+                ::printf("%s is both a parameter and a sweep axis\n", u->name);
+                exit(1);
+            }
+        }
+    }
+
+    LD_WorkPool pool{num_threads};
+    fixed_params = fixed;
+    num_grid = grid_size();
+    if (uint64_t(num_logs) * num_grid > UINT32_MAX) {
+        ::printf("sweep too large: %u logs x %u grid points\n", unsigned(num_logs), unsigned(num_grid));
+        exit(1);
+    }
+
+    // decode every log once
+    pool.run(num_logs, FUNCTOR_BIND_MEMBER(&LD_Sweep::load_task, void, uint32_t, uint8_t));
+    size_t bytes = 0;
+    num_loaded = 0;
+    for (uint32_t i=0; i<num_logs; i++) {
+        if (logs[i] != nullptr) {
+            bytes += logs[i]->bytes();
+            num_loaded++;
+        }
+    }
+    ::fprintf(stderr, "Decoded %u logs into %.1f MB, evaluating %u grid points on %u threads\n",
+              unsigned(num_loaded), bytes / (1024.0 * 1024.0), unsigned(num_grid), unsigned(pool.get_num_workers()));
+
+    results = (LD_Evaluator::Result *)calloc(size_t(pool.get_num_workers()) * num_grid, sizeof(LD_Evaluator::Result));
+    if (results == nullptr) {
+        ::printf("out of memory\n");
+        exit(1);
+    }
+    pool.run(num_logs * num_grid, FUNCTOR_BIND_MEMBER(&LD_Sweep::eval_task, void, uint32_t, uint8_t));
+
+    // reduce the per-worker results and report
+    for (uint8_t i=0; i<num_axes; i++) {
+        ::printf("%s,", axes[i].name);
+    }
+    ::printf("Logs,Flights,Landings,FalsePositives,Missed,LoggedLandings,MeanTimeToLand,MaxTimeToLand,MeanDeltaToLogged\n");
+    for (uint32_t g=0; g<num_grid; g++) {
+        LD_Evaluator::Result r {};
+        for (uint8_t w=0; w<pool.get_num_workers(); w++) {
+            accumulate(r, results[w * num_grid + g]);
+        }
+        LD_UserParam params[LD_SWEEP_MAX_AXES];
+        grid_point(g, params, nullptr);
+        for (uint8_t i=0; i<num_axes; i++) {
+            ::printf("%g,", params[i].value);
+        }
+        ::printf("%u,%u,%u,%u,%u,%u,%.3f,%.3f,%.3f\n",
+                 unsigned(num_loaded),
+                 unsigned(r.flights),
+                 unsigned(r.landings),
+                 unsigned(r.false_positives),
+                 unsigned(r.missed),
+                 unsigned(r.logged_landings),
+                 r.landings ? r.ttl_sum_s / r.landings : 0.0f,
+                 r.ttl_max_s,
+                 r.logged_delta_count ? r.logged_delta_sum_s / r.logged_delta_count : 0.0f);
+    }
+}
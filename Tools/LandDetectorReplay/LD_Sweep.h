@@ -0,0 +1,57 @@
+#pragma once
+
+#include "LD_Evaluator.h"
+#include "LD_LogData.h"
+#include "LD_WorkPool.h"
+
+#define LD_SWEEP_MAX_AXES 8
+#define LD_SWEEP_MAX_VALUES 1000
+
+/*
+  evaluate every combination of a parameter grid over a set of logs.
+  Each log is decoded once into an LD_LogData shared read-only by all
+  workers; the (log, grid point) pairs are then spread over a
+  work-stealing pool.  Tasks are ordered log-major so a worker's slice
+  replays the same log columns for consecutive grid points
+ */
+class LD_Sweep
+{
+public:
+    ~LD_Sweep();
+
+    // add a grid axis from NAME=START:STOP:STEP or NAME=V1,V2,...
+    bool add_axis(const char *spec);
+
+    void add_log(const char *filename);
+
+    // decode the logs then evaluate the grid, printing one CSV line per grid point.
+    // fixed are parameter overrides applied to every grid point
+    void run(uint8_t num_threads, const LD_UserParam *fixed);
+
+private:
+    struct Axis {
+        char name[17];
+        float values[LD_SWEEP_MAX_VALUES];
+        uint16_t count;
+    } axes[LD_SWEEP_MAX_AXES];
+    uint8_t num_axes;
+
+    LD_LogData **logs;
+    uint32_t num_logs;
+    uint32_t num_loaded;
+
+    uint32_t grid_size() const;
+
+    // fill one override per axis for grid point idx, chained onto fixed
+    void grid_point(uint32_t idx, LD_UserParam params[], const LD_UserParam *fixed) const;
+
+    // per-worker, per-grid-point accumulated results
+    LD_Evaluator::Result *results;
+    uint32_t num_grid;
+    const LD_UserParam *fixed_params;
+
+    void load_task(uint32_t t, uint8_t worker);
+    void eval_task(uint32_t t, uint8_t worker);
+
+    static void accumulate(LD_Evaluator::Result &total, const LD_Evaluator::Result &r);
+};
@@ -0,0 +1,92 @@
+#include "LD_WorkPool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+LD_WorkPool::LD_WorkPool(uint8_t _num_workers) :
+    num_workers(constrain_int16(_num_workers, 1, LD_WORKPOOL_MAX_WORKERS))
+{
+}
+
+uint8_t LD_WorkPool::num_cpus()
+{
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return constrain_int32(n, 1, LD_WORKPOOL_MAX_WORKERS);
+}
+
+// take the next task from the front of our own slice
+bool LD_WorkPool::pop(uint8_t worker, uint32_t &t)
+{
+    std::atomic<uint64_t> &range = slices[worker].range;
+    uint64_t r = range.load();
+    while (begin_of(r) < end_of(r)) {
+        if (range.compare_exchange_weak(r, pack(begin_of(r)+1, end_of(r)))) {
+            t = begin_of(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+// move the back half of another worker's slice into our own
+bool LD_WorkPool::steal(uint8_t worker)
+{
+    for (uint8_t i=1; i<num_workers; i++) {
+        std::atomic<uint64_t> &victim = slices[(worker + i) % num_workers].range;
+        uint64_t r = victim.load();
+        while (begin_of(r) < end_of(r)) {
+            const uint32_t mid = begin_of(r) + (end_of(r) - begin_of(r)) / 2;
+            if (victim.compare_exchange_weak(r, pack(begin_of(r), mid))) {
+                slices[worker].range.store(pack(mid, end_of(r)));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LD_WorkPool::worker_main(uint8_t worker)
+{
+    uint32_t t;
+    do {
+        while (pop(worker, t)) {
+            task(t, worker);
+        }
+    } while (steal(worker));
+}
+
+void *LD_WorkPool::thread_main(void *arg)
+{
+    const WorkerArg *w = (const WorkerArg *)arg;
+    w->pool->worker_main(w->worker);
+    return nullptr;
+}
+
+void LD_WorkPool::run(uint32_t num_tasks, task_fn fn)
+{
+    task = fn;
+
+    // initial even split
+    for (uint8_t i=0; i<num_workers; i++) {
+        const uint32_t begin = uint64_t(num_tasks) * i / num_workers;
+        const uint32_t end = uint64_t(num_tasks) * (i+1) / num_workers;
+        slices[i].range.store(pack(begin, end));
+    }
+
+    // the calling thread is worker 0
+    pthread_t threads[LD_WORKPOOL_MAX_WORKERS];
+    WorkerArg args[LD_WORKPOOL_MAX_WORKERS];
+    uint8_t started = 1;
+    for (uint8_t i=1; i<num_workers; i++) {
+        args[i] = WorkerArg{this, i};
+        if (pthread_create(&threads[i], nullptr, thread_main, &args[i]) != 0) {
+            // remaining slices get stolen by the workers we have
+            break;
+        }
+        started++;
+    }
+    worker_main(0);
+    for (uint8_t i=1; i<started; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <atomic>
+
+#define LD_WORKPOOL_MAX_WORKERS 128
+
+/*
+  run a fixed set of independent tasks on a pool of threads.  Each
+  worker starts with a contiguous slice of the task indexes and takes
+  tasks from the front of it; a worker which runs dry steals the back
+  half of another worker's remaining slice, so uneven task costs (logs
+  of very different lengths) still keep every core busy
+ */
+class LD_WorkPool
+{
+public:
+    // task callback; worker is in [0, num_workers)
+    FUNCTOR_TYPEDEF(task_fn, void, uint32_t, uint8_t);
+
+    LD_WorkPool(uint8_t _num_workers);
+
+    // run fn for every task in [0, num_tasks) and wait for completion
+    void run(uint32_t num_tasks, task_fn fn);
+
+    uint8_t get_num_workers() const { return num_workers; }
+
+    // number of online CPUs
+    static uint8_t num_cpus();
+
+private:
+    const uint8_t num_workers;
+    task_fn task;
+
+    // per-worker remaining slice, packed as (begin << 32 | end)
+    struct alignas(64) Slice {
+        std::atomic<uint64_t> range;
+    } slices[LD_WORKPOOL_MAX_WORKERS];
+
+    static uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t(begin) << 32) | end; }
+    static uint32_t begin_of(uint64_t r) { return r >> 32; }
+    static uint32_t end_of(uint64_t r) { return r & 0xFFFFFFFFU; }
+
+    bool pop(uint8_t worker, uint32_t &t);
+    bool steal(uint8_t worker);
+    void worker_main(uint8_t worker);
+
+    struct WorkerArg {
+        LD_WorkPool *pool;
+        uint8_t worker;
+    };
+    static void *thread_main(void *arg);
+};
@@ -0,0 +1,237 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  offline evaluation of the ArduCopter landing detector
+
+  Streams CTUN, RFND, ATT, IMU, RATE, EV and ARM messages from one or
+  more DataFlash logs through AC_LandDetector and prints one CSV line
+  of results per log.  A directory argument evaluates every .bin log
+  in it, e.g.:
+
+    LandDetectorReplay --parm LAND_DET_RNGFND=1 --parm LAND_DET_MOT_LOW=0.15 logs/
+
+  With --sweep the logs are decoded once and every combination of the
+  swept parameters is evaluated over all of them on all cores, printing
+  one CSV line of totals per grid point:
+
+    LandDetectorReplay --parm LAND_DET_RNGFND=1 --sweep LAND_DET_MOT_LOW=0.05:0.3:0.01 \
+        --sweep RNGFND1_GNDCLEAR=5,10,15,20 --sweep LAND_DETECTOR_TRIGGER_SEC=0.5:2:0.25 logs/
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/getopt_cpp.h>
+
+#include "LD_LogReader.h"
+#include "LD_Evaluator.h"
+#include "LD_Sweep.h"
+
+#include <stdio.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static LD_UserParam *user_params;
+static const char *trace_dir;
+static LD_Sweep *sweep;
+static uint8_t num_threads;
+
+static void usage(void)
+{
+    ::printf("Usage: LandDetectorReplay [OPTIONS] LOG|DIR...\n");
+    ::printf("Options:\n");
+    ::printf("\t--parm NAME=VALUE  override parameter NAME from the log with VALUE\n");
+    ::printf("\t--trace DIR        write land_detector_count trajectory of each log to DIR\n");
+    ::printf("\t--sweep NAME=START:STOP:STEP or NAME=V1,V2,...  add a parameter sweep axis\n");
+    ::printf("\t--threads N        number of sweep threads (default all CPUs)\n");
+}
+
+static void parse_command_line(uint8_t argc, char * const argv[], uint8_t &first_log)
+{
+    const struct GetOptLong::option options[] = {
+        // name           has_arg flag   val
+        {"parm",            true,   0, 'p'},
+        {"param",           true,   0, 'p'},
+        {"trace",           true,   0, 't'},
+        {"sweep",           true,   0, 's'},
+        {"threads",         true,   0, 'j'},
+        {"help",            false,  0, 'h'},
+        {0, false, 0, 0}
+    };
+
+    GetOptLong gopt(argc, argv, "p:t:s:j:h", options);
+
+    int opt;
+    while ((opt = gopt.getoption()) != -1) {
+        switch (opt) {
+        case 'p': {
+            const char *eq = strchr(gopt.optarg, '=');
+            if (eq == nullptr || size_t(eq - gopt.optarg) >= sizeof(user_params->name)) {
+                ::printf("Usage: -p NAME=VALUE\n");
+                exit(1);
+            }
+            LD_UserParam *u = new LD_UserParam {};
+            strncpy(u->name, gopt.optarg, eq-gopt.optarg);
+            u->value = atof(eq+1);
+            u->next = user_params;
+            user_params = u;
+            break;
+        }
+
+        case 't':
+            trace_dir = gopt.optarg;
+            break;
+
+        case 's':
+            if (sweep == nullptr) {
+                sweep = new LD_Sweep();
+            }
+            if (!sweep->add_axis(gopt.optarg)) {
+                ::printf("Bad sweep %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+
+        case 'j':
+            num_threads = atoi(gopt.optarg);
+            break;
+
+        case 'h':
+        default:
+            usage();
+            exit(0);
+        }
+    }
+
+    first_log = gopt.optind;
+}
+
+static void evaluate_log(const char *filename)
+{
+    FILE *trace = nullptr;
+    if (trace_dir != nullptr) {
+        const char *base = strrchr(filename, '/');
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.ld.csv", trace_dir, base ? base+1 : filename);
+        trace = fopen(path, "w");
+        if (trace == nullptr) {
+            ::printf("open(%s): %m\n", path);
+            exit(1);
+        }
+        ::fprintf(trace, "TimeUS,Count,Criteria\n");
+    }
+
+    LD_Evaluator evaluator{user_params};
+    evaluator.set_trace(trace);
+    {
+        LD_LogReader reader{evaluator};
+        if (!reader.open_log(filename)) {
+            ::printf("%s,open failed\n", filename);
+            return;
+        }
+        while (reader.update()) {
+        }
+    }
+    evaluator.finish();
+
+    if (trace != nullptr) {
+        fclose(trace);
+    }
+
+    const LD_Evaluator::Result &r = evaluator.get_result();
+    ::printf("%s,%u,%u,%u,%u,%u,%.3f,%.3f,%.3f\n",
+             filename,
+             unsigned(r.flights),
+             unsigned(r.landings),
+             unsigned(r.false_positives),
+             unsigned(r.missed),
+             unsigned(r.logged_landings),
+             r.landings ? r.ttl_sum_s / r.landings : 0.0f,
+             r.ttl_max_s,
+             r.logged_delta_count ? r.logged_delta_sum_s / r.logged_delta_count : 0.0f);
+}
+
+static void add_sweep_log(const char *filename)
+{
+    sweep->add_log(filename);
+}
+
+/*
+  call fn for a log, or all logs in a directory
+ */
+static void for_each_log(const char *path, void (*fn)(const char *))
+{
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fn(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (d == nullptr) {
+        ::printf("opendir(%s): %m\n", path);
+        return;
+    }
+    struct dirent *de;
+    while ((de = readdir(d)) != nullptr) {
+        const char *ext = strrchr(de->d_name, '.');
+        if (ext == nullptr || strcasecmp(ext, ".bin") != 0) {
+            continue;
+        }
+        char filename[256];
+        snprintf(filename, sizeof(filename), "%s/%s", path, de->d_name);
+        fn(filename);
+    }
+    closedir(d);
+}
+
+void setup()
+{
+    uint8_t argc;
+    char * const *argv;
+    hal.util->commandline_arguments(argc, argv);
+
+    uint8_t first_log = argc;
+    if (argc > 0) {
+        parse_command_line(argc, argv, first_log);
+    }
+    if (first_log >= argc) {
+        usage();
+        exit(1);
+    }
+
+    if (sweep != nullptr) {
+        for (uint8_t i=first_log; i<argc; i++) {
+            for_each_log(argv[i], add_sweep_log);
+        }
+        sweep->run(num_threads ? num_threads : LD_WorkPool::num_cpus(), user_params);
+        delete sweep;
+        exit(0);
+    }
+
+    ::printf("Log,Flights,Landings,FalsePositives,Missed,LoggedLandings,MeanTimeToLand,MaxTimeToLand,MeanDeltaToLogged\n");
+    for (uint8_t i=first_log; i<argc; i++) {
+        for_each_log(argv[i], evaluate_log);
+    }
+    exit(0);
+}
+
+void loop()
+{
+}
+
+AP_HAL_MAIN();
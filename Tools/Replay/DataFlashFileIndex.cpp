@@ -0,0 +1,323 @@
+#include "DataFlashFileIndex.h"
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define LOGINDEX_MAGIC "LIDX"
+#define LOGINDEX_VERSION 1
+
+AP_LoggerFileIndex::~AP_LoggerFileIndex()
+{
+    clear();
+}
+
+void AP_LoggerFileIndex::clear()
+{
+    free(times);
+    times = nullptr;
+    num_times = 0;
+    times_space = 0;
+    for (auto &t : tables) {
+        free(t.offsets);
+        t.offsets = nullptr;
+        t.count = 0;
+        t.space = 0;
+    }
+    last_us = 0;
+}
+
+/*
+  the messages needed to reconstruct replay state at an arbitrary point
+  in the log.  The DAL sensor headers are written only when they
+  change, so the last one before the start point is the current one
+ */
+bool AP_LoggerFileIndex::is_state_msg(const char *name)
+{
+    static const char *state_msgs[] = {
+        "FMT", "FMTU", "UNIT", "MULT", "PARM",
+        "RFRN", "RISH", "RASH", "RBRH", "RRNH", "RGPH", "RGPI",
+        "RMGH", "RBCH", "RVOH",
+    };
+    for (const char *s : state_msgs) {
+        if (strncmp(name, s, 4) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AP_LoggerFileIndex::log_identity(const char *logfile, uint64_t &size, uint64_t &mtime)
+{
+    struct stat st;
+    if (AP::FS().stat(logfile, &st) != 0) {
+        return false;
+    }
+    size = st.st_size;
+    mtime = st.st_mtime;
+    return true;
+}
+
+void AP_LoggerFileIndex::index_filename(const char *logfile, char *buf, uint16_t buflen)
+{
+    snprintf(buf, buflen, "%s.idx", logfile);
+}
+
+template<typename T>
+bool AP_LoggerFileIndex::grow(T *&array, uint32_t &space, uint32_t needed)
+{
+    if (needed <= space) {
+        return true;
+    }
+    const uint32_t new_space = MAX(needed, space ? space * 2 : 64U);
+    T *n = (T *)realloc(array, new_space * sizeof(T));
+    if (n == nullptr) {
+        return false;
+    }
+    array = n;
+    space = new_space;
+    return true;
+}
+
+void AP_LoggerFileIndex::begin(const char *logfile)
+{
+    clear();
+    if (!log_identity(logfile, log_size, log_mtime)) {
+        log_size = 0;
+        log_mtime = 0;
+    }
+    for (uint16_t i=0; i<LOGINDEX_MAX_TYPES; i++) {
+        timeus_ofs[i] = -1;
+        state_type[i] = false;
+    }
+    state_type[LOG_FORMAT_MSG] = true;
+}
+
+void AP_LoggerFileIndex::add(uint64_t ofs, const struct log_Format &f, const uint8_t *msg)
+{
+    const uint8_t type = msg[2];
+
+    if (type == LOG_FORMAT_MSG) {
+        // learn where (if anywhere) the new type keeps its timestamp;
+        // by convention TimeUS is always the first field
+        const struct log_Format &def = *(const struct log_Format *)msg;
+        char name[5] {};
+        memcpy(name, def.name, 4);
+        state_type[def.type] = is_state_msg(name);
+        if (def.format[0] == 'Q' && strncmp(def.labels, "TimeUS,", 7) == 0) {
+            timeus_ofs[def.type] = 3;
+        } else {
+            timeus_ofs[def.type] = -1;
+        }
+    }
+
+    if (state_type[type]) {
+        type_table &t = tables[type];
+        if (grow(t.offsets, t.space, t.count+1)) {
+            t.offsets[t.count++] = ofs;
+        }
+    }
+
+    if (timeus_ofs[type] < 0 || f.length < timeus_ofs[type] + sizeof(uint64_t)) {
+        return;
+    }
+    uint64_t time_us;
+    memcpy(&time_us, &msg[timeus_ofs[type]], sizeof(time_us));
+
+    // one entry per slice, pointing at the first message in it.  Logs
+    // are only approximately time ordered so never step backwards
+    const uint64_t slice_us = time_us - (time_us % (LOGINDEX_INTERVAL_MS * 1000ULL));
+    if (num_times == 0 || slice_us > times[num_times-1].time_us) {
+        if (grow(times, times_space, num_times+1)) {
+            times[num_times].time_us = slice_us;
+            times[num_times].offset = ofs;
+            num_times++;
+        }
+    }
+    last_us = MAX(last_us, time_us);
+}
+
+void AP_LoggerFileIndex::finish(uint64_t log_end)
+{
+    // a log which was read to a different length than it has on disk
+    // (e.g. truncated final message) is still indexed as read
+    if (log_size == 0) {
+        log_size = log_end;
+    }
+}
+
+// number of slices starting at or before time_us
+uint32_t AP_LoggerFileIndex::slices_upto(uint64_t time_us) const
+{
+    uint32_t lo = 0, hi = num_times;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (times[mid].time_us <= time_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool AP_LoggerFileIndex::offset_for_time(uint64_t time_us, uint64_t &ofs) const
+{
+    if (num_times == 0 || time_us > last_us) {
+        return false;
+    }
+    const uint32_t n = slices_upto(time_us);
+    ofs = times[n > 0 ? n-1 : 0].offset;
+    return true;
+}
+
+bool AP_LoggerFileIndex::offset_after_time(uint64_t time_us, uint64_t &ofs) const
+{
+    const uint32_t n = slices_upto(time_us);
+    if (n >= num_times) {
+        return false;
+    }
+    ofs = times[n].offset;
+    return true;
+}
+
+static int compare_offsets(const void *a, const void *b)
+{
+    const uint64_t oa = *(const uint64_t *)a;
+    const uint64_t ob = *(const uint64_t *)b;
+    return oa < ob ? -1 : (oa > ob ? 1 : 0);
+}
+
+uint64_t *AP_LoggerFileIndex::state_offsets_before(uint64_t ofs, uint32_t &count) const
+{
+    count = 0;
+    for (const auto &t : tables) {
+        for (uint32_t i=0; i<t.count && t.offsets[i] < ofs; i++) {
+            count++;
+        }
+    }
+    uint64_t *ret = (uint64_t *)malloc(MAX(count, 1U) * sizeof(uint64_t));
+    if (ret == nullptr) {
+        count = 0;
+        return nullptr;
+    }
+    uint32_t n = 0;
+    for (const auto &t : tables) {
+        for (uint32_t i=0; i<t.count && t.offsets[i] < ofs; i++) {
+            ret[n++] = t.offsets[i];
+        }
+    }
+    qsort(ret, count, sizeof(ret[0]), compare_offsets);
+    return ret;
+}
+
+static bool write_all(int fd, const void *buf, uint32_t len)
+{
+    return AP::FS().write(fd, buf, len) == (int32_t)len;
+}
+
+static bool read_all(int fd, void *buf, uint32_t len)
+{
+    return AP::FS().read(fd, buf, len) == (int32_t)len;
+}
+
+bool AP_LoggerFileIndex::save(const char *logfile) const
+{
+    char fname[256];
+    index_filename(logfile, fname, sizeof(fname));
+    const int fd = AP::FS().open(fname, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        return false;
+    }
+
+    file_header hdr {};
+    memcpy(hdr.magic, LOGINDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = LOGINDEX_VERSION;
+    hdr.interval_ms = LOGINDEX_INTERVAL_MS;
+    hdr.log_size = log_size;
+    hdr.log_mtime = log_mtime;
+    hdr.last_us = last_us;
+    hdr.num_times = num_times;
+    for (const auto &t : tables) {
+        if (t.count > 0) {
+            hdr.num_types++;
+        }
+    }
+
+    bool ok = write_all(fd, &hdr, sizeof(hdr)) &&
+        write_all(fd, times, num_times * sizeof(times[0]));
+    for (uint16_t i=0; ok && i<LOGINDEX_MAX_TYPES; i++) {
+        const type_table &t = tables[i];
+        if (t.count == 0) {
+            continue;
+        }
+        const uint8_t type = i;
+        ok = write_all(fd, &type, sizeof(type)) &&
+            write_all(fd, &t.count, sizeof(t.count)) &&
+            write_all(fd, t.offsets, t.count * sizeof(t.offsets[0]));
+    }
+    AP::FS().close(fd);
+    if (!ok) {
+        AP::FS().unlink(fname);
+    }
+    return ok;
+}
+
+bool AP_LoggerFileIndex::load(const char *logfile)
+{
+    clear();
+
+    uint64_t size, mtime;
+    if (!log_identity(logfile, size, mtime)) {
+        return false;
+    }
+
+    char fname[256];
+    index_filename(logfile, fname, sizeof(fname));
+    const int fd = AP::FS().open(fname, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    file_header hdr;
+    bool ok = read_all(fd, &hdr, sizeof(hdr)) &&
+        memcmp(hdr.magic, LOGINDEX_MAGIC, sizeof(hdr.magic)) == 0 &&
+        hdr.version == LOGINDEX_VERSION &&
+        hdr.interval_ms == LOGINDEX_INTERVAL_MS &&
+        hdr.log_size == size &&
+        hdr.log_mtime == mtime &&
+        grow(times, times_space, hdr.num_times) &&
+        read_all(fd, times, hdr.num_times * sizeof(times[0]));
+    if (ok) {
+        num_times = hdr.num_times;
+        log_size = hdr.log_size;
+        log_mtime = hdr.log_mtime;
+        last_us = hdr.last_us;
+    }
+    for (uint16_t i=0; ok && i<hdr.num_types; i++) {
+        uint8_t type;
+        uint32_t count;
+        ok = read_all(fd, &type, sizeof(type)) &&
+            read_all(fd, &count, sizeof(count));
+        if (!ok) {
+            break;
+        }
+        type_table &t = tables[type];
+        ok = t.count == 0 &&
+            grow(t.offsets, t.space, count) &&
+            read_all(fd, t.offsets, count * sizeof(t.offsets[0]));
+        if (ok) {
+            t.count = count;
+        }
+    }
+    AP::FS().close(fd);
+
+    if (!ok) {
+        clear();
+    }
+    return ok;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <AP_Logger/AP_Logger.h>
+
+/*
+  sidecar index for a DataFlash log, cached as <logfile>.idx
+
+  The index holds the offset of the first message in each
+  LOGINDEX_INTERVAL_MS slice of TimeUS, and per-type offset tables for
+  the messages which carry state a replay needs before it can start
+  part way through a log: formats, units, parameters and the DAL
+  sensor headers (which are only logged when they change).
+ */
+
+#define LOGINDEX_INTERVAL_MS 100
+#define LOGINDEX_MAX_TYPES 256
+
+class AP_LoggerFileIndex
+{
+public:
+    AP_LoggerFileIndex() {}
+    ~AP_LoggerFileIndex();
+
+    CLASS_NO_COPY(AP_LoggerFileIndex);
+
+    // load the cached index for logfile; fails if it is missing,
+    // corrupt or was built for a different version of the log
+    bool load(const char *logfile);
+
+    // write the index next to logfile
+    bool save(const char *logfile) const;
+
+    // building interface, fed every message in log order
+    void begin(const char *logfile);
+    void add(uint64_t ofs, const struct log_Format &f, const uint8_t *msg);
+    void finish(uint64_t log_end);
+
+    // offset of the first message in the slice containing time_us,
+    // or false if time_us is past the last indexed message
+    bool offset_for_time(uint64_t time_us, uint64_t &ofs) const;
+
+    // offset of the first slice starting after time_us, or false if
+    // there is none
+    bool offset_after_time(uint64_t time_us, uint64_t &ofs) const;
+
+    // offsets of the state messages before ofs in log order.  The
+    // returned array is owned by the caller
+    uint64_t *state_offsets_before(uint64_t ofs, uint32_t &count) const;
+
+    uint64_t first_time_us() const { return num_times ? times[0].time_us : 0; }
+    uint64_t last_time_us() const { return last_us; }
+
+    // true for message names whose most recent instance must be seen
+    // before a replay can start at an arbitrary point in the log
+    static bool is_state_msg(const char *name);
+
+private:
+    struct PACKED file_header {
+        char magic[4];
+        uint16_t version;
+        uint16_t interval_ms;
+        uint64_t log_size;
+        uint64_t log_mtime;
+        uint64_t last_us;
+        uint32_t num_times;
+        uint16_t num_types;
+    };
+
+    struct PACKED time_entry {
+        uint64_t time_us;
+        uint64_t offset;
+    };
+
+    struct type_table {
+        uint32_t count;
+        uint32_t space;
+        uint64_t *offsets;
+    };
+
+    static bool log_identity(const char *logfile, uint64_t &size, uint64_t &mtime);
+    static void index_filename(const char *logfile, char *buf, uint16_t buflen);
+
+    void clear();
+    uint32_t slices_upto(uint64_t time_us) const;
+    template<typename T>
+    static bool grow(T *&array, uint32_t &space, uint32_t needed);
+
+    uint64_t log_size = 0;
+    uint64_t log_mtime = 0;
+    uint64_t last_us = 0;
+
+    time_entry *times = nullptr;
+    uint32_t num_times = 0;
+    uint32_t times_space = 0;
+
+    type_table tables[LOGINDEX_MAX_TYPES] {};
+
+    // build state: TimeUS offset per type, or -1 if it has none
+    int16_t timeus_ofs[LOGINDEX_MAX_TYPES] {};
+    bool state_type[LOGINDEX_MAX_TYPES] {};
+};
@@ -1,4 +1,5 @@
 #include "DataFlashFileReader.h"
+#include "DataFlashFileIndex.h"
 #include <AP_Filesystem/AP_Filesystem.h>
 
 #include <fcntl.h>
@@ -9,6 +10,11 @@
 #include <time.h>
 #include <cinttypes>
 
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
@@ -18,11 +24,29 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
-    ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    if (fd != -1) {
+        AP::FS().close(fd);
+    }
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        munmap(map, map_len);
+    }
+#endif
+    free(filename);
+    if (!quiet) {
+        ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    }
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+    free(filename);
+    filename = strdup(logfile);
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (use_mmap && open_log_mapped(logfile)) {
+        return true;
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
@@ -30,73 +54,223 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     return true;
 }
 
-ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+bool AP_LoggerFileReader::open_log_mapped(const char *logfile)
 {
-    uint64_t ret = AP::FS().read(fd, buffer, count);
-    bytes_read += ret;
-    return ret;
+    const int mfd = ::open(logfile, O_RDONLY|O_CLOEXEC);
+    if (mfd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(mfd, &st) != 0 || st.st_size <= 0) {
+        ::close(mfd);
+        return false;
+    }
+    // a private writable mapping lets us keep handing out non-const
+    // message pointers; pages are only copied if a handler writes
+    void *p = mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, mfd, 0);
+    ::close(mfd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    // logs are consumed front to back exactly once
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    map = (uint8_t *)p;
+    map_len = st.st_size;
+    return true;
 }
+#endif // AP_LOGGERFILEREADER_MMAP_ENABLED
 
-void AP_LoggerFileReader::format_type(uint16_t type, char dest[5])
+ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
-    const struct log_Format &f = formats[type];
-    memset(dest,0,5);
-    if (f.length == 0) {
-        return;
+    const int32_t ret = AP::FS().read(fd, buffer, count);
+    if (ret > 0) {
+        bytes_read += ret;
+        offset += ret;
     }
-    strncpy(dest, f.name, 4);
+    return ret;
 }
-void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
+
+bool AP_LoggerFileReader::seek_offset(uint64_t ofs)
 {
-    memcpy(dest, packet_counts, sizeof(packet_counts));
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        if (ofs > map_len) {
+            return false;
+        }
+        offset = ofs;
+        return true;
+    }
+#endif
+    if (fd == -1 || ofs > INT32_MAX ||
+        AP::FS().lseek(fd, ofs, SEEK_SET) != (int32_t)ofs) {
+        return false;
+    }
+    offset = ofs;
+    return true;
 }
 
-bool AP_LoggerFileReader::update()
+bool AP_LoggerFileReader::read_next(uint8_t *&msg)
 {
-    uint8_t hdr[3];
-    if (read_input(hdr, 3) != 3) {
+    if (end_offset != 0 && offset >= end_offset) {
         return false;
     }
+
+    uint8_t *hdr;
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        if (map_len - offset < 3) {
+            return false;
+        }
+        hdr = &map[offset];
+    } else
+#endif
+    {
+        hdr = msgbuf;
+        if (read_input(hdr, 3) != 3) {
+            return false;
+        }
+    }
     if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
         printf("bad log header\n");
         return false;
     }
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
-    // running on stm32 is slow enough it is nice to see progress
-    if (message_count % 500 == 0) {
-        ::printf("line %u pkt 0x%02x t=%u\n", message_count, hdr[2], AP_HAL::millis());
+    uint8_t length;
+    if (hdr[2] == LOG_FORMAT_MSG) {
+        length = sizeof(struct log_Format);
+    } else {
+        length = formats[hdr[2]].length;
+        if (length == 0) {
+            // can't just throw these away as the format specifies the
+            // number of bytes in the message
+            ::printf("No format defined for type (%d)\n", hdr[2]);
+            exit(1);
+        }
     }
+
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        if (map_len - offset < length) {
+            return false;
+        }
+        offset += length;
+        bytes_read += length;
+    } else
 #endif
-    packet_counts[hdr[2]]++;
+    if (read_input(&hdr[3], length-3) != length-3) {
+        return false;
+    }
 
     if (hdr[2] == LOG_FORMAT_MSG) {
-        struct log_Format f;
-        memcpy(&f, hdr, 3);
-        if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
+        const struct log_Format &f = *(const struct log_Format *)hdr;
+        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+    }
+
+    msg = hdr;
+    return true;
+}
+
+bool AP_LoggerFileReader::build_index(AP_LoggerFileIndex &index)
+{
+    if (!seek_offset(0)) {
+        return false;
+    }
+    index.begin(filename);
+    while (true) {
+        const uint64_t ofs = offset;
+        uint8_t *msg;
+        if (!read_next(msg)) {
+            break;
+        }
+        index.add(ofs, formats[msg[2]], msg);
+    }
+    index.finish(offset);
+    return seek_offset(0);
+}
+
+bool AP_LoggerFileReader::seek_time(uint64_t start_us, uint64_t end_us)
+{
+    if (filename == nullptr || offset != 0) {
+        return false;
+    }
+
+    AP_LoggerFileIndex index;
+    if (!index.load(filename)) {
+        ::printf("Indexing %s\n", filename);
+        if (!build_index(index)) {
             return false;
         }
-        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        if (!index.save(filename)) {
+            ::printf("Unable to save index for %s\n", filename);
+        }
+    }
 
-        message_count++;
-        return handle_log_format_msg(f);
+    uint64_t start_ofs;
+    if (!index.offset_for_time(start_us, start_ofs)) {
+        ::printf("Start time %.3fs is outside log (%.3fs to %.3fs)\n",
+                 start_us*1.0e-6, index.first_time_us()*1.0e-6, index.last_time_us()*1.0e-6);
+        return false;
+    }
+    if (end_us != 0 && end_us < start_us) {
+        return false;
+    }
+    // stop at the first slice after end_us
+    uint64_t end_ofs = 0;
+    if (end_us != 0 && !index.offset_after_time(end_us, end_ofs)) {
+        end_ofs = 0;
     }
 
-    const struct log_Format &f = formats[hdr[2]];
-    if (f.length == 0) {
-        // can't just throw these away as the format specifies the
-        // number of bytes in the message
-        ::printf("No format defined for type (%d)\n", hdr[2]);
-        exit(1);
+    // bring formats, parameters and sensor state up to date as if the
+    // log had been replayed from the start
+    uint32_t count;
+    uint64_t *state = index.state_offsets_before(start_ofs, count);
+    if (state == nullptr) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t i=0; ok && i<count; i++) {
+        ok = seek_offset(state[i]) && update();
     }
+    free(state);
+
+    end_offset = end_ofs;
+    return ok && seek_offset(start_ofs);
+}
 
-    uint8_t msg[f.length];
+void AP_LoggerFileReader::format_type(uint16_t type, char dest[5])
+{
+    const struct log_Format &f = formats[type];
+    memset(dest,0,5);
+    if (f.length == 0) {
+        return;
+    }
+    strncpy(dest, f.name, 4);
+}
+void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
+{
+    memcpy(dest, packet_counts, sizeof(packet_counts));
+}
 
-    memcpy(msg, hdr, 3);
-    if (read_input(&msg[3], f.length-3) != f.length-3) {
+bool AP_LoggerFileReader::update()
+{
+    uint8_t *msg;
+    if (!read_next(msg)) {
         return false;
     }
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
+    // running on stm32 is slow enough it is nice to see progress
+    if (message_count % 500 == 0) {
+        ::printf("line %u pkt 0x%02x t=%u\n", message_count, msg[2], AP_HAL::millis());
+    }
+#endif
+    packet_counts[msg[2]]++;
     message_count++;
-    return handle_msg(f, msg);
+
+    if (msg[2] == LOG_FORMAT_MSG) {
+        return handle_log_format_msg(formats[msg[3]]);
+    }
+    return handle_msg(formats[msg[2]], msg);
 }
@@ -4,6 +4,10 @@
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+#ifndef AP_LOGGERFILEREADER_MMAP_ENABLED
+#define AP_LOGGERFILEREADER_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 class AP_LoggerFileReader
 {
 public:
@@ -14,12 +18,34 @@ public:
     bool open_log(const char *logfile);
     bool update();
 
+    // restrict replay to messages between start_us and end_us (log
+    // TimeUS; end_us of zero means the end of the log).  Uses the
+    // sidecar index next to the log, building it if needed, and
+    // replays the FMT/PARM and sensor-state messages which precede
+    // the window before positioning the reader at its start.  Must be
+    // called after open_log and before the first update
+    virtual bool seek_time(uint64_t start_us, uint64_t end_us);
+
+    // byte offset of the next message, and repositioning to a message
+    // boundary previously returned by get_offset
+    uint64_t get_offset() const { return offset; }
+    bool seek_offset(uint64_t ofs);
+
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
     virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
 
     void format_type(uint16_t type, char dest[5]);
     void get_packet_counts(uint64_t dest[]);
 
+    // don't print the replay counts on destruction; used by tools
+    // which process many logs in one run
+    void set_quiet(bool _quiet) { quiet = _quiet; }
+
+    // when true (the default where supported) open_log maps the whole
+    // file and handle_msg is passed pointers into the mapping rather
+    // than a copy of each message.  Must be set before open_log.
+    void set_use_mmap(bool _use_mmap) { use_mmap = _use_mmap; }
+
 protected:
     int fd = -1;
 
@@ -28,9 +54,31 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+    // read the next message without dispatching it.  msg points into
+    // the mapping or at msgbuf; FMT messages also update formats[]
+    bool read_next(uint8_t *&msg);
+
+    // build the sidecar index by scanning the whole log
+    bool build_index(class AP_LoggerFileIndex &index);
+
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    bool open_log_mapped(const char *logfile);
+
+    // whole-file private mapping; messages are handed out in place
+    uint8_t *map = nullptr;
+    size_t map_len = 0;
+#endif
+    bool use_mmap = AP_LOGGERFILEREADER_MMAP_ENABLED;
+
+    uint8_t msgbuf[256];  // large enough for any message length
+    uint64_t offset = 0;
+    uint64_t end_offset = 0;
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
+    bool quiet = false;
+    char *filename = nullptr;
 
     uint64_t packet_counts[LOGREADER_MAX_FORMATS] = {};
 };
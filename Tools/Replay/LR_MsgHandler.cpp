@@ -304,6 +304,22 @@ void LR_MsgHandler_REVH::process_message(uint8_t *msgbytes)
 #include <AP_AHRS/AP_AHRS.h>
 #include "VehicleType.h"
 
+void LR_MsgHandler_XKF1::process_message(uint8_t *msg)
+{
+    const uint8_t core = require_field_uint8_t(msg, "C");
+    const Vector3f vel {
+        require_field_float(msg, "VN"),
+        require_field_float(msg, "VE"),
+        require_field_float(msg, "VD"),
+    };
+    const Vector3f pos {
+        require_field_float(msg, "PN"),
+        require_field_float(msg, "PE"),
+        require_field_float(msg, "PD"),
+    };
+    stats.update_logged_ekf(ekf3, core, vel, pos);
+}
+
 bool LR_MsgHandler_PARM::set_parameter(const char *name, const float value)
 {
     const char *ignore_parms[] = {
@@ -5,6 +5,7 @@
 #include <AP_GPS/AP_GPS.h>
 #include <AP_NavEKF2/AP_NavEKF2.h>
 #include <AP_NavEKF3/AP_NavEKF3.h>
+#include "ReplayStats.h"
 
 class LR_MsgHandler : public MsgHandler {
 public:
@@ -240,6 +241,18 @@ public:
     void process_message(uint8_t *msg) override;
 };
 
+// the EKF3 estimate logged in flight, compared against the replay
+class LR_MsgHandler_XKF1 : public LR_MsgHandler_EKF
+{
+public:
+    LR_MsgHandler_XKF1(log_Format &_f, NavEKF2 &_ekf2, NavEKF3 &_ekf3, ReplayStats &_stats) :
+        LR_MsgHandler_EKF(_f, _ekf2, _ekf3),
+        stats(_stats) {}
+    void process_message(uint8_t *msg) override;
+private:
+    ReplayStats &stats;
+};
+
 class LR_MsgHandler_PARM : public LR_MsgHandler
 {
 public:
@@ -66,6 +66,7 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
         msgparser[f.type] = new LR_MsgHandler_RFRH(formats[f.type]);
     } else if (streq(name, "RFRF")) {
         msgparser[f.type] = new LR_MsgHandler_RFRF(formats[f.type], ekf2, ekf3);
+        rfrf_type = f.type;
     } else if (streq(name, "RFRN")) {
         msgparser[f.type] = new LR_MsgHandler_RFRN(formats[f.type]);
     } else if (streq(name, "REV2")) {
@@ -126,6 +127,8 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
         msgparser[f.type] = new LR_MsgHandler_RWOH(formats[f.type], ekf2, ekf3);
     } else if (streq(name, "RBOH")) {
         msgparser[f.type] = new LR_MsgHandler_RBOH(formats[f.type], ekf2, ekf3);
+    } else if (streq(name, "XKF1")) {
+        msgparser[f.type] = new LR_MsgHandler_XKF1(formats[f.type], ekf2, ekf3, stats);
 	} else {
         // debug("  No parser for (%s)\n", name);
     }
@@ -133,6 +136,20 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
     return true;
 }
 
+/*
+  start replay part way through the log.  The seek lands on an index
+  slice boundary which is generally mid-frame, so the partial frame is
+  dropped rather than fed to the EKF
+ */
+bool LogReader::seek_time(uint64_t start_us, uint64_t end_us)
+{
+    if (!AP_LoggerFileReader::seek_time(start_us, end_us)) {
+        return false;
+    }
+    wait_for_frame_start = true;
+    return true;
+}
+
 bool LogReader::handle_msg(const struct log_Format &f, uint8_t *msg) {
     // emit the output as we receive it:
     AP::logger().WriteBlock(msg, f.length);
@@ -142,8 +159,19 @@ bool LogReader::handle_msg(const struct log_Format &f, uint8_t *msg) {
         return true;
     }
 
+    if (wait_for_frame_start) {
+        if (strncmp(f.name, "RFRH", 4) != 0) {
+            return true;
+        }
+        wait_for_frame_start = false;
+    }
+
     p->process_message(msg);
 
+    if (f.type == rfrf_type) {
+        stats.update_frame(ekf3);
+    }
+
     return true;
 }
 
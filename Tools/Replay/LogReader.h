@@ -18,8 +18,12 @@ public:
     bool handle_log_format_msg(const struct log_Format &f) override;
     bool handle_msg(const struct log_Format &f, uint8_t *msg) override;
 
+    bool seek_time(uint64_t start_us, uint64_t end_us) override;
+
     static bool in_list(const char *type, const char *list[]);
 
+    ReplayStats &get_stats() { return stats; }
+
 protected:
 
 private:
@@ -31,6 +35,14 @@ private:
     uint8_t _log_structure_count;
 
     class LR_MsgHandler *msgparser[LOGREADER_MAX_FORMATS] {};
+
+    // message type of RFRF, the end of each replayed frame
+    int16_t rfrf_type = -1;
+
+    ReplayStats stats;
+
+    // after a seek, ignore replay messages until the next frame starts
+    bool wait_for_frame_start = false;
 };
 
 // some vars are difficult to get through the layers
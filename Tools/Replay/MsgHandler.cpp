@@ -105,6 +105,17 @@ void MsgHandler::parse_format_fields()
     free(format);
 }
 
+bool MsgHandler::field_offset(const char *label, uint8_t &type, uint8_t &offset)
+{
+    const struct format_field_info *info = find_field_info(label);
+    if (info == NULL || info->offset == 0) {
+        return false;
+    }
+    type = info->type;
+    offset = info->offset;
+    return true;
+}
+
 bool MsgHandler::field_value(uint8_t *msg, const char *label, char *ret, uint8_t retlen)
 {
     struct format_field_info *info = find_field_info(label);
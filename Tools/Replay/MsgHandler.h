@@ -44,14 +44,24 @@ public:
     uint16_t require_field_uint16_t(uint8_t *msg, const char *label);
     int16_t require_field_int16_t(uint8_t *msg, const char *label);
 
+    // field_offset - look up the type and offset of a field once so
+    // that it can be read with field_value_at() without a label search
+    // on every message.  Returns false if the field was not found
+    bool field_offset(const char *label, uint8_t &type, uint8_t &offset);
+
+    template<typename R>
+    static void field_value_at(uint8_t *msg, uint8_t type, uint8_t offset, R &ret) {
+        field_value_for_type_at_offset(msg, type, offset, ret);
+    }
+
 private:
 
     void add_field(const char *_label, uint8_t _type, uint8_t _offset,
                    uint8_t length);
 
     template<typename R>
-    void field_value_for_type_at_offset(uint8_t *msg, uint8_t type,
-                                        uint8_t offset, R &ret);
+    static void field_value_for_type_at_offset(uint8_t *msg, uint8_t type,
+                                               uint8_t offset, R &ret);
 
     struct format_field_info { // parsed field information
         char *label;
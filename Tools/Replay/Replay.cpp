@@ -130,11 +130,31 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--no-mmap read the log with read() rather than mapping it\n");
+    ::printf("\t--start-time SECONDS  start replay at log time SECONDS\n");
+    ::printf("\t--end-time SECONDS  stop replay after log time SECONDS\n");
+#if EK3_FEATURE_PARALLEL_LANES
+    ::printf("\t--parallel-lanes update each EKF3 core on its own thread\n");
+#endif
+    ::printf("\t--summary FILENAME  write a JSON summary of EKF3 innovations, divergence and runtime\n");
+#if REPLAY_BATCH_ENABLED
+    ::printf("\t--batch replay every log (or directory of logs) given, one process per log\n");
+    ::printf("\t--jobs N  number of logs to replay at once in batch mode (default: number of CPUs)\n");
+    ::printf("\t--batch-dir DIR  output directory for batch mode (default: replay_batch)\n");
+#endif
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    NO_MMAP,
+    START_TIME,
+    END_TIME,
+    PARALLEL_LANES,
+    SUMMARY,
+    BATCH,
+    JOBS,
+    BATCH_DIR,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -146,6 +166,14 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"no-mmap",         false,  0, param_key::NO_MMAP},
+        {"start-time",      true,   0, param_key::START_TIME},
+        {"end-time",        true,   0, param_key::END_TIME},
+        {"parallel-lanes",  false,  0, param_key::PARALLEL_LANES},
+        {"summary",         true,   0, param_key::SUMMARY},
+        {"batch",           false,  0, param_key::BATCH},
+        {"jobs",            true,   0, param_key::JOBS},
+        {"batch-dir",       true,   0, param_key::BATCH_DIR},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -181,6 +209,44 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::NO_MMAP:
+            reader.set_use_mmap(false);
+            break;
+
+        case param_key::START_TIME:
+            start_time_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
+        case param_key::END_TIME:
+            end_time_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
+#if EK3_FEATURE_PARALLEL_LANES
+        case param_key::PARALLEL_LANES:
+            _vehicle.ekf3.set_parallel_lanes(true);
+            break;
+#endif
+
+        case param_key::SUMMARY:
+            summary_file = gopt.optarg;
+            break;
+
+#if REPLAY_BATCH_ENABLED
+        case param_key::BATCH:
+            if (batch == nullptr) {
+                batch = new ReplayBatch();
+            }
+            break;
+
+        case param_key::JOBS:
+            batch_jobs = atoi(gopt.optarg);
+            break;
+
+        case param_key::BATCH_DIR:
+            batch_dir = gopt.optarg;
+            break;
+#endif
+
         case 'h':
         default:
             usage();
@@ -191,6 +257,15 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
     argv += gopt.optind;
     argc -= gopt.optind;
 
+#if REPLAY_BATCH_ENABLED
+    if (batch != nullptr) {
+        for (uint8_t i=0; i<argc; i++) {
+            batch->add_path(argv[i]);
+        }
+        return;
+    }
+#endif
+
     if (argc > 0) {
         filename = argv[0];
     }
@@ -209,6 +284,19 @@ void Replay::setup()
         _parse_command_line(argc, argv);
     }
 
+#if REPLAY_BATCH_ENABLED
+    if (batch != nullptr) {
+        if (batch->num_logs() == 0) {
+            ::printf("You must supply at least one log for --batch\n");
+            exit(1);
+        }
+        // only the children return; each replays one log from here on
+        filename = batch->run(batch_jobs ? batch_jobs : ReplayBatch::num_cpus(),
+                              batch_dir, summary_file, summary_fd);
+        summary_file = nullptr;
+    }
+#endif
+
     _vehicle.setup();
 
     set_user_parameters();
@@ -239,11 +327,45 @@ void Replay::setup()
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
+    if (start_time_us != 0 || end_time_us != 0) {
+        if (!reader.seek_time(start_time_us, end_time_us)) {
+            ::printf("Unable to seek to %.3fs in %s\n", start_time_us*1.0e-6, filename);
+            exit(1);
+        }
+    }
+    reader.get_stats().start();
+}
+
+/*
+  write the summary for this log, either to the --summary file as a
+  one element array or, in a batch child, to the parent
+ */
+void Replay::write_summary()
+{
+    if (summary_fd != -1) {
+        reader.get_stats().write_json(summary_fd, filename);
+        AP::FS().close(summary_fd);
+        summary_fd = -1;
+        return;
+    }
+    if (summary_file == nullptr) {
+        return;
+    }
+    const int fd = AP::FS().open(summary_file, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        ::printf("open(%s): %m\n", summary_file);
+        return;
+    }
+    AP::FS().write(fd, "[\n", 2);
+    reader.get_stats().write_json(fd, filename);
+    AP::FS().write(fd, "\n]\n", 3);
+    AP::FS().close(fd);
 }
 
 void Replay::loop()
 {
     if (!reader.update()) {
+        write_summary();
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // If we don't tear down the threads then they continue to access
     // global state during object destruction.
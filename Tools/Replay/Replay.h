@@ -18,6 +18,7 @@
 #include <SRV_Channel/SRV_Channel.h>
 
 #include "LogReader.h"
+#include "ReplayBatch.h"
 
 #define AP_PARAM_VEHICLE_NAME replayvehicle
 
@@ -97,8 +98,20 @@ public:
 
 private:
     const char *filename;
+    uint64_t start_time_us;
+    uint64_t end_time_us;
     ReplayVehicle &_vehicle;
 
+    // JSON summary of the replay, written when the log is finished
+    const char *summary_file;
+    int summary_fd = -1;
+
+#if REPLAY_BATCH_ENABLED
+    ReplayBatch *batch;
+    uint16_t batch_jobs;
+    const char *batch_dir = "replay_batch";
+#endif
+
     LogReader reader{_vehicle.log_structure, _vehicle.ekf2, _vehicle.ekf3};
 
     void _parse_command_line(uint8_t argc, char * const argv[]);
@@ -107,4 +120,5 @@ private:
     bool parse_param_line(char *line, char **vname, float &value);
     void load_param_file(const char *filename);
     void usage();
+    void write_summary();
 };
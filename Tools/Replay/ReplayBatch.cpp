@@ -0,0 +1,313 @@
+#include "ReplayBatch.h"
+
+#if REPLAY_BATCH_ENABLED
+
+#include "ReplayStats.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+ReplayBatch::~ReplayBatch()
+{
+    for (uint16_t i=0; i<num_entries; i++) {
+        free(entries[i].logfile);
+        free(entries[i].result);
+    }
+    free(entries);
+}
+
+uint16_t ReplayBatch::num_cpus()
+{
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+void ReplayBatch::add_log(const char *path)
+{
+    // children chdir into their output directory, so they need the
+    // absolute path of their log
+    char *logfile = realpath(path, nullptr);
+    if (logfile == nullptr) {
+        ::printf("%s: %m\n", path);
+        return;
+    }
+    entry *n = (entry *)realloc(entries, (num_entries+1) * sizeof(entry));
+    if (n == nullptr) {
+        free(logfile);
+        return;
+    }
+    entries = n;
+    entries[num_entries++] = entry {logfile, -1, -1, 0, false, nullptr, 0};
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+void ReplayBatch::add_path(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        add_log(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (d == nullptr) {
+        ::printf("opendir(%s): %m\n", path);
+        return;
+    }
+    // readdir order is arbitrary; keep the summary in name order
+    char **names = nullptr;
+    uint32_t count = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != nullptr) {
+        const char *ext = strrchr(de->d_name, '.');
+        if (ext == nullptr || strcasecmp(ext, ".bin") != 0) {
+            continue;
+        }
+        char **n = (char **)realloc(names, (count+1) * sizeof(char *));
+        if (n == nullptr) {
+            break;
+        }
+        names = n;
+        names[count++] = strdup(de->d_name);
+    }
+    closedir(d);
+    if (count > 0) {
+        qsort(names, count, sizeof(names[0]), compare_names);
+    }
+    for (uint32_t i=0; i<count; i++) {
+        char filename[PATH_MAX];
+        snprintf(filename, sizeof(filename), "%s/%s", path, names[i]);
+        add_log(filename);
+        free(names[i]);
+    }
+    free(names);
+}
+
+/*
+  in the child: move into this log's output directory and send the
+  replay chatter to a file there so that the children's output does
+  not interleave
+ */
+static bool enter_output_dir(uint16_t idx, const char *logfile, const char *outdir)
+{
+    const char *base = strrchr(logfile, '/');
+    base = base ? base+1 : logfile;
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/%03u-%s", outdir, unsigned(idx), base);
+    char *ext = strrchr(dir, '.');
+    if (ext != nullptr && strcasecmp(ext, ".bin") == 0) {
+        *ext = 0;
+    }
+    if ((mkdir(dir, 0755) != 0 && errno != EEXIST) || chdir(dir) != 0) {
+        ::printf("%s: %m\n", dir);
+        return false;
+    }
+    const int fd = open("replay.txt", O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+    return true;
+}
+
+bool ReplayBatch::read_result(entry &e)
+{
+    if (e.fd == -1) {
+        return false;
+    }
+    char buf[512];
+    ssize_t n;
+    do {
+        n = read(e.fd, buf, sizeof(buf));
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        char *r = (char *)realloc(e.result, e.result_len + n + 1);
+        if (r != nullptr) {
+            e.result = r;
+            memcpy(&e.result[e.result_len], buf, n);
+            e.result_len += n;
+            e.result[e.result_len] = 0;
+            return true;
+        }
+    }
+    close(e.fd);
+    e.fd = -1;
+    return false;
+}
+
+void ReplayBatch::poll_results()
+{
+    struct pollfd *fds = (struct pollfd *)calloc(num_entries, sizeof(struct pollfd));
+    entry **polled = (entry **)calloc(num_entries, sizeof(entry *));
+    nfds_t nfds = 0;
+    if (fds != nullptr && polled != nullptr) {
+        for (uint16_t i=0; i<num_entries; i++) {
+            if (entries[i].fd != -1) {
+                fds[nfds] = { entries[i].fd, POLLIN, 0 };
+                polled[nfds++] = &entries[i];
+            }
+        }
+    }
+    // wake up now and again to reap children which exited without
+    // anything left to read
+    if (nfds > 0 && poll(fds, nfds, 100) > 0) {
+        for (nfds_t i=0; i<nfds; i++) {
+            if (fds[i].revents != 0) {
+                // one read at most, so this can not block
+                read_result(*polled[i]);
+            }
+        }
+    }
+    free(fds);
+    free(polled);
+}
+
+void ReplayBatch::finish(entry &e, int status)
+{
+    e.status = status;
+    e.done = true;
+    const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && e.result_len > 0;
+    ::printf("%s %s\n", ok ? "OK    " : "FAILED", e.logfile);
+}
+
+const char *ReplayBatch::run(uint16_t jobs, const char *outdir, const char *summary_file, int &summary_fd)
+{
+    if (mkdir(outdir, 0755) != 0 && errno != EEXIST) {
+        ::printf("%s: %m\n", outdir);
+        exit(1);
+    }
+    jobs = MAX(jobs, 1U);
+    ::printf("Replaying %u logs with %u jobs into %s\n", unsigned(num_entries), unsigned(jobs), outdir);
+
+    uint16_t next = 0;
+    uint16_t running = 0;
+    while (next < num_entries || running > 0) {
+        if (next < num_entries && running < jobs) {
+            entry &e = entries[next];
+            int fds[2];
+            if (pipe(fds) != 0) {
+                ::printf("pipe: %m\n");
+                exit(1);
+            }
+            fflush(stdout);
+            fflush(stderr);
+            e.pid = fork();
+            if (e.pid == 0) {
+                close(fds[0]);
+                for (uint16_t i=0; i<next; i++) {
+                    if (entries[i].fd != -1) {
+                        close(entries[i].fd);
+                    }
+                }
+                if (!enter_output_dir(next, e.logfile, outdir)) {
+                    _exit(1);
+                }
+                summary_fd = fds[1];
+                return e.logfile;
+            }
+            close(fds[1]);
+            if (e.pid < 0) {
+                ::printf("fork: %m\n");
+                close(fds[0]);
+                finish(e, -1);
+            } else {
+                e.fd = fds[0];
+                running++;
+            }
+            next++;
+            continue;
+        }
+
+        // drain the pipes while waiting, a child blocked writing its
+        // summary to a full pipe would otherwise never exit
+        poll_results();
+        bool any_open = false;
+        for (uint16_t i=0; i<next; i++) {
+            any_open |= entries[i].fd != -1;
+        }
+
+        int status;
+        const pid_t pid = waitpid(-1, &status, any_open ? WNOHANG : 0);
+        if (pid == 0) {
+            continue;
+        }
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (uint16_t i=0; i<next; i++) {
+            entry &e = entries[i];
+            if (e.pid == pid && !e.done) {
+                // the child has exited so reading the rest can not block
+                while (read_result(e)) {
+                }
+                finish(e, status);
+                running--;
+                break;
+            }
+        }
+    }
+
+    write_summary(summary_file);
+
+    for (uint16_t i=0; i<num_entries; i++) {
+        const entry &e = entries[i];
+        if (!WIFEXITED(e.status) || WEXITSTATUS(e.status) != 0 || e.result_len == 0) {
+            exit(1);
+        }
+    }
+    exit(0);
+}
+
+void ReplayBatch::write_summary(const char *summary_file) const
+{
+    FILE *f = stdout;
+    if (summary_file != nullptr) {
+        f = fopen(summary_file, "w");
+        if (f == nullptr) {
+            ::printf("%s: %m\n", summary_file);
+            f = stdout;
+        }
+    }
+    fprintf(f, "[\n");
+    for (uint16_t i=0; i<num_entries; i++) {
+        const entry &e = entries[i];
+        const char *sep = i+1 < num_entries ? "," : "";
+        if (WIFEXITED(e.status) && WEXITSTATUS(e.status) == 0 && e.result_len > 0) {
+            fprintf(f, "%s%s\n", e.result, sep);
+            continue;
+        }
+        char logfile[2*PATH_MAX];
+        ReplayStats::json_string(e.logfile, logfile, sizeof(logfile));
+        if (e.status != -1 && WIFSIGNALED(e.status)) {
+            fprintf(f, "{\"log\":%s,\"status\":\"failed\",\"signal\":%d}%s\n",
+                    logfile, WTERMSIG(e.status), sep);
+        } else {
+            fprintf(f, "{\"log\":%s,\"status\":\"failed\",\"exit\":%d}%s\n",
+                    logfile, e.status == -1 ? -1 : WEXITSTATUS(e.status), sep);
+        }
+    }
+    fprintf(f, "]\n");
+    if (f != stdout) {
+        fclose(f);
+    }
+}
+
+#endif // REPLAY_BATCH_ENABLED
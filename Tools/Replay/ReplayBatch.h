@@ -0,0 +1,82 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+/*
+  batch replay is forked from Replay::setup(), which on SITL runs
+  before any HAL thread has been started. Other HALs start threads in
+  their init, which a forked child would not have
+ */
+#ifndef REPLAY_BATCH_ENABLED
+#define REPLAY_BATCH_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if REPLAY_BATCH_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+  replay many logs, one child process per log and up to jobs children
+  at a time.
+
+  The parent forks after the command line (including any parameter
+  file) has been parsed but before the vehicle is set up, so each
+  child inherits the HAL and the user parameters and then sets up its
+  own vehicle, parameter storage and logger. Each child runs in its
+  own directory under the output directory so its logs and eeprom.bin
+  do not collide with the others, and reports its ReplayStats summary
+  back to the parent over a pipe.
+ */
+class ReplayBatch
+{
+public:
+    ReplayBatch() {}
+    ~ReplayBatch();
+
+    CLASS_NO_COPY(ReplayBatch);
+
+    // add a log, or every .bin log in a directory
+    void add_path(const char *path);
+
+    uint16_t num_logs() const { return num_entries; }
+
+    /*
+      run the batch. Returns only in a child, with the log it is to
+      replay (an absolute path) and the file descriptor it should
+      write its summary to. The parent writes the combined summary to
+      summary_file (or stdout) and exits, with a non-zero status if
+      any log failed
+     */
+    const char *run(uint16_t jobs, const char *outdir, const char *summary_file, int &summary_fd);
+
+    static uint16_t num_cpus();
+
+private:
+    struct entry {
+        char *logfile;
+        pid_t pid;
+        int fd;
+        int status;
+        bool done;
+        // summary received from the child
+        char *result;
+        uint32_t result_len;
+    };
+
+    void add_log(const char *path);
+    // read what the child has written so far, closing the pipe at
+    // end of file. Returns false once the pipe is closed
+    bool read_result(entry &e);
+    // read from every running child that has written to its pipe, so
+    // a child whose summary is larger than the pipe buffer can exit
+    void poll_results();
+    void finish(entry &e, int status);
+    void write_summary(const char *summary_file) const;
+
+    entry *entries = nullptr;
+    uint16_t num_entries = 0;
+};
+
+#endif // REPLAY_BATCH_ENABLED
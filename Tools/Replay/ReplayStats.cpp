@@ -0,0 +1,127 @@
+#include "ReplayStats.h"
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_DAL/AP_DAL.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+
+#include <stdio.h>
+
+void ReplayStats::start()
+{
+    *this = ReplayStats();
+    start_us = AP_HAL::micros64();
+}
+
+void ReplayStats::update_frame(const NavEKF3 &ekf3)
+{
+    const uint64_t now_us = AP::dal().micros64();
+    if (frames == 0) {
+        first_frame_us = now_us;
+    }
+    last_frame_us = now_us;
+    frames++;
+
+    if (ekf3.activeCores() == 0) {
+        return;
+    }
+    const int8_t primary = ekf3.getPrimaryCoreIndex();
+    if (last_primary >= 0 && primary != last_primary) {
+        lane_switches++;
+    }
+    last_primary = primary;
+
+    // these are the square roots of the test ratios, so a value over
+    // one means the measurement was rejected
+    float vel_ratio, pos_ratio, hgt_ratio, tas_ratio;
+    Vector3f mag_ratio;
+    Vector2f offset;
+    if (!ekf3.getVariances(vel_ratio, pos_ratio, hgt_ratio, mag_ratio, tas_ratio, offset)) {
+        return;
+    }
+    const float mag_max = mag_ratio.length();
+    vel.update(vel_ratio);
+    pos.update(pos_ratio);
+    hgt.update(hgt_ratio);
+    mag.update(mag_max);
+    ekf_frames++;
+    if (vel_ratio > 1 || pos_ratio > 1 || hgt_ratio > 1 || mag_max > 1) {
+        innov_fail_frames++;
+    }
+}
+
+void ReplayStats::update_logged_ekf(const NavEKF3 &ekf3, uint8_t core,
+                                    const Vector3f &logged_vel, const Vector3f &logged_pos)
+{
+    // only the lane the replay is currently using is compared; XKF1
+    // from a log that was itself produced by Replay carries core+100
+    if (ekf3.activeCores() == 0 || core != ekf3.getPrimaryCoreIndex()) {
+        return;
+    }
+    Vector2f posNE;
+    float posD;
+    Vector3f velNED;
+    if (!ekf3.getPosNE(posNE) || !ekf3.getPosD(posD)) {
+        return;
+    }
+    ekf3.getVelNED(velNED);
+
+    const Vector2f ne_err { posNE.x - logged_pos.x, posNE.y - logged_pos.y };
+    max_pos_ne_err = MAX(max_pos_ne_err, ne_err.length());
+    max_pos_d_err = MAX(max_pos_d_err, fabsf(posD - logged_pos.z));
+    max_vel_err = MAX(max_vel_err, (velNED - logged_vel).length());
+    compared++;
+}
+
+void ReplayStats::json_string(const char *str, char *buf, uint16_t buflen)
+{
+    uint16_t n = 0;
+    if (buflen < 3) {
+        return;
+    }
+    buf[n++] = '"';
+    for (const char *p = str; *p && n+3 < buflen; p++) {
+        const uint8_t c = *p;
+        if (c == '"' || c == '\\') {
+            buf[n++] = '\\';
+        } else if (c < 0x20) {
+            continue;
+        }
+        buf[n++] = c;
+    }
+    buf[n++] = '"';
+    buf[n] = 0;
+}
+
+void ReplayStats::write_json(int fd, const char *logfile) const
+{
+    char log_str[512];
+    json_string(logfile, log_str, sizeof(log_str));
+
+    const double runtime = (AP_HAL::micros64() - start_us) * 1.0e-6;
+    const double duration = (last_frame_us - first_frame_us) * 1.0e-6;
+    const uint32_t n = MAX(ekf_frames, 1U);
+
+    char buf[1536];
+    const int len = snprintf(buf, sizeof(buf),
+        "{\"log\":%s,\"status\":\"ok\","
+        "\"runtime_s\":%.3f,\"log_duration_s\":%.3f,\"frames\":%u,"
+        "\"ekf3_frames\":%u,\"lane_switches\":%u,\"innov_fail_frames\":%u,"
+        "\"vel_ratio_max\":%.3f,\"vel_ratio_mean\":%.3f,"
+        "\"pos_ratio_max\":%.3f,\"pos_ratio_mean\":%.3f,"
+        "\"hgt_ratio_max\":%.3f,\"hgt_ratio_mean\":%.3f,"
+        "\"mag_ratio_max\":%.3f,\"mag_ratio_mean\":%.3f,"
+        "\"compared_samples\":%u,\"pos_ne_err_max\":%.3f,"
+        "\"pos_d_err_max\":%.3f,\"vel_err_max\":%.3f}",
+        log_str, runtime, duration, unsigned(frames),
+        unsigned(ekf_frames), unsigned(lane_switches), unsigned(innov_fail_frames),
+        vel.max, vel.sum / n,
+        pos.max, pos.sum / n,
+        hgt.max, hgt.sum / n,
+        mag.max, mag.sum / n,
+        unsigned(compared), max_pos_ne_err,
+        max_pos_d_err, max_vel_err);
+    if (len > 0) {
+        AP::FS().write(fd, buf, MIN(len, int(sizeof(buf)-1)));
+    }
+}
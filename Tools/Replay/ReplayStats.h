@@ -0,0 +1,70 @@
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+class NavEKF3;
+
+/*
+  per-log summary of a replay: how hard the EKF3 primary core's
+  innovation consistency checks were pushed, how far the replayed
+  estimate diverged from the one logged in flight, and how long the
+  replay took
+ */
+class ReplayStats
+{
+public:
+    void start();
+
+    // called after each replayed frame
+    void update_frame(const NavEKF3 &ekf3);
+
+    // called for each XKF1 in the input log, i.e. the estimate the
+    // vehicle computed in flight
+    void update_logged_ekf(const NavEKF3 &ekf3, uint8_t core,
+                           const Vector3f &vel, const Vector3f &pos);
+
+    // write a JSON object (one line, no trailing newline) to fd
+    void write_json(int fd, const char *logfile) const;
+
+    // quote and escape str as a JSON string
+    static void json_string(const char *str, char *buf, uint16_t buflen);
+
+private:
+    struct ratio_stat {
+        float max;
+        double sum;
+        void reset() {
+            max = 0;
+            sum = 0;
+        }
+        void update(float r) {
+            max = MAX(max, r);
+            sum += r;
+        }
+    };
+
+    // wall clock, from AP_HAL::micros64()
+    uint64_t start_us = 0;
+
+    // log time, from AP::dal().micros64()
+    uint64_t first_frame_us = 0;
+    uint64_t last_frame_us = 0;
+
+    uint32_t frames = 0;
+    uint32_t ekf_frames = 0;
+    uint32_t innov_fail_frames = 0;
+    uint16_t lane_switches = 0;
+    int8_t last_primary = -1;
+
+    // innovation test ratios of the primary core
+    ratio_stat vel {};
+    ratio_stat pos {};
+    ratio_stat hgt {};
+    ratio_stat mag {};
+
+    // divergence from the logged estimate
+    uint32_t compared = 0;
+    float max_pos_ne_err = 0;
+    float max_pos_d_err = 0;
+    float max_vel_err = 0;
+};
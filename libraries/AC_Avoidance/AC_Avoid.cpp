@@ -1144,7 +1144,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 
     AP_Proximity &_proximity = *proximity;
     // get total number of obstacles
-    const uint8_t obstacle_num = _proximity.get_obstacle_count();
+    const uint16_t obstacle_num = _proximity.get_obstacle_count();
     if (obstacle_num == 0) {
         // no obstacles
         return;
@@ -1173,7 +1173,8 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
         stopping_point_plus_margin = safe_vel * ((2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed))/speed);
     }
 
-    for (uint8_t i = 0; i<obstacle_num; i++) {
+    // only visit obstacles in the populated parts of the boundary
+    for (uint16_t i = _proximity.get_next_obstacle(0); i<obstacle_num; i = _proximity.get_next_obstacle(i+1)) {
         // get obstacle from proximity library
         Vector3f vector_to_obstacle;
         if (!_proximity.get_obstacle(i, vector_to_obstacle)) {
@@ -1251,6 +1252,18 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
         }
     }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // the boundary keeps one distance per face, so the direction to an obstacle can be off by up to half a
+    // sector. The closest return in the point cloud gives the direction itself, so sliding along a wall or
+    // past a pole follows the obstacle rather than the face
+    Vector3f vector_to_point;
+    if (!desired_vel_cms.is_zero() &&
+        _proximity.get_closest_pointcloud_obstacle((margin_cm + get_stopping_distance(kP, accel_cmss, safe_vel_orig.length())) * 0.01f, vector_to_point) &&
+        !vector_to_point.is_zero()) {
+        limit_velocity_3D(kP, accel_cmss, safe_vel, vector_to_point, margin_cm, kP_z, accel_cmss_z, dt);
+    }
+#endif
+
     // desired backup velocity is sum of maximum velocity component in each quadrant 
     const Vector2f desired_back_vel_cms_xy = quad_1_back_vel + quad_2_back_vel + quad_3_back_vel + quad_4_back_vel;
     const float desired_back_vel_cms_z = max_back_vel_z + min_back_vel_z;
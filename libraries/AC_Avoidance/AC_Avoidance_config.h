@@ -23,6 +23,11 @@
 #define AP_OAPATHPLANNER_DIJKSTRA_ENABLED AP_OAPATHPLANNER_BACKEND_DEFAULT_ENABLED
 #endif
 
+// cache the shortest paths between all pairs of fence points.  needs up to 20kB on boards with 64 point fences
+#ifndef AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+#define AP_OADIJKSTRA_ALL_PAIRS_ENABLED (AP_OAPATHPLANNER_DIJKSTRA_ENABLED && HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
 
 
 #ifndef AP_OADATABASE_ENABLED
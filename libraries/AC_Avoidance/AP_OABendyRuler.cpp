@@ -21,6 +21,7 @@
 #include <AC_Avoidance/AP_OADatabase.h>
 #include <AC_Fence/AC_Fence.h>
 #include <AP_AHRS/AP_AHRS.h>
+#include <AP_InternalError/AP_InternalError.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
@@ -151,7 +152,31 @@ bool AP_OABendyRuler::search_xy_path(const Location& current_loc, const Location
     float best_margin = -FLT_MAX;
     float best_margin_bearing = best_bearing;
 
-    for (uint8_t i = 0; i <= (170 / OA_BENDYRULER_BEARING_INC_XY); i++) {
+    // margins are calculated in batches of bearings, starting with the bearing straight towards the destination
+    // alone and doubling the range of bearings each time, so a clear path is found as quickly as before but
+    // wider searches share the work of each obstacle between many bearings
+    const uint8_t num_steps = (170 / OA_BENDYRULER_BEARING_INC_XY) + 1;
+    static_assert(2 * num_steps <= AP_OABENDYRULER_MARGIN_BATCH_MAX, "increase AP_OABENDYRULER_MARGIN_BATCH_MAX");
+    float margins[AP_OABENDYRULER_MARGIN_BATCH_MAX];
+    uint8_t margin_idx = 0;
+    uint8_t batch_end = 0;
+
+    for (uint8_t i = 0; i < num_steps; i++) {
+        if (i == batch_end) {
+            batch_end = MIN(MAX(2 * i, i + 1), num_steps);
+            margin_batch_start(current_loc);
+            for (uint8_t k = i; k < batch_end; k++) {
+                for (uint8_t bdir = 0; bdir <= 1; bdir++) {
+                    if ((k==0) && (bdir > 0)) {
+                        continue;
+                    }
+                    const float bearing_delta = k * OA_BENDYRULER_BEARING_INC_XY * (bdir == 0 ? -1.0f : 1.0f);
+                    margin_batch_add(wrap_180(bearing_to_dest + bearing_delta), lookahead_step1_dist);
+                }
+            }
+            calc_avoidance_margins(margins, proximity_only);
+            margin_idx = 0;
+        }
         for (uint8_t bdir = 0; bdir <= 1; bdir++) {
             // skip duplicate check of bearing straight towards destination
             if ((i==0) && (bdir > 0)) {
@@ -164,12 +189,8 @@ bool AP_OABendyRuler::search_xy_path(const Location& current_loc, const Location
             // ToDo: add effective groundspeed calculations using airspeed
             // ToDo: add prediction of vehicle's position change as part of turn to desired heading
 
-            // test location is projected from current location at test bearing
-            Location test_loc = current_loc;
-            test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
-
-            // calculate margin from obstacles for this scenario
-            float margin = calc_avoidance_margin(current_loc, test_loc, proximity_only);
+            // margin from obstacles for this scenario
+            const float margin = margins[margin_idx++];
             if (margin > best_margin) {
                 best_margin_bearing = bearing_test;
                 best_margin = margin;
@@ -188,17 +209,23 @@ bool AP_OABendyRuler::search_xy_path(const Location& current_loc, const Location
                     best_bearing_margin = margin;
                 }
 
+                // test location is projected from current location at test bearing
+                Location test_loc = current_loc;
+                test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
+
                 // perform second stage test in three directions looking for obstacles
                 const float test_bearings[] { 0.0f, 45.0f, -45.0f };
                 const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
                 float distance2 = constrain_float(lookahead_step2_dist, OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
+                float margins2[ARRAY_SIZE(test_bearings)];
+                margin_batch_start(test_loc);
                 for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
-                    float bearing_test2 = wrap_180(bearing_to_dest2 + test_bearings[j]);
-                    Location test_loc2 = test_loc;
-                    test_loc2.offset_bearing(bearing_test2, distance2);
-
-                    // calculate minimum margin to fence and obstacles for this scenario
-                    float margin2 = calc_avoidance_margin(test_loc, test_loc2, proximity_only);
+                    margin_batch_add(wrap_180(bearing_to_dest2 + test_bearings[j]), distance2);
+                }
+                // calculate minimum margin to fence and obstacles for these scenarios
+                calc_avoidance_margins(margins2, proximity_only);
+                for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
+                    const float margin2 = margins2[j];
                     if (margin2 > _margin_max) {
                         // if the chosen direction is directly towards the destination avoidance can be turned off
                         // i == 0 && j == 0 implies no deviation from bearing to destination 
@@ -457,6 +484,63 @@ float AP_OABendyRuler::calc_avoidance_margin(const Location &start, const Locati
     return margin_min;
 }
 
+// start a new batch of segments from start
+void AP_OABendyRuler::margin_batch_start(const Location &start)
+{
+    _batch.start = start;
+    _batch.start_NE_ok = start.get_vector_xy_from_origin_NE(_batch.start_NE);
+    _batch.start_NEU_ok = start.get_vector_from_origin_NEU(_batch.start_NEU);
+    _batch.count = 0;
+}
+
+// add a segment from the batch start in the given direction (in degrees) for the given distance (in meters)
+void AP_OABendyRuler::margin_batch_add(float bearing_deg, float distance)
+{
+    if (_batch.count >= AP_OABENDYRULER_MARGIN_BATCH_MAX) {
+        INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
+        return;
+    }
+    // same offsets as Location::offset_bearing
+    const uint8_t k = _batch.count++;
+    _batch.end_n[k] = cosf(radians(bearing_deg)) * distance * 100.0f;
+    _batch.end_e[k] = sinf(radians(bearing_deg)) * distance * 100.0f;
+    const float len_sq = sq(_batch.end_n[k]) + sq(_batch.end_e[k]);
+    _batch.inv_len_sq[k] = (len_sq < FLT_EPSILON) ? 0.0f : 1.0f / len_sq;
+}
+
+// calculate the margin of every segment in the batch, the same as calc_avoidance_margin would for each segment
+void AP_OABendyRuler::calc_avoidance_margins(float *margins, bool proximity_only)
+{
+    for (uint8_t k = 0; k < _batch.count; k++) {
+        margins[k] = FLT_MAX;
+    }
+
+    calc_margins_from_object_database(margins);
+
+    if (proximity_only) {
+        // only need margin from proximity data
+        return;
+    }
+
+    calc_margins_from_circular_fence(margins);
+
+    #if VERTICAL_ENABLED
+    // alt fence only is only needed in vertical avoidance.  all segments are level so share the start's margin
+    if (get_type() == OABendyType::OA_BENDY_VERTICAL) {
+        float alt_margin;
+        if (calc_margin_from_alt_fence(_batch.start, _batch.start, alt_margin)) {
+            for (uint8_t k = 0; k < _batch.count; k++) {
+                margins[k] = MIN(margins[k], alt_margin);
+            }
+        }
+    }
+    #endif
+
+    calc_margins_from_inclusion_and_exclusion_polygons(margins);
+
+    calc_margins_from_inclusion_and_exclusion_circles(margins);
+}
+
 // calculate minimum distance between a path and the circular fence (centered on home)
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_circular_fence(const Location &start, const Location &end, float &margin) const
@@ -487,6 +571,34 @@ bool AP_OABendyRuler::calc_margin_from_circular_fence(const Location &start, con
 #endif // AP_FENCE_ENABLED
 }
 
+// batch version of calc_margin_from_circular_fence
+void AP_OABendyRuler::calc_margins_from_circular_fence(float *margins) const
+{
+#if AP_FENCE_ENABLED
+    // exit immediately if polygon fence is not enabled
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_CIRCLE) == 0) {
+        return;
+    }
+
+    // start's distance from home is shared by all segments
+    const Vector2f start_from_home = AP::ahrs().get_home().get_distance_NE(_batch.start);
+    const float start_dist_sq = start_from_home.length_squared();
+
+    // get circular fence radius + margin
+    const float fence_radius_plus_margin = fence->get_radius() - fence->get_margin();
+
+    // margin is fence radius minus the longer of start or end distance
+    for (uint8_t k = 0; k < _batch.count; k++) {
+        const float end_dist_sq = sq(start_from_home.x + _batch.end_n[k] * 0.01f) + sq(start_from_home.y + _batch.end_e[k] * 0.01f);
+        margins[k] = MIN(margins[k], fence_radius_plus_margin - sqrtf(MAX(start_dist_sq, end_dist_sq)));
+    }
+#endif // AP_FENCE_ENABLED
+}
+
 // calculate minimum distance between a path and the altitude fence
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_alt_fence(const Location &start, const Location &end, float &margin) const
@@ -593,6 +705,55 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Lo
 #endif // AP_FENCE_ENABLED
 }
 
+// batch version of calc_margin_from_inclusion_and_exclusion_polygons
+void AP_OABendyRuler::calc_margins_from_inclusion_and_exclusion_polygons(float *margins)
+{
+#if AP_FENCE_ENABLED
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+
+    // exclusion polygons enabled along with polygon fences
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
+        return;
+    }
+
+    // return immediately if no inclusion nor exclusion polygons
+    const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
+    if ((num_inclusion_polygons == 0) && (num_exclusion_polygons == 0)) {
+        return;
+    }
+    if (!_batch.start_NE_ok) {
+        return;
+    }
+
+    // get fence margin
+    const float fence_margin = fence->get_margin();
+
+    for (uint16_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        const bool inclusion = i < num_inclusion_polygons;
+        uint16_t num_points;
+        const Vector2f* boundary = inclusion ? fence->polyfence().get_inclusion_polygon(i, num_points) :
+                                               fence->polyfence().get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if (boundary == nullptr) {
+            continue;
+        }
+
+        // if outside an inclusion polygon or inside an exclusion polygon the margin's sign is reversed
+        const bool outside = Polygon_outside(_batch.start_NE, boundary, num_points);
+        const float sign = (outside == inclusion) ? -1.0f : 1.0f;
+
+        // min distance (in meters) from each segment to the polygon, negative if the segment crosses it
+        Polygon_closest_distance_lines(boundary, num_points, _batch.start_NE, _batch.end_n, _batch.end_e, _batch.count, _batch.dist, _batch.work);
+        for (uint8_t k = 0; k < _batch.count; k++) {
+            margins[k] = MIN(margins[k], (sign * _batch.dist[k] * 0.01f) - fence_margin);
+        }
+    }
+#endif // AP_FENCE_ENABLED
+}
+
 // calculate minimum distance between a path and all inclusion and exclusion circles
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_circles(const Location &start, const Location &end, float &margin) const
@@ -673,6 +834,64 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_circles(const Loc
 #endif // AP_FENCE_ENABLED
 }
 
+// batch version of calc_margin_from_inclusion_and_exclusion_circles
+void AP_OABendyRuler::calc_margins_from_inclusion_and_exclusion_circles(float *margins) const
+{
+#if AP_FENCE_ENABLED
+    // exit immediately if fence is not enabled
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return;
+    }
+
+    // inclusion/exclusion circles enabled along with polygon fences
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
+        return;
+    }
+
+    // return immediately if no inclusion nor exclusion circles
+    const uint8_t num_inclusion_circles = fence->polyfence().get_inclusion_circle_count();
+    const uint8_t num_exclusion_circles = fence->polyfence().get_exclusion_circle_count();
+    if ((num_inclusion_circles == 0) && (num_exclusion_circles == 0)) {
+        return;
+    }
+    if (!_batch.start_NE_ok) {
+        return;
+    }
+
+    // get fence margin
+    const float fence_margin = fence->get_margin();
+
+    // inclusion circles: margin is fence radius minus the longer of start or end distance from the center
+    for (uint8_t i = 0; i < num_inclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
+            const Vector2f center = center_pos_cm - _batch.start_NE;
+            const float start_dist_sq = center.length_squared();
+            for (uint8_t k = 0; k < _batch.count; k++) {
+                const float end_dist_sq = sq(_batch.end_n[k] - center.x) + sq(_batch.end_e[k] - center.y);
+                margins[k] = MIN(margins[k], (radius + fence_margin) - (sqrtf(MAX(start_dist_sq, end_dist_sq)) * 0.01f));
+            }
+        }
+    }
+
+    // exclusion circles: margin is distance from the segment to the center minus the radius
+    for (uint8_t i = 0; i < num_exclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
+            const Vector2f center = center_pos_cm - _batch.start_NE;
+            for (uint8_t k = 0; k < _batch.count; k++) {
+                const float t = MIN(MAX((center.x * _batch.end_n[k] + center.y * _batch.end_e[k]) * _batch.inv_len_sq[k], 0.0f), 1.0f);
+                const float dist_cm = sqrtf(sq(_batch.end_n[k] * t - center.x) + sq(_batch.end_e[k] * t - center.y));
+                margins[k] = MIN(margins[k], (dist_cm * 0.01f) - (radius + fence_margin));
+            }
+        }
+    }
+#endif // AP_FENCE_ENABLED
+}
+
 // calculate minimum distance between a path and proximity sensor obstacles
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, const Location &end, float &margin) const
@@ -692,25 +911,31 @@ bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, co
         return false;
     }
 
-    // check each obstacle's distance from segment
-    float smallest_margin = FLT_MAX;
-    for (uint16_t i=0; i<oaDb->database_count(); i++) {
-        const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
-        const Vector3f point_cm = item.pos * 100.0f;
-        // margin is distance between line segment and obstacle minus obstacle's radius
-        const float m = Vector3f::closest_distance_between_line_and_point(start_NEU, end_NEU, point_cm) * 0.01f - item.radius;
-        if (m < smallest_margin) {
-            smallest_margin = m;
-        }
-    }
+    // margin is distance between line segment and closest obstacle minus obstacle's radius
+    // the database only checks obstacles near the segment
+    return oaDb->get_min_margin_to_path(start_NEU * 0.01f, end_NEU * 0.01f, margin);
+}
 
-    // return smallest margin
-    if (smallest_margin < FLT_MAX) {
-        margin = smallest_margin;
-        return true;
+// batch version of calc_margin_from_object_database
+void AP_OABendyRuler::calc_margins_from_object_database(float *margins) const
+{
+    // exit immediately if db is empty
+    AP_OADatabase *oaDb = AP::oadatabase();
+    if (oaDb == nullptr || !oaDb->healthy() || !_batch.start_NEU_ok) {
+        return;
     }
 
-    return false;
+    const Vector3f start = _batch.start_NEU * 0.01f;
+    for (uint8_t k = 0; k < _batch.count; k++) {
+        if (is_zero(_batch.end_n[k]) && is_zero(_batch.end_e[k])) {
+            continue;
+        }
+        const Vector3f end = start + Vector3f{_batch.end_n[k] * 0.01f, _batch.end_e[k] * 0.01f, 0.0f};
+        float margin;
+        if (oaDb->get_min_margin_to_path(start, end, margin)) {
+            margins[k] = MIN(margins[k], margin);
+        }
+    }
 }
 
 #endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
@@ -9,6 +9,9 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_Logger/AP_Logger_config.h>
 
+// maximum number of segments whose margins can be calculated together, enough for every bearing tested in the XY search
+#define AP_OABENDYRULER_MARGIN_BATCH_MAX    72
+
 /*
  * BendyRuler avoidance algorithm for avoiding the polygon and circular fence and dynamic objects detected by the proximity sensor
  */
@@ -48,6 +51,38 @@ private:
     // calculate minimum distance between a path and any obstacle
     float calc_avoidance_margin(const Location &start, const Location &end, bool proximity_only) const;
 
+    // segments from a common start, held as arrays of end points so that each obstacle's margin is calculated
+    // for every segment in one pass and values which only depend on the start or the obstacle are shared
+    struct MarginBatch {
+        Location start;
+        Vector2f start_NE;                              // start as offset (in cm) from EKF origin
+        Vector3f start_NEU;                             // start as offset (in cm) from EKF origin including altitude
+        bool start_NE_ok;                               // true if above offsets are valid
+        bool start_NEU_ok;
+        uint8_t count;                                  // number of segments
+        float end_n[AP_OABENDYRULER_MARGIN_BATCH_MAX];  // segment ends as offsets (in cm) from start
+        float end_e[AP_OABENDYRULER_MARGIN_BATCH_MAX];
+        float inv_len_sq[AP_OABENDYRULER_MARGIN_BATCH_MAX]; // one over segment length squared, zero for zero length segments
+        float dist[AP_OABENDYRULER_MARGIN_BATCH_MAX];       // distance from each segment to a polygon
+        float work[AP_OABENDYRULER_MARGIN_BATCH_MAX];       // working space for polygon distances
+    } _batch;
+
+    // start a new batch of segments from start
+    void margin_batch_start(const Location &start);
+
+    // add a segment from the batch start in the given direction (in degrees) for the given distance (in meters)
+    void margin_batch_add(float bearing_deg, float distance);
+
+    // calculate the margin of every segment in the batch, the same as calc_avoidance_margin would for each segment
+    // margins must hold one value per segment
+    void calc_avoidance_margins(float *margins, bool proximity_only);
+
+    // batch versions of the margin calculations below, each lowers margins where the obstacle is closer
+    void calc_margins_from_circular_fence(float *margins) const;
+    void calc_margins_from_inclusion_and_exclusion_polygons(float *margins);
+    void calc_margins_from_inclusion_and_exclusion_circles(float *margins) const;
+    void calc_margins_from_object_database(float *margins) const;
+
     // determine if BendyRuler should accept the new bearing or try and resist it. Returns true if bearing is not changed  
     bool resist_bearing_change(const Location &destination, const Location &current_loc, bool active, float bearing_test, float lookahead_step1_dist, float margin, Location &prev_dest, float &prev_bearing, float &final_bearing, float &final_margin, bool proximity_only) const;    
 
@@ -40,6 +40,13 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_DISTANCE_FROM_HOME 3
 #endif
 
+// size in meters of the grid cells objects are indexed by
+#ifndef AP_OADATABASE_CELL_SIZE
+    #define AP_OADATABASE_CELL_SIZE 2.0f
+#endif
+
+#define AP_OADATABASE_INDEX_NONE UINT16_MAX
+
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
     // @Param: SIZE
@@ -132,6 +139,8 @@ void AP_OADatabase::init()
         GCS_SEND_TEXT(MAV_SEVERITY_INFO, "DB init failed . Sizes queue:%u, db:%u", (unsigned int)_queue.size, (unsigned int)_database.size);
         delete _queue.items;
         delete[] _database.items;
+        delete[] _index.bucket_head;
+        delete[] _index.next;
         return;
     }
 }
@@ -144,6 +153,7 @@ void AP_OADatabase::update()
 
     process_queue();
     database_items_remove_all_expired();
+    index_update_max_radius();
 }
 
 // push a location into the database
@@ -206,6 +216,132 @@ void AP_OADatabase::init_database()
     }
 
     _database.items = new OA_DbItem[_database.size];
+    init_index();
+}
+
+void AP_OADatabase::init_index()
+{
+    // about one item per bucket when full
+    _index.num_buckets = 1;
+    while (_index.num_buckets < _database.size && _index.num_buckets < 0x8000) {
+        _index.num_buckets <<= 1;
+    }
+    _index.bucket_head = new uint16_t[_index.num_buckets];
+    _index.next = new uint16_t[_database.size];
+    if (_index.bucket_head == nullptr || _index.next == nullptr) {
+        delete[] _index.bucket_head;
+        delete[] _index.next;
+        _index.bucket_head = nullptr;
+        _index.next = nullptr;
+        return;
+    }
+    for (uint16_t i=0; i<_index.num_buckets; i++) {
+        _index.bucket_head[i] = AP_OADATABASE_INDEX_NONE;
+    }
+}
+
+void AP_OADatabase::index_cell(const Vector3f &pos, int32_t &x, int32_t &y) const
+{
+    x = floorf(pos.x * (1.0f / AP_OADATABASE_CELL_SIZE));
+    y = floorf(pos.y * (1.0f / AP_OADATABASE_CELL_SIZE));
+}
+
+uint16_t AP_OADatabase::index_bucket(int32_t x, int32_t y) const
+{
+    const uint32_t h = (uint32_t(x) * 73856093U) ^ (uint32_t(y) * 19349663U);
+    return (h ^ (h >> 16)) & (_index.num_buckets - 1);
+}
+
+// add database item "index" to the front of its bucket
+void AP_OADatabase::index_insert(const uint16_t index)
+{
+    int32_t x, y;
+    index_cell(_database.items[index].pos, x, y);
+    const uint16_t b = index_bucket(x, y);
+    _index.next[index] = _index.bucket_head[b];
+    _index.bucket_head[b] = index;
+    _index.max_radius = MAX(_index.max_radius, _database.items[index].radius);
+}
+
+// unlink database item "index" from its bucket
+void AP_OADatabase::index_remove(const uint16_t index)
+{
+    int32_t x, y;
+    index_cell(_database.items[index].pos, x, y);
+    uint16_t *link = &_index.bucket_head[index_bucket(x, y)];
+    while (*link != AP_OADATABASE_INDEX_NONE) {
+        if (*link == index) {
+            *link = _index.next[index];
+            return;
+        }
+        link = &_index.next[*link];
+    }
+}
+
+// radii only ever grow between calls to this
+void AP_OADatabase::index_update_max_radius()
+{
+    float max_radius = 0;
+    for (uint16_t i=0; i<_database.count; i++) {
+        max_radius = MAX(max_radius, _database.items[i].radius);
+    }
+    _index.max_radius = max_radius;
+}
+
+template <typename F>
+bool AP_OADatabase::index_visit(const Vector2f &lo, const Vector2f &hi, float dist, F visit) const
+{
+    int32_t x0, y0, x1, y1;
+    index_cell(Vector3f{lo.x - dist, lo.y - dist, 0}, x0, y0);
+    index_cell(Vector3f{hi.x + dist, hi.y + dist, 0}, x1, y1);
+
+    // once there are more cells than items it is quicker to check every item
+    const float num_cells = (float(x1) - x0 + 1) * (float(y1) - y0 + 1);
+    if (num_cells >= _database.count) {
+        for (uint16_t i=0; i<_database.count; i++) {
+            visit(i);
+        }
+        return true;
+    }
+
+    for (int32_t x=x0; x<=x1; x++) {
+        for (int32_t y=y0; y<=y1; y++) {
+            for (uint16_t i=_index.bucket_head[index_bucket(x, y)]; i != AP_OADATABASE_INDEX_NONE; i=_index.next[i]) {
+                // buckets are shared by distant cells
+                int32_t ix, iy;
+                index_cell(_database.items[i].pos, ix, iy);
+                if (ix == x && iy == y) {
+                    visit(i);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool AP_OADatabase::get_min_margin_to_path(const Vector3f &start, const Vector3f &end, float &margin) const
+{
+    if (!healthy() || _database.count == 0) {
+        return false;
+    }
+
+    const Vector2f lo { MIN(start.x, end.x), MIN(start.y, end.y) };
+    const Vector2f hi { MAX(start.x, end.x), MAX(start.y, end.y) };
+    float best = FLT_MAX;
+    const auto visit = [&](uint16_t i) {
+        const OA_DbItem &item = _database.items[i];
+        best = MIN(best, Vector3f::closest_distance_between_line_and_point(start, end, item.pos) - item.radius);
+    };
+
+    // widen the search until no unvisited item could have a smaller margin
+    for (float dist = AP_OADATABASE_CELL_SIZE; ; dist *= 2) {
+        if (index_visit(lo, hi, dist, visit) || best <= dist - _index.max_radius) {
+            break;
+        }
+    }
+
+    margin = best;
+    return true;
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -265,17 +401,11 @@ bool AP_OADatabase::process_queue()
 
         item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
-        bool found = false;
-        for (uint16_t i=0; i<_database.count; i++) {
-            if (is_close_to_item_in_database(i, item)) {
-                database_item_refresh(i, item.timestamp_ms, item.radius);
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
+        // compare item to nearby items in database. If found a similar item, update the existing, else add it as a new one
+        const int32_t close_index = find_close_item_in_database(item);
+        if (close_index >= 0) {
+            database_item_refresh(close_index, item.timestamp_ms, item.radius);
+        } else {
             database_item_add(item);
         }
     }
@@ -289,6 +419,7 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    index_insert(_database.count);
     _database.count++;
 }
 
@@ -302,6 +433,7 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
     // radius of 0 tells the GCS we don't care about it any more (aka it expired)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+    index_remove(index);
 
     _database.count--;
     if (_database.count == 0) {
@@ -310,7 +442,9 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
 
     if (index != _database.count) {
         // copy last object in array over expired object
+        index_remove(_database.count);
         _database.items[index] = _database.items[_database.count];
+        index_insert(index);
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
     }
 }
@@ -331,6 +465,7 @@ void AP_OADatabase::database_item_refresh(const uint16_t index, const uint32_t t
         // and trigger resending to GCS
         _database.items[index].timestamp_ms = timestamp_ms;
         _database.items[index].radius = radius;
+        _index.max_radius = MAX(_index.max_radius, radius);
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
     }
 }
@@ -369,6 +504,19 @@ bool AP_OADatabase::is_close_to_item_in_database(const uint16_t index, const OA_
     return ((distance_sq < sq(item.radius)) || (distance_sq < sq(_database.items[index].radius)));
 }
 
+// returns index of the first database item close to "item" or -1 if there is none
+int32_t AP_OADatabase::find_close_item_in_database(const OA_DbItem &item) const
+{
+    int32_t found = -1;
+    const float dist = MAX(item.radius, _index.max_radius);
+    index_visit(item.pos.xy(), item.pos.xy(), dist, [&](uint16_t i) {
+        if ((found < 0 || i < found) && is_close_to_item_in_database(i, item)) {
+            found = i;
+        }
+    });
+    return found;
+}
+
 #if HAL_GCS_ENABLED
 // send ADSB_VEHICLE mavlink messages
 void AP_OADatabase::send_adsb_vehicle(mavlink_channel_t chan, uint16_t interval_ms)
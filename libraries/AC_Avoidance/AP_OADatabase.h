@@ -42,7 +42,7 @@ public:
     void queue_push(const Vector3f &pos, uint32_t timestamp_ms, float distance);
 
     // returns true if database is healthy
-    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr); }
+    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr) && (_index.bucket_head != nullptr); }
 
     // fetch an item in database. Undefined result when i >= _database.count.
     const OA_DbItem& get_item(uint32_t i) const { return _database.items[i]; }
@@ -50,6 +50,11 @@ public:
     // get number of items in the database
     uint16_t database_count() const { return _database.count; }
 
+    // get the smallest margin (distance minus radius, in meters) between any item and the
+    // path from start to end, which are offsets in meters from the EKF origin.
+    // returns false if the database is empty
+    bool get_min_margin_to_path(const Vector3f &start, const Vector3f &end, float &margin) const;
+
     // empty queue and try and put into database. Return true if there's more work to do
     bool process_queue();
 
@@ -77,6 +82,22 @@ private:
     // returns true if database item "index" is close to "item"
     bool is_close_to_item_in_database(const uint16_t index, const OA_DbItem &item) const;
 
+    // returns index of the first database item close to "item" or -1 if there is none
+    int32_t find_close_item_in_database(const OA_DbItem &item) const;
+
+    // spatial index management
+    void init_index();
+    void index_cell(const Vector3f &pos, int32_t &x, int32_t &y) const;
+    uint16_t index_bucket(int32_t x, int32_t y) const;
+    void index_insert(const uint16_t index);
+    void index_remove(const uint16_t index);
+    void index_update_max_radius();
+
+    // call visit(index) for every item within dist meters horizontally of the
+    // rectangle lo to hi, and possibly others. Returns true if every item was visited
+    template <typename F>
+    bool index_visit(const Vector2f &lo, const Vector2f &hi, float dist, F visit) const;
+
     // enum for use with _OUTPUT parameter
     enum class OutputLevel {
         NONE = 0,
@@ -108,6 +129,15 @@ private:
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
     } _database;
 
+    // items are hashed by the horizontal grid cell they are in, with the items in
+    // each bucket chained through next, so lookups only visit nearby items
+    struct {
+        uint16_t        *bucket_head;                       // first item in each bucket
+        uint16_t        *next;                              // next item in the same bucket, indexed as _database.items
+        uint16_t        num_buckets;                        // power of two
+        float           max_radius;                         // no item's radius is larger than this
+    } _index;
+
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
     uint16_t _highest_index_sent[MAVLINK_COMM_NUM_BUFFERS]; // highest index in _database sent to GCS
     uint32_t _last_send_to_gcs_ms[MAVLINK_COMM_NUM_BUFFERS];// system time that send_adsb_vehicle was last called
@@ -31,6 +31,28 @@
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
 #define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
+#define OA_DIJKSTRA_EDGE_VISIBLE                        255     // edge state for edges which do not intersect any zone
+#define OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN                254     // edge state for edges blocked by a zone whose number is too large to store
+#define OA_DIJKSTRA_POINT_NONE                          UINT16_MAX
+
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+// maximum number of fence points for which the shortest paths between all pairs of points are cached
+// memory required is 5 bytes per pair of points
+#ifndef AP_OADIJKSTRA_ALL_PAIRS_MAX_POINTS
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_OADIJKSTRA_ALL_PAIRS_MAX_POINTS              254
+#else
+#define AP_OADIJKSTRA_ALL_PAIRS_MAX_POINTS              64
+#endif
+#endif
+
+// free memory which must remain after allocating the all-pairs cache
+#ifndef AP_OADIJKSTRA_ALL_PAIRS_MEM_RESERVE
+#define AP_OADIJKSTRA_ALL_PAIRS_MEM_RESERVE             16384
+#endif
+#endif
+
+extern const AP_HAL::HAL& hal;
 
 /// Constructor
 AP_OADijkstra::AP_OADijkstra(AP_Int16 &options) :
@@ -39,10 +61,22 @@ AP_OADijkstra::AP_OADijkstra(AP_Int16 &options) :
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _astar_heap(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
 
+// use A* search with a heap of open nodes instead of scanning all nodes for the closest
+void AP_OADijkstra::set_use_astar(bool use_astar)
+{
+    if (use_astar != _use_astar) {
+        _use_astar = use_astar;
+        // A* uses adjacency lists instead of the all-pairs cache so rebuild the visgraph to create them
+        _polyfence_visgraph_ok = false;
+        _shortest_path_ok = false;
+    }
+}
+
 // calculate a destination to avoid fences
 // returns DIJKSTRA_STATE_SUCCESS and populates origin_new, destination_new and next_destination_new if avoidance is required
 // next_destination_new will be non-zero if there is a next destination
@@ -139,6 +173,13 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         // reset logging count to restart logging updated graph
         _log_num_points = 0;
         _log_visgraph_version++;
+
+        // graphs and paths which depend on the fence visgraph must be recalculated
+        _destination_visgraph_ok = false;
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+        _all_pairs_ok = !_use_astar && update_all_pairs();
+#endif
+        _fence_adj_ok = _use_astar && update_fence_adjacency();
     }
 
     // Log one visgraph point per loop
@@ -611,40 +652,60 @@ bool AP_OADijkstra::get_point(uint16_t index, Vector2f &point) const
 // returns true if line segment intersects polygon or circular fence
 bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const
 {
-    // return immediately if fence is not enabled
+    for (uint16_t i = 0; i < num_zones(); i++) {
+        if (intersects_zone(i, seg_start, seg_end)) {
+            return true;
+        }
+    }
+
+    // if we got this far then no intersection
+    return false;
+}
+
+// returns total number of zones across all fence types
+uint16_t AP_OADijkstra::num_zones() const
+{
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return 0;
+    }
+    return fence->polyfence().get_inclusion_polygon_count() +
+           fence->polyfence().get_exclusion_polygon_count() +
+           fence->polyfence().get_inclusion_circle_count() +
+           fence->polyfence().get_exclusion_circle_count();
+}
+
+// returns true if line segment intersects the given zone
+bool AP_OADijkstra::intersects_zone(uint16_t zone, const Vector2f &seg_start, const Vector2f &seg_end) const
+{
     const AC_Fence *fence = AC_Fence::get_singleton();
     if (fence == nullptr) {
         return false;
     }
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
 
-    // determine if segment crosses any of the inclusion polygons
+    // determine if segment crosses an inclusion polygon
     uint16_t num_points = 0;
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
-        if (boundary != nullptr) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
+    if (zone < polyfence.get_inclusion_polygon_count()) {
+        const Vector2f* boundary = polyfence.get_inclusion_polygon(zone, num_points);
+        Vector2f intersection;
+        return (boundary != nullptr) && Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection);
     }
+    zone -= polyfence.get_inclusion_polygon_count();
 
-    // determine if segment crosses any of the exclusion polygons
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
-        if (boundary != nullptr) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
+    // determine if segment crosses an exclusion polygon
+    if (zone < polyfence.get_exclusion_polygon_count()) {
+        const Vector2f* boundary = polyfence.get_exclusion_polygon(zone, num_points);
+        Vector2f intersection;
+        return (boundary != nullptr) && Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection);
     }
+    zone -= polyfence.get_exclusion_polygon_count();
 
-    // determine if segment crosses any of the inclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_circle_count(); i++) {
+    // determine if segment crosses an inclusion circle
+    if (zone < polyfence.get_inclusion_circle_count()) {
         Vector2f center_pos_cm;
         float radius;
-        if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
+        if (polyfence.get_inclusion_circle(zone, center_pos_cm, radius)) {
             // intersects circle if either start or end is further from the center than the radius
             const float radius_cm_sq = sq(radius * 100.0f) ;
             if ((seg_start - center_pos_cm).length_squared() > radius_cm_sq) {
@@ -654,13 +715,15 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
                 return true;
             }
         }
+        return false;
     }
+    zone -= polyfence.get_inclusion_circle_count();
 
-    // determine if segment crosses any of the exclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_circle_count(); i++) {
+    // determine if segment crosses an exclusion circle
+    if (zone < polyfence.get_exclusion_circle_count()) {
         Vector2f center_pos_cm;
         float radius;
-        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
+        if (polyfence.get_exclusion_circle(zone, center_pos_cm, radius)) {
             // calculate distance between circle's center and segment
             const float dist_cm = Vector2f::closest_distance_between_line_and_point(seg_start, seg_end, center_pos_cm);
 
@@ -670,14 +733,66 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
             }
         }
     }
-
-    // if we got this far then no intersection
     return false;
 }
 
+// returns a hash of the zone's type and shape, used to detect which zones have changed
+uint32_t AP_OADijkstra::zone_hash(uint16_t zone) const
+{
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return 0;
+    }
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+
+    // FNV-1a over the zone's type and its points or center and radius
+    uint32_t hash = 2166136261U;
+    const auto add = [&hash](const void *data, uint16_t len) {
+        const uint8_t *b = (const uint8_t *)data;
+        for (uint16_t i = 0; i < len; i++) {
+            hash = (hash ^ b[i]) * 16777619U;
+        }
+    };
+
+    // the zone's type followed by its points or its center and radius
+    uint16_t num_points = 0;
+    const Vector2f *boundary = nullptr;
+    Vector2f center_pos_cm;
+    float radius = 0;
+    uint8_t type = 0;
+    if (zone < polyfence.get_inclusion_polygon_count()) {
+        boundary = polyfence.get_inclusion_polygon(zone, num_points);
+    } else if (zone < polyfence.get_inclusion_polygon_count() + polyfence.get_exclusion_polygon_count()) {
+        type = 1;
+        boundary = polyfence.get_exclusion_polygon(zone - polyfence.get_inclusion_polygon_count(), num_points);
+    } else {
+        zone -= polyfence.get_inclusion_polygon_count() + polyfence.get_exclusion_polygon_count();
+        if (zone < polyfence.get_inclusion_circle_count()) {
+            type = 2;
+            UNUSED_RESULT(polyfence.get_inclusion_circle(zone, center_pos_cm, radius));
+        } else {
+            type = 3;
+            UNUSED_RESULT(polyfence.get_exclusion_circle(zone - polyfence.get_inclusion_circle_count(), center_pos_cm, radius));
+        }
+    }
+
+    add(&type, sizeof(type));
+    if (boundary != nullptr) {
+        add(boundary, num_points * sizeof(Vector2f));
+    } else {
+        add(&center_pos_cm, sizeof(center_pos_cm));
+        add(&radius, sizeof(radius));
+    }
+    return hash;
+}
+
 // create visibility graph for all fence (with margin) points
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
+//
+// the zone blocking each edge is recorded so that when the fence is reloaded, an edge between two points which have
+// not moved only needs to be checked against zones which have changed if it was clear, and not at all if it was blocked
+// by a zone which has not changed
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
 {
     // exit immediately if fence is not enabled
@@ -688,36 +803,263 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
     }
 
     // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    const uint16_t numpoints = total_numpoints();
+    if (numpoints >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
 
+    const uint16_t nzones = num_zones();
+    const uint32_t num_edges = numpoints * (numpoints - 1) / 2;
+    uint32_t *zone_hashes = new uint32_t[MAX(nzones, 1)];
+    uint16_t *changed_zones = new uint16_t[MAX(nzones, 1)];
+    uint8_t *prev_zone_map = new uint8_t[MAX(_edge_num_zones, 1)];
+    uint16_t *prev_point = new uint16_t[MAX(numpoints, 1)];
+    Vector2f *points = new Vector2f[MAX(numpoints, 1)];
+    uint8_t *blocker = new uint8_t[MAX(num_edges, 1U)];
+    const auto free_temporaries = [&]() {
+        delete[] changed_zones;
+        delete[] prev_zone_map;
+        delete[] prev_point;
+    };
+    if (zone_hashes == nullptr || changed_zones == nullptr || prev_zone_map == nullptr ||
+        prev_point == nullptr || points == nullptr || blocker == nullptr) {
+        free_temporaries();
+        delete[] zone_hashes;
+        delete[] points;
+        delete[] blocker;
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // match zones to their previous number by hash, zones without a match have changed
+    uint16_t num_changed_zones = 0;
+    for (uint16_t i = 0; i < _edge_num_zones; i++) {
+        prev_zone_map[i] = OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN;
+    }
+    for (uint16_t z = 0; z < nzones; z++) {
+        zone_hashes[z] = zone_hash(z);
+        bool found = false;
+        for (uint16_t pz = 0; pz < _edge_num_zones; pz++) {
+            if (_edge_zone_hash[pz] == zone_hashes[z] && prev_zone_map[pz] == OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN) {
+                prev_zone_map[pz] = MIN(z, OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            changed_zones[num_changed_zones++] = z;
+        }
+    }
+
+    // match points to their previous index by position
+    for (uint16_t i = 0; i < numpoints; i++) {
+        UNUSED_RESULT(get_point(i, points[i]));
+        prev_point[i] = OA_DIJKSTRA_POINT_NONE;
+        for (uint16_t pi = 0; pi < _edge_numpoints; pi++) {
+            if (points[i] == _edge_points[pi]) {
+                prev_point[i] = pi;
+                break;
+            }
+        }
+    }
+
     // clear fence points visibility graph
     _fence_visgraph.clear();
 
     // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
+    for (uint16_t i = 0; i < numpoints; i++) {
+        for (uint16_t j = i + 1; j < numpoints; j++) {
+            const Vector2f &start_seg = points[i];
+            const Vector2f &end_seg = points[j];
+            uint8_t state = OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN;
+            bool state_known = false;
+
+            // reuse the previous state of edges between points which have not moved
+            const uint16_t pi = prev_point[i];
+            const uint16_t pj = prev_point[j];
+            if ((pi != OA_DIJKSTRA_POINT_NONE) && (pj != OA_DIJKSTRA_POINT_NONE) && (pi != pj)) {
+                const uint8_t prev_state = _edge_blocker[edge_index(MIN(pi, pj), MAX(pi, pj), _edge_numpoints)];
+                if (prev_state == OA_DIJKSTRA_EDGE_VISIBLE) {
+                    // only changed zones could block it now
+                    state = OA_DIJKSTRA_EDGE_VISIBLE;
+                    for (uint16_t c = 0; c < num_changed_zones; c++) {
+                        if (intersects_zone(changed_zones[c], start_seg, end_seg)) {
+                            state = MIN(changed_zones[c], OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN);
+                            break;
                         }
                     }
+                    state_known = true;
+                } else if ((prev_state < OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN) && (prev_zone_map[prev_state] < OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN)) {
+                    // still blocked by the same zone
+                    state = prev_zone_map[prev_state];
+                    state_known = true;
+                }
+            }
+
+            // otherwise check against every zone
+            if (!state_known) {
+                state = OA_DIJKSTRA_EDGE_VISIBLE;
+                for (uint16_t z = 0; z < nzones; z++) {
+                    if (intersects_zone(z, start_seg, end_seg)) {
+                        state = MIN(z, OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN);
+                        break;
+                    }
+                }
+            }
+            blocker[edge_index(i, j, numpoints)] = state;
+
+            // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
+            if (state == OA_DIJKSTRA_EDGE_VISIBLE) {
+                if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i},
+                                              {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)j},
+                                              (start_seg - end_seg).length())) {
+                    // failure to add a point can only be caused by out-of-memory
+                    free_temporaries();
+                    delete[] zone_hashes;
+                    delete[] points;
+                    delete[] blocker;
+                    err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+                    return false;
                 }
             }
         }
     }
 
+    // keep state for next update
+    free_temporaries();
+    delete[] _edge_zone_hash;
+    delete[] _edge_points;
+    delete[] _edge_blocker;
+    _edge_zone_hash = zone_hashes;
+    _edge_num_zones = nzones;
+    _edge_points = points;
+    _edge_blocker = blocker;
+    _edge_numpoints = numpoints;
+
+    return true;
+}
+
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+// calculate the shortest paths between all pairs of fence points from the edge states
+// returns false if there are too many points, too little free memory or on failure to allocate memory
+bool AP_OADijkstra::update_all_pairs()
+{
+    const uint16_t n = _edge_numpoints;
+    if ((n == 0) || (n > AP_OADIJKSTRA_ALL_PAIRS_MAX_POINTS)) {
+        free_all_pairs();
+        return false;
+    }
+    if (_all_pairs_numpoints != n) {
+        free_all_pairs();
+        // fall back to searching the fence visgraph rather than leave too little memory for everything else
+        const uint32_t mem_required = uint32_t(n) * n * (sizeof(float) + sizeof(uint8_t));
+        if (hal.util->available_memory() < mem_required + AP_OADIJKSTRA_ALL_PAIRS_MEM_RESERVE) {
+            return false;
+        }
+        _all_pairs_dist_cm = new float[n * n];
+        _all_pairs_next = new uint8_t[n * n];
+        if (_all_pairs_dist_cm == nullptr || _all_pairs_next == nullptr) {
+            free_all_pairs();
+            return false;
+        }
+        _all_pairs_numpoints = n;
+    }
+
+    // direct distances between visible points
+    for (uint16_t i = 0; i < n; i++) {
+        _all_pairs_dist_cm[i * n + i] = 0;
+        _all_pairs_next[i * n + i] = i;
+        for (uint16_t j = i + 1; j < n; j++) {
+            float dist = FLT_MAX;
+            if (_edge_blocker[edge_index(i, j, n)] == OA_DIJKSTRA_EDGE_VISIBLE) {
+                dist = (_edge_points[i] - _edge_points[j]).length();
+            }
+            _all_pairs_dist_cm[i * n + j] = _all_pairs_dist_cm[j * n + i] = dist;
+            _all_pairs_next[i * n + j] = j;
+            _all_pairs_next[j * n + i] = i;
+        }
+    }
+
+    // Floyd-Warshall
+    for (uint16_t k = 0; k < n; k++) {
+        for (uint16_t i = 0; i < n; i++) {
+            const float dist_ik = _all_pairs_dist_cm[i * n + k];
+            if (dist_ik >= FLT_MAX) {
+                continue;
+            }
+            for (uint16_t j = 0; j < n; j++) {
+                const float dist_kj = _all_pairs_dist_cm[k * n + j];
+                if ((dist_kj < FLT_MAX) && (dist_ik + dist_kj < _all_pairs_dist_cm[i * n + j])) {
+                    _all_pairs_dist_cm[i * n + j] = dist_ik + dist_kj;
+                    _all_pairs_next[i * n + j] = _all_pairs_next[i * n + k];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// free the all-pairs shortest path arrays
+void AP_OADijkstra::free_all_pairs()
+{
+    delete[] _all_pairs_dist_cm;
+    delete[] _all_pairs_next;
+    _all_pairs_dist_cm = nullptr;
+    _all_pairs_next = nullptr;
+    _all_pairs_numpoints = 0;
+}
+#endif  // AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+
+// build the list of fence visgraph items touching each fence point
+// returns false on failure to allocate memory
+bool AP_OADijkstra::update_fence_adjacency()
+{
+    const uint16_t n = total_numpoints();
+    const uint16_t num_items = _fence_visgraph.num_items();
+    // each item appears in the lists of both its points
+    const uint32_t num_entries = 2U * num_items;
+    if (num_entries > UINT16_MAX) {
+        return false;
+    }
+    if ((_fence_adj_numpoints < n) || (_fence_adj_numitems < num_items)) {
+        delete[] _fence_adj_start;
+        delete[] _fence_adj_items;
+        _fence_adj_start = new uint16_t[n + 1];
+        _fence_adj_items = new uint16_t[MAX(num_entries, 1U)];
+        if (_fence_adj_start == nullptr || _fence_adj_items == nullptr) {
+            delete[] _fence_adj_start;
+            delete[] _fence_adj_items;
+            _fence_adj_start = nullptr;
+            _fence_adj_items = nullptr;
+            _fence_adj_numpoints = 0;
+            _fence_adj_numitems = 0;
+            return false;
+        }
+        _fence_adj_numpoints = n;
+        _fence_adj_numitems = num_items;
+    }
+
+    // count items per point, then sum the counts so each entry is the end of that point's list
+    memset(_fence_adj_start, 0, (n + 1) * sizeof(_fence_adj_start[0]));
+    for (uint16_t i = 0; i < num_items; i++) {
+        const AP_OAVisGraph::VisGraphItem &item = _fence_visgraph[i];
+        if ((item.id1.id_num >= n) || (item.id2.id_num >= n)) {
+            return false;
+        }
+        _fence_adj_start[item.id1.id_num]++;
+        _fence_adj_start[item.id2.id_num]++;
+    }
+    for (uint16_t i = 1; i <= n; i++) {
+        _fence_adj_start[i] += _fence_adj_start[i - 1];
+    }
+
+    // fill each point's list from the back, which leaves each entry at the start of its list
+    for (uint16_t i = num_items; i > 0; i--) {
+        const AP_OAVisGraph::VisGraphItem &item = _fence_visgraph[i - 1];
+        _fence_adj_items[--_fence_adj_start[item.id1.id_num]] = i - 1;
+        _fence_adj_items[--_fence_adj_start[item.id2.id_num]] = i - 1;
+    }
     return true;
 }
 
@@ -872,6 +1214,165 @@ bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
     return false;
 }
 
+// A* search through the nodes in _short_path_data, which must have been initialised with the source as the only node
+// with a distance.  the straight line distance to the destination never overestimates the remaining distance so the
+// first path found to the destination is the shortest
+// returns false on failure to allocate memory
+bool AP_OADijkstra::search_astar()
+{
+    if (!_astar_heap.expand_to_hold(_short_path_data_numpoints)) {
+        return false;
+    }
+    _astar_heap_size = 0;
+
+    // calculate heuristics and find nodes with a direct line to the destination
+    for (node_index i = 0; i < _short_path_data_numpoints; i++) {
+        ShortPathNode &node = _short_path_data[i];
+        Vector2f node_pos;
+        if (!convert_node_to_point(node.id, node_pos)) {
+            // shouldn't happen
+            node_pos = _path_destination;
+        }
+        node.heuristic_cm = (node_pos - _path_destination).length();
+        node.distance_to_dest_cm = FLT_MAX;
+        node.heap_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+    }
+    for (uint16_t i = 0; i < _destination_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(_destination_visgraph[i].id2, node_idx)) {
+            _short_path_data[node_idx].distance_to_dest_cm = _destination_visgraph[i].distance_cm;
+        }
+    }
+
+    // start from the source
+    astar_heap_push(0);
+    while (_astar_heap_size > 0) {
+        const node_index curr_node_idx = astar_heap_pop();
+        ShortPathNode &curr_node = _short_path_data[curr_node_idx];
+        curr_node.visited = true;
+
+        if (curr_node.id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
+            break;
+        }
+
+        if (curr_node.id.id_type == AP_OAVisGraph::OATYPE_SOURCE) {
+            // the source visgraph includes the destination if it is directly visible
+            for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
+                node_index node_idx;
+                if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
+                    astar_relax(curr_node_idx, node_idx, _source_visgraph[i].distance_cm);
+                }
+            }
+            continue;
+        }
+
+        const uint8_t point = curr_node.id.id_num;
+        if (point >= _fence_adj_numpoints) {
+            continue;
+        }
+        for (uint16_t k = _fence_adj_start[point]; k < _fence_adj_start[point + 1]; k++) {
+            const AP_OAVisGraph::VisGraphItem &item = _fence_visgraph[_fence_adj_items[k]];
+            const AP_OAVisGraph::OAItemID &other_id = (item.id1 == curr_node.id) ? item.id2 : item.id1;
+            node_index node_idx;
+            if (find_node_from_id(other_id, node_idx)) {
+                astar_relax(curr_node_idx, node_idx, item.distance_cm);
+            }
+        }
+        if (curr_node.distance_to_dest_cm < FLT_MAX) {
+            astar_relax(curr_node_idx, 1, curr_node.distance_to_dest_cm);
+        }
+    }
+    return true;
+}
+
+// update a node's distance if it is shorter to reach it from the given node
+void AP_OADijkstra::astar_relax(node_index from_idx, node_index to_idx, float distance_cm)
+{
+    ShortPathNode &node = _short_path_data[to_idx];
+    if (node.visited) {
+        return;
+    }
+    const float dist_via_from = _short_path_data[from_idx].distance_cm + distance_cm;
+    if (dist_via_from < node.distance_cm) {
+        node.distance_cm = dist_via_from;
+        node.distance_from_idx = from_idx;
+        if (node.heap_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+            astar_heap_push(to_idx);
+        } else {
+            astar_sift_up(node.heap_idx);
+        }
+    }
+}
+
+// returns true if node a should be searched before node b
+bool AP_OADijkstra::astar_less(node_index a, node_index b) const
+{
+    const ShortPathNode &node_a = _short_path_data[a];
+    const ShortPathNode &node_b = _short_path_data[b];
+    return (node_a.distance_cm + node_a.heuristic_cm) < (node_b.distance_cm + node_b.heuristic_cm);
+}
+
+// place a node in the heap and record its position
+void AP_OADijkstra::astar_heap_set(node_index heap_idx, node_index node_idx)
+{
+    _astar_heap[heap_idx] = node_idx;
+    _short_path_data[node_idx].heap_idx = heap_idx;
+}
+
+void AP_OADijkstra::astar_heap_push(node_index node_idx)
+{
+    const node_index heap_idx = _astar_heap_size++;
+    astar_heap_set(heap_idx, node_idx);
+    astar_sift_up(heap_idx);
+}
+
+// remove and return the node with the lowest distance plus heuristic
+AP_OADijkstra::node_index AP_OADijkstra::astar_heap_pop()
+{
+    const node_index top = _astar_heap[0];
+    const node_index last = _astar_heap[--_astar_heap_size];
+    _short_path_data[top].heap_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+    if (_astar_heap_size > 0) {
+        astar_heap_set(0, last);
+        astar_sift_down(0);
+    }
+    return top;
+}
+
+void AP_OADijkstra::astar_sift_up(node_index heap_idx)
+{
+    const node_index node_idx = _astar_heap[heap_idx];
+    while (heap_idx > 0) {
+        const node_index parent = (heap_idx - 1) / 2;
+        if (!astar_less(node_idx, _astar_heap[parent])) {
+            break;
+        }
+        astar_heap_set(heap_idx, _astar_heap[parent]);
+        heap_idx = parent;
+    }
+    astar_heap_set(heap_idx, node_idx);
+}
+
+void AP_OADijkstra::astar_sift_down(node_index heap_idx)
+{
+    const node_index node_idx = _astar_heap[heap_idx];
+    while (true) {
+        uint16_t child = 2 * heap_idx + 1;
+        if (child >= _astar_heap_size) {
+            break;
+        }
+        if ((child + 1 < _astar_heap_size) && astar_less(_astar_heap[child + 1], _astar_heap[child])) {
+            child++;
+        }
+        if (!astar_less(_astar_heap[child], node_idx)) {
+            break;
+        }
+        astar_heap_set(heap_idx, _astar_heap[child]);
+        heap_idx = child;
+    }
+    astar_heap_set(heap_idx, node_idx);
+}
+
 // calculate shortest path from origin to destination
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run: create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin, create_polygon_fence_visgraph
@@ -889,11 +1390,31 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
-    if (!update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, _path_destination)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-        return false;
+    if (!_destination_visgraph_ok || (_destination_visgraph_pos != _path_destination)) {
+        if (!update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, _path_destination)) {
+            _destination_visgraph_ok = false;
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+            return false;
+        }
+        _destination_visgraph_pos = _path_destination;
+        _destination_visgraph_ok = true;
     }
 
+    return search_shortest_path(err_id);
+}
+
+// calculate shortest path from _path_source to _path_destination using the source, fence and destination visgraphs
+// returns true on success.  returns false on failure and err_id is updated
+// resulting path is stored in _path array in reverse order (i.e. destination is first element)
+bool AP_OADijkstra::search_shortest_path(AP_OADijkstra_Error &err_id)
+{
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+    // use the cached shortest paths between fence points if available
+    if (_all_pairs_ok) {
+        return calc_shortest_path_all_pairs(err_id);
+    }
+#endif
+
     // expand _short_path_data if necessary
     if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
@@ -910,36 +1431,43 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
     }
 
-    // start algorithm from source point
-    node_index current_node_idx = 0;
-
-    // update nodes visible from source point
-    for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
-        node_index node_idx;
-        if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
-            _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
-            _short_path_data[node_idx].distance_from_idx = current_node_idx;
-        } else {
-            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+    if (_use_astar && _fence_adj_ok) {
+        if (!search_astar()) {
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
             return false;
         }
-    }
-    // mark source node as visited
-    _short_path_data[current_node_idx].visited = true;
-
-    // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
-        node_index dest_node;
-        // See if this next "closest" node is actually the destination
-        if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, dest_node) && current_node_idx == dest_node) {
-            // We have discovered destination.. Don't bother with the rest of the graph
-            break;
+    } else {
+        // start algorithm from source point
+        node_index current_node_idx = 0;
+
+        // update nodes visible from source point
+        for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
+            node_index node_idx;
+            if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
+                _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
+                _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            } else {
+                err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+                return false;
+            }
         }
-        // update distances to all neighbours of current node
-        update_visible_node_distances(current_node_idx);
-
-        // mark current node as visited
+        // mark source node as visited
         _short_path_data[current_node_idx].visited = true;
+
+        // move current_node_idx to node with lowest distance
+        while (find_closest_node_idx(current_node_idx)) {
+            node_index dest_node;
+            // See if this next "closest" node is actually the destination
+            if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, dest_node) && current_node_idx == dest_node) {
+                // We have discovered destination.. Don't bother with the rest of the graph
+                break;
+            }
+            // update distances to all neighbours of current node
+            update_visible_node_distances(current_node_idx);
+
+            // mark current node as visited
+            _short_path_data[current_node_idx].visited = true;
+        }
     }
 
     // extract path starting from destination
@@ -982,6 +1510,81 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
     return success;
 }
 
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+// calculate shortest path from the source to the destination visibility graphs through the cached
+// shortest paths between fence points.  returns true on success.  returns false on failure and err_id is updated
+// resulting path is stored in _path array in the same way as calc_shortest_path
+bool AP_OADijkstra::calc_shortest_path_all_pairs(AP_OADijkstra_Error &err_id)
+{
+    const uint16_t n = _all_pairs_numpoints;
+    float best_dist = FLT_MAX;
+    uint16_t best_i = OA_DIJKSTRA_POINT_NONE;
+    uint16_t best_j = OA_DIJKSTRA_POINT_NONE;
+
+    // the path either goes directly from source to destination or enters the fence points at i and leaves at j
+    for (uint16_t s = 0; s < _source_visgraph.num_items(); s++) {
+        const AP_OAVisGraph::VisGraphItem &src_item = _source_visgraph[s];
+        if (src_item.id2.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
+            if (src_item.distance_cm < best_dist) {
+                best_dist = src_item.distance_cm;
+                best_i = best_j = OA_DIJKSTRA_POINT_NONE;
+            }
+            continue;
+        }
+        const uint16_t i = src_item.id2.id_num;
+        if (i >= n) {
+            continue;
+        }
+        for (uint16_t d = 0; d < _destination_visgraph.num_items(); d++) {
+            const AP_OAVisGraph::VisGraphItem &dest_item = _destination_visgraph[d];
+            const uint16_t j = dest_item.id2.id_num;
+            if ((j >= n) || (_all_pairs_dist_cm[i * n + j] >= FLT_MAX)) {
+                continue;
+            }
+            const float dist = src_item.distance_cm + _all_pairs_dist_cm[i * n + j] + dest_item.distance_cm;
+            if (dist < best_dist) {
+                best_dist = dist;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+
+    if (best_dist >= FLT_MAX) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+        return false;
+    }
+
+    // count points on path
+    uint16_t numpoints = 2;
+    if (best_i != OA_DIJKSTRA_POINT_NONE) {
+        numpoints++;
+        for (uint16_t k = best_i; k != best_j; k = _all_pairs_next[k * n + best_j]) {
+            numpoints++;
+        }
+    }
+    if (!_path.expand_to_hold(numpoints)) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // store path in reverse order, destination first
+    _path_numpoints = numpoints;
+    _path[0] = {AP_OAVisGraph::OATYPE_DESTINATION, 0};
+    _path[numpoints - 1] = {AP_OAVisGraph::OATYPE_SOURCE, 0};
+    if (best_i != OA_DIJKSTRA_POINT_NONE) {
+        uint16_t idx = numpoints - 2;
+        for (uint16_t k = best_i; ; k = _all_pairs_next[k * n + best_j]) {
+            _path[idx--] = {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)k};
+            if (k == best_j) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+#endif  // AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+
 // return point from final path as an offset (in cm) from the ekf origin
 bool AP_OADijkstra::get_shortest_path_point(uint8_t point_num, Vector2f& pos) const
 {
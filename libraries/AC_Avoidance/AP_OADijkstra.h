@@ -15,6 +15,8 @@
  */
 
 class AP_OADijkstra {
+    friend class AP_OADijkstra_Benchmark;
+
 public:
 
     AP_OADijkstra(AP_Int16 &options);
@@ -27,6 +29,9 @@ public:
     // trigger Dijkstra's to recalculate shortest path based on current location 
     void recalculate_path() { _shortest_path_ok = false; }
 
+    // use A* search with a heap of open nodes instead of scanning all nodes for the closest
+    void set_use_astar(bool use_astar);
+
     // update return status enum
     enum AP_OADijkstra_State : uint8_t {
         DIJKSTRA_STATE_NOT_REQUIRED = 0,
@@ -119,16 +124,70 @@ private:
     // returns true if line segment intersects polygon or circular fence
     bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
 
+    //
+    // fence zone methods.  zones are the individual polygons and circles of the fence, numbered in the order
+    // inclusion polygons, exclusion polygons, inclusion circles, exclusion circles
+    //
+
+    // returns total number of zones across all fence types
+    uint16_t num_zones() const;
+
+    // returns true if line segment intersects the given zone
+    bool intersects_zone(uint16_t zone, const Vector2f &seg_start, const Vector2f &seg_end) const;
+
+    // returns a hash of the zone's type and shape, used to detect which zones have changed
+    uint32_t zone_hash(uint16_t zone) const;
+
     // create visibility graph for all fence (with margin) points
+    // only edges which touch a moved point or which were blocked by a zone that has changed are re-evaluated
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
 
+    // index of the edge between fence points i and j (i < j) in an array of edges between numpoints points
+    static uint32_t edge_index(uint16_t i, uint16_t j, uint16_t numpoints) {
+        return uint32_t(i) * (2 * numpoints - i - 1) / 2 + (j - i - 1);
+    }
+
+    // state of each edge between fence points when the visibility graph was last created, for incremental updates
+    uint8_t *_edge_blocker;             // zone blocking each edge, OA_DIJKSTRA_EDGE_VISIBLE or OA_DIJKSTRA_EDGE_BLOCKED_UNKNOWN
+    Vector2f *_edge_points;             // fence points the edges are between
+    uint16_t _edge_numpoints;           // number of points in above array
+    uint32_t *_edge_zone_hash;          // hash of each zone
+    uint16_t _edge_num_zones;           // number of zones in above array
+
+#if AP_OADIJKSTRA_ALL_PAIRS_ENABLED
+    // shortest distances between all pairs of fence points, so that paths on an unchanged fence only require
+    // the source and destination visibility graphs.  only used up to AP_OADIJKSTRA_ALL_PAIRS_MAX_POINTS points
+    // and if there is enough free memory.  arrays are sized for the current fence and freed when not used
+    bool update_all_pairs();
+    void free_all_pairs();
+    bool calc_shortest_path_all_pairs(AP_OADijkstra_Error &err_id);
+    float *_all_pairs_dist_cm;          // distance from point i to point j along the shortest path, at [i * numpoints + j]
+    uint8_t *_all_pairs_next;           // next point after i on the shortest path from i to j, at [i * numpoints + j]
+    uint16_t _all_pairs_numpoints;      // number of points the above arrays are allocated for
+#endif
+    bool _all_pairs_ok;                 // true if the above arrays are valid for the current fence visibility graph
+
+    // list of the fence visibility graph items touching each fence point, so that A* can find a point's neighbours
+    // without searching the whole graph
+    bool update_fence_adjacency();
+    uint16_t *_fence_adj_start;         // index into _fence_adj_items of each point's first item, with an extra entry for the end
+    uint16_t *_fence_adj_items;         // indices into _fence_visgraph, grouped by point
+    uint16_t _fence_adj_numpoints;      // number of points the above arrays are allocated for
+    uint16_t _fence_adj_numitems;       // number of items the above arrays are allocated for
+    bool _fence_adj_ok;                 // true if the above arrays are valid for the current fence visibility graph
+    bool _use_astar;                    // true if A* search should be used
+
     // calculate shortest path from origin to destination
     // returns true on success.  returns false on failure and err_id is updated
     // requires create_polygon_fence_with_margin and create_polygon_fence_visgraph to have been run
     // resulting path is stored in _shortest_path array as vector offsets from EKF origin
     bool calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
 
+    // calculate shortest path from _path_source to _path_destination using the source, fence and destination visgraphs
+    // returns true on success.  returns false on failure and err_id is updated
+    bool search_shortest_path(AP_OADijkstra_Error &err_id);
+
     // shortest path state variables
     bool _inclusion_polygon_with_margin_ok;
     bool _exclusion_polygon_with_margin_ok;
@@ -161,6 +220,8 @@ private:
     AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
+    Vector2f _destination_visgraph_pos;     // destination the above graph was created for
+    bool _destination_visgraph_ok;          // true if the above graph is valid for the current fence
 
     // updates visibility graph for a given position which is an offset (in cm) from the ekf origin
     // to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
@@ -174,10 +235,29 @@ private:
         bool visited;                   // true if all this node's neighbour's distances have been updated
         node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
         float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float heuristic_cm;             // straight line distance to destination (A* only)
+        float distance_to_dest_cm;      // distance to destination if directly visible, FLT_MAX if not (A* only)
+        node_index heap_idx;            // index into _astar_heap or 255 if not in the heap (A* only)
     };
     AP_ExpandingArray<ShortPathNode> _short_path_data;
     node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
 
+    // A* search through the nodes in _short_path_data, which must have been initialised with the source as the only node
+    // with a distance.  the open nodes are held in a binary heap ordered by distance plus heuristic
+    // returns false on failure to allocate memory
+    bool search_astar();
+    AP_ExpandingArray<node_index> _astar_heap;  // indices into _short_path_data of open nodes
+    node_index _astar_heap_size;                // number of nodes in above heap
+
+    // A* helper functions
+    void astar_relax(node_index from_idx, node_index to_idx, float distance_cm);
+    bool astar_less(node_index a, node_index b) const;
+    void astar_heap_set(node_index heap_idx, node_index node_idx);
+    void astar_heap_push(node_index node_idx);
+    node_index astar_heap_pop();
+    void astar_sift_up(node_index heap_idx);
+    void astar_sift_down(node_index heap_idx);
+
     // update total distance for all nodes visible from current node
     // curr_node_idx is an index into the _short_path_data array
     void update_visible_node_distances(node_index curr_node_idx);
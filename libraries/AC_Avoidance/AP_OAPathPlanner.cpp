@@ -39,7 +39,7 @@ const AP_Param::GroupInfo AP_OAPathPlanner::var_info[] = {
     // @Param: TYPE
     // @DisplayName: Object Avoidance Path Planning algorithm to use
     // @Description: Enabled/disable path planning around obstacles
-    // @Values: 0:Disabled,1:BendyRuler,2:Dijkstra,3:Dijkstra with BendyRuler
+    // @Values: 0:Disabled,1:BendyRuler,2:Dijkstra,3:Dijkstra with BendyRuler,4:Dijkstra using A*,5:Dijkstra using A* with BendyRuler
     // @User: Standard
     AP_GROUPINFO_FLAGS("TYPE", 1,  AP_OAPathPlanner, _type, OA_PATHPLAN_DISABLED, AP_PARAM_FLAG_ENABLE),
 
@@ -97,6 +97,7 @@ void AP_OAPathPlanner::init()
         }
         break;
     case OA_PATHPLAN_DIJKSTRA:
+    case OA_PATHPLAN_DIJKSTRA_ASTAR:
 #if AP_FENCE_ENABLED
         if (_oadijkstra == nullptr) {
             _oadijkstra = new AP_OADijkstra(_options);
@@ -104,6 +105,7 @@ void AP_OAPathPlanner::init()
 #endif
         break;
     case OA_PATHPLAN_DJIKSTRA_BENDYRULER:
+    case OA_PATHPLAN_DIJKSTRA_ASTAR_BENDYRULER:
 #if AP_FENCE_ENABLED
         if (_oadijkstra == nullptr) {
             _oadijkstra = new AP_OADijkstra(_options);
@@ -135,12 +137,14 @@ bool AP_OAPathPlanner::pre_arm_check(char *failure_msg, uint8_t failure_msg_len)
         }
         break;
     case OA_PATHPLAN_DIJKSTRA:
+    case OA_PATHPLAN_DIJKSTRA_ASTAR:
         if (_oadijkstra == nullptr) {
             hal.util->snprintf(failure_msg, failure_msg_len, "Dijkstra OA requires reboot");
             return false;
         }
         break;
     case OA_PATHPLAN_DJIKSTRA_BENDYRULER:
+    case OA_PATHPLAN_DIJKSTRA_ASTAR_BENDYRULER:
         if(_oadijkstra == nullptr || _oabendyruler == nullptr) {
             hal.util->snprintf(failure_msg, failure_msg_len, "OA requires reboot");
             return false;
@@ -325,11 +329,13 @@ void AP_OAPathPlanner::avoidance_thread()
             break;
         }
 
-        case OA_PATHPLAN_DIJKSTRA: {
+        case OA_PATHPLAN_DIJKSTRA:
+        case OA_PATHPLAN_DIJKSTRA_ASTAR: {
 #if AP_FENCE_ENABLED
             if (_oadijkstra == nullptr) {
                 continue;
             }
+            _oadijkstra->set_use_astar(_type == OA_PATHPLAN_DIJKSTRA_ASTAR);
             _oadijkstra->set_fence_margin(_margin_max);
             const AP_OADijkstra::AP_OADijkstra_State dijkstra_state = _oadijkstra->update(avoidance_request2.current_loc,
                                                                                           avoidance_request2.destination,
@@ -354,7 +360,8 @@ void AP_OAPathPlanner::avoidance_thread()
             break;
         }
 
-        case OA_PATHPLAN_DJIKSTRA_BENDYRULER: {
+        case OA_PATHPLAN_DJIKSTRA_BENDYRULER:
+        case OA_PATHPLAN_DIJKSTRA_ASTAR_BENDYRULER: {
             if ((_oabendyruler == nullptr) || _oadijkstra == nullptr) {
                 continue;
             } 
@@ -377,6 +384,7 @@ void AP_OAPathPlanner::avoidance_thread()
                 proximity_only = true;
             }
 #if AP_FENCE_ENABLED
+            _oadijkstra->set_use_astar(_type == OA_PATHPLAN_DIJKSTRA_ASTAR_BENDYRULER);
             _oadijkstra->set_fence_margin(_margin_max);
             const AP_OADijkstra::AP_OADijkstra_State dijkstra_state = _oadijkstra->update(avoidance_request2.current_loc,
                                                                                           avoidance_request2.destination,
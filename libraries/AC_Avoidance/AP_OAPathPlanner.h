@@ -71,6 +71,8 @@ public:
         OA_PATHPLAN_BENDYRULER = 1,
         OA_PATHPLAN_DIJKSTRA = 2,
         OA_PATHPLAN_DJIKSTRA_BENDYRULER = 3,
+        OA_PATHPLAN_DIJKSTRA_ASTAR = 4,
+        OA_PATHPLAN_DIJKSTRA_ASTAR_BENDYRULER = 5,
     };
 
     // enumeration for _OPTION parameter
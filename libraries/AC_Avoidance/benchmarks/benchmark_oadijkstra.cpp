@@ -0,0 +1,182 @@
+/*
+ * Compare Dijkstra's linear search for the closest node with A* search on
+ * fences of different sizes.
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AP_OADijkstra.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_OAPATHPLANNER_DIJKSTRA_ENABLED && AP_FENCE_ENABLED
+
+// spacing of the grid the exclusion squares are laid out on and their half width
+#define BENCHMARK_GRID_CM       1000.0f
+#define BENCHMARK_SQUARE_CM     250.0f
+
+class AP_OADijkstra_Benchmark {
+public:
+    // lay out numpoints/4 square exclusion zones on a grid, with the source
+    // and destination at opposite corners, and build the visibility graphs
+    static void setup(AP_OADijkstra &dijkstra, uint16_t numpoints);
+
+    // search for the shortest path, returning its length or -1 on failure
+    static float search(AP_OADijkstra &dijkstra, bool use_astar);
+
+private:
+    static bool visible(const AP_OADijkstra &dijkstra, const Vector2f &start, uint16_t start_idx, const Vector2f &end, uint16_t end_idx);
+};
+
+// returns true if the segment crosses none of the squares. start_idx and
+// end_idx are the segment's fence point indices, or UINT16_MAX if it does not
+// end on a fence point
+bool AP_OADijkstra_Benchmark::visible(const AP_OADijkstra &dijkstra, const Vector2f &start, uint16_t start_idx, const Vector2f &end, uint16_t end_idx)
+{
+    // diagonals cross the inside of their own square
+    if ((start_idx != UINT16_MAX) && (end_idx != UINT16_MAX) &&
+        (start_idx / 4 == end_idx / 4) && ((start_idx % 4) == ((end_idx + 2) % 4))) {
+        return false;
+    }
+    const uint16_t numpoints = dijkstra._exclusion_polygon_numpoints;
+    for (uint16_t i = 0; i < numpoints; i++) {
+        const uint16_t j = (i % 4 == 3) ? i - 3 : i + 1;
+        // sides which share an end with the segment only touch it
+        if (i == start_idx || i == end_idx || j == start_idx || j == end_idx) {
+            continue;
+        }
+        Vector2f intersection;
+        if (Vector2f::segment_intersection(start, end, dijkstra._exclusion_polygon_pts[i], dijkstra._exclusion_polygon_pts[j], intersection)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AP_OADijkstra_Benchmark::setup(AP_OADijkstra &dijkstra, uint16_t numpoints)
+{
+    numpoints -= numpoints % 4;
+    const uint16_t num_squares = numpoints / 4;
+    uint16_t grid_size = 1;
+    while (grid_size * grid_size < num_squares) {
+        grid_size++;
+    }
+
+    // get_random16() has a fixed seed so runs are repeatable
+    const auto rand_offset = []() {
+        return (get_random16() / 65535.0f - 0.5f) * (BENCHMARK_GRID_CM - 2 * BENCHMARK_SQUARE_CM) * 0.5f;
+    };
+
+    UNUSED_RESULT(dijkstra._exclusion_polygon_pts.expand_to_hold(numpoints));
+    for (uint16_t s = 0; s < num_squares; s++) {
+        const Vector2f centre {((s % grid_size) + 1) * BENCHMARK_GRID_CM + rand_offset(),
+                               ((s / grid_size) + 1) * BENCHMARK_GRID_CM + rand_offset()};
+        dijkstra._exclusion_polygon_pts[s * 4] = centre + Vector2f{-BENCHMARK_SQUARE_CM, -BENCHMARK_SQUARE_CM};
+        dijkstra._exclusion_polygon_pts[s * 4 + 1] = centre + Vector2f{BENCHMARK_SQUARE_CM, -BENCHMARK_SQUARE_CM};
+        dijkstra._exclusion_polygon_pts[s * 4 + 2] = centre + Vector2f{BENCHMARK_SQUARE_CM, BENCHMARK_SQUARE_CM};
+        dijkstra._exclusion_polygon_pts[s * 4 + 3] = centre + Vector2f{-BENCHMARK_SQUARE_CM, BENCHMARK_SQUARE_CM};
+    }
+    dijkstra._inclusion_polygon_numpoints = 0;
+    dijkstra._exclusion_polygon_numpoints = numpoints;
+    dijkstra._exclusion_circle_numpoints = 0;
+
+    // fence visibility graph
+    dijkstra._fence_visgraph.clear();
+    for (uint16_t i = 0; i < numpoints; i++) {
+        for (uint16_t j = i + 1; j < numpoints; j++) {
+            const Vector2f &start = dijkstra._exclusion_polygon_pts[i];
+            const Vector2f &end = dijkstra._exclusion_polygon_pts[j];
+            if (visible(dijkstra, start, i, end, j)) {
+                UNUSED_RESULT(dijkstra._fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i},
+                                                                {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)j},
+                                                                (start - end).length()));
+            }
+        }
+    }
+
+    // source and destination visibility graphs
+    dijkstra._path_source = Vector2f{0, 0};
+    dijkstra._path_destination = Vector2f{grid_size + 1.0f, grid_size + 1.0f} * BENCHMARK_GRID_CM;
+    dijkstra._source_visgraph.clear();
+    dijkstra._destination_visgraph.clear();
+    for (uint16_t i = 0; i < numpoints; i++) {
+        const Vector2f &point = dijkstra._exclusion_polygon_pts[i];
+        if (visible(dijkstra, dijkstra._path_source, UINT16_MAX, point, i)) {
+            UNUSED_RESULT(dijkstra._source_visgraph.add_item({AP_OAVisGraph::OATYPE_SOURCE, 0},
+                                                             {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i},
+                                                             (dijkstra._path_source - point).length()));
+        }
+        if (visible(dijkstra, dijkstra._path_destination, UINT16_MAX, point, i)) {
+            UNUSED_RESULT(dijkstra._destination_visgraph.add_item({AP_OAVisGraph::OATYPE_DESTINATION, 0},
+                                                                  {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i},
+                                                                  (dijkstra._path_destination - point).length()));
+        }
+    }
+    if (visible(dijkstra, dijkstra._path_source, UINT16_MAX, dijkstra._path_destination, UINT16_MAX)) {
+        UNUSED_RESULT(dijkstra._source_visgraph.add_item({AP_OAVisGraph::OATYPE_SOURCE, 0},
+                                                         {AP_OAVisGraph::OATYPE_DESTINATION, 0},
+                                                         (dijkstra._path_source - dijkstra._path_destination).length()));
+    }
+
+    dijkstra._all_pairs_ok = false;
+    dijkstra._fence_adj_ok = dijkstra.update_fence_adjacency();
+}
+
+float AP_OADijkstra_Benchmark::search(AP_OADijkstra &dijkstra, bool use_astar)
+{
+    dijkstra._use_astar = use_astar;
+    AP_OADijkstra::AP_OADijkstra_Error err_id;
+    if (!dijkstra.search_shortest_path(err_id)) {
+        return -1;
+    }
+    float length = 0;
+    Vector2f prev, point;
+    UNUSED_RESULT(dijkstra.get_shortest_path_point(0, prev));
+    for (uint8_t i = 1; i < dijkstra.get_shortest_path_numpoints(); i++) {
+        UNUSED_RESULT(dijkstra.get_shortest_path_point(i, point));
+        length += (point - prev).length();
+        prev = point;
+    }
+    return length;
+}
+
+static AP_Int16 options;
+static AP_OADijkstra dijkstra {options};
+
+static void BM_OADijkstraSearch(benchmark::State& state, bool use_astar)
+{
+    AP_OADijkstra_Benchmark::setup(dijkstra, state.range(0));
+
+    // both searches must find a path of the same length
+    const float length = AP_OADijkstra_Benchmark::search(dijkstra, false);
+    if (length < 0 || fabsf(AP_OADijkstra_Benchmark::search(dijkstra, true) - length) > 1.0f) {
+        state.SkipWithError("searches disagree");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        float result = AP_OADijkstra_Benchmark::search(dijkstra, use_astar);
+        gbenchmark_escape(&result);
+    }
+}
+
+/* Fences of 48, 200 and 252 points; the visibility graph ids limit fences to
+ * fewer than 255 points */
+BENCHMARK_CAPTURE(BM_OADijkstraSearch, Dijkstra, false)->Arg(48)->Arg(200)->Arg(252);
+BENCHMARK_CAPTURE(BM_OADijkstraSearch, AStar, true)->Arg(48)->Arg(200)->Arg(252);
+
+#endif  // AP_OAPATHPLANNER_DIJKSTRA_ENABLED && AP_FENCE_ENABLED
+
+BENCHMARK_MAIN();
@@ -0,0 +1,236 @@
+#include "AC_GroundPlane.h"
+
+#define AC_GROUNDPLANE_ROUGHNESS_BAND_M     0.3f    // points within this vertical distance of the plane are used for the roughness, further points are taken to be objects
+
+// add a point on the ground (NED in meters from the EKF origin) measured at time_ms
+void AC_GroundPlane::add_point(const Vector3f &point_ned_m, uint32_t time_ms)
+{
+    _points[_points_head].pos_ned_m = point_ned_m;
+    _points[_points_head].time_ms = time_ms;
+    _points_head = (_points_head + 1) % AC_GROUNDPLANE_MAX_POINTS;
+}
+
+// fit a plane to the recent points below the vehicle plus num_extra points (NED in meters
+// from the EKF origin), for example returns from a scanning lidar's point cloud
+void AC_GroundPlane::update(const Vector3f &vehicle_pos_ned_m, uint32_t now_ms, const Vector3f *extra_points, uint16_t num_extra)
+{
+    _num_candidates = 0;
+    for (const Point &point : _points) {
+        if ((point.time_ms != 0) && (now_ms - point.time_ms < AC_GROUNDPLANE_POINT_TIMEOUT_MS)) {
+            add_candidate(point.pos_ned_m - vehicle_pos_ned_m);
+        }
+    }
+    for (uint16_t i = 0; (i < num_extra) && (extra_points != nullptr); i++) {
+        add_candidate(extra_points[i] - vehicle_pos_ned_m);
+    }
+
+    Estimate estimate {};
+    estimate.num_points = _num_candidates;
+    estimate.time_ms = now_ms;
+    _estimate_ok = fit_plane(estimate);
+    if (_estimate_ok) {
+        _estimate = estimate;
+    }
+}
+
+// get the most recent estimate, returns false if it is older than AC_GROUNDPLANE_POINT_TIMEOUT_MS
+bool AC_GroundPlane::get_estimate(Estimate &estimate, uint32_t now_ms) const
+{
+    if (!_estimate_ok || (now_ms - _estimate.time_ms > AC_GROUNDPLANE_POINT_TIMEOUT_MS)) {
+        return false;
+    }
+    estimate = _estimate;
+    return true;
+}
+
+// add a point relative to the vehicle to the points to be fitted if it is within a downward cone below the vehicle and within range
+// returns from walls and objects beside the vehicle are mostly outside the cone, so they can't make up a plane
+void AC_GroundPlane::add_candidate(const Vector3f &rel_pos_m)
+{
+    if ((_num_candidates >= AC_GROUNDPLANE_MAX_POINTS) || (rel_pos_m.z <= 0)) {
+        return;
+    }
+    const float dist_xy_sq = rel_pos_m.xy().length_squared();
+    if ((dist_xy_sq > sq(AC_GROUNDPLANE_RADIUS_M)) || (dist_xy_sq * sq(AC_GROUNDPLANE_CONE_RATIO) > sq(rel_pos_m.z))) {
+        return;
+    }
+    _candidates[_num_candidates++] = rel_pos_m;
+}
+
+// fit a plane z = a.x + b.y + c to the candidates, returns false if there are too few inliers
+// the vehicle is at the origin so c is its height above the plane
+bool AC_GroundPlane::fit_plane(Estimate &estimate)
+{
+    if (_num_candidates < AC_GROUNDPLANE_MIN_INLIERS) {
+        return false;
+    }
+
+    // a single beam while hovering sees one patch of ground, so the slope can not be observed
+    Vector2f mean;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        mean += _candidates[i].xy();
+    }
+    mean /= _num_candidates;
+    float sxx = 0, syy = 0, sxy = 0;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        const Vector2f d = _candidates[i].xy() - mean;
+        sxx += d.x * d.x;
+        syy += d.y * d.y;
+        sxy += d.x * d.y;
+    }
+    const float det = (sxx * syy - sq(sxy)) / sq(float(_num_candidates));
+    if (det < sq(sq(AC_GROUNDPLANE_SPREAD_MIN_M))) {
+        return fit_level(estimate);
+    }
+
+    // test a fixed number of hypotheses through three points and keep the one with the most support
+    const float min_normal_z = cosf(radians(AC_GROUNDPLANE_SLOPE_MAX_DEG));
+    float best_a = 0, best_b = 0, best_c = 0;
+    uint16_t best_inliers = 0;
+    for (uint8_t iter = 0; iter < AC_GROUNDPLANE_RANSAC_ITERATIONS; iter++) {
+        const Vector3f &p1 = _candidates[random_index(_num_candidates)];
+        const Vector3f &p2 = _candidates[random_index(_num_candidates)];
+        const Vector3f &p3 = _candidates[random_index(_num_candidates)];
+        const Vector3f normal = (p2 - p1) % (p3 - p1);
+        const float normal_length = normal.length();
+        // reject repeated or colinear points and walls
+        if ((normal_length < 1.0e-4f) || (fabsf(normal.z) < normal_length * min_normal_z)) {
+            continue;
+        }
+        const float a = -normal.x / normal.z;
+        const float b = -normal.y / normal.z;
+        const float c = p1.z - a * p1.x - b * p1.y;
+        uint16_t inliers = 0;
+        for (uint16_t i = 0; i < _num_candidates; i++) {
+            const Vector3f &p = _candidates[i];
+            if (fabsf(p.z - (a * p.x + b * p.y + c)) < AC_GROUNDPLANE_INLIER_M) {
+                inliers++;
+            }
+        }
+        if (inliers > best_inliers) {
+            best_inliers = inliers;
+            best_a = a;
+            best_b = b;
+            best_c = c;
+        }
+    }
+    if (best_inliers < AC_GROUNDPLANE_MIN_INLIERS) {
+        return false;
+    }
+
+    // least squares refine on the inliers of the best hypothesis using the normal equations
+    Matrix3f ata;
+    Vector3f atz;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        const Vector3f &p = _candidates[i];
+        if (fabsf(p.z - (best_a * p.x + best_b * p.y + best_c)) >= AC_GROUNDPLANE_INLIER_M) {
+            continue;
+        }
+        const Vector3f row {p.x, p.y, 1.0f};
+        ata.a += row * row.x;
+        ata.b += row * row.y;
+        ata.c += row;
+        atz += row * p.z;
+    }
+    Matrix3f ata_inv;
+    if (ata.inverse(ata_inv)) {
+        const Vector3f coeffs = ata_inv * atz;
+        if (!coeffs.is_nan() && !coeffs.is_inf()) {
+            best_a = coeffs.x;
+            best_b = coeffs.y;
+            best_c = coeffs.z;
+        }
+    }
+
+    // count inliers and measure roughness against the refined plane
+    float sum_sq = 0;
+    uint16_t num_rough = 0;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        const Vector3f &p = _candidates[i];
+        const float residual = fabsf(p.z - (best_a * p.x + best_b * p.y + best_c));
+        if (residual < AC_GROUNDPLANE_INLIER_M) {
+            estimate.num_inliers++;
+        }
+        if (residual < AC_GROUNDPLANE_ROUGHNESS_BAND_M) {
+            sum_sq += sq(residual);
+            num_rough++;
+        }
+    }
+    if (estimate.num_inliers < AC_GROUNDPLANE_MIN_INLIERS) {
+        return false;
+    }
+
+    // the refine can tilt the plane past the limit the hypotheses were tested against
+    const float slope_deg = degrees(atanf(norm(best_a, best_b)));
+    if (slope_deg > AC_GROUNDPLANE_SLOPE_MAX_DEG) {
+        return false;
+    }
+
+    estimate.height_m = best_c;
+    estimate.slope_deg = slope_deg;
+    estimate.roughness_m = sqrtf(sum_sq / num_rough);
+    estimate.slope_valid = true;
+    return true;
+}
+
+// fit a level plane z = c to the candidates, returns false if there are too few inliers
+bool AC_GroundPlane::fit_level(Estimate &estimate)
+{
+    // test a fixed number of heights through single points and keep the one with the most support
+    float best_c = 0;
+    uint16_t best_inliers = 0;
+    for (uint8_t iter = 0; iter < AC_GROUNDPLANE_RANSAC_ITERATIONS; iter++) {
+        const float c = _candidates[random_index(_num_candidates)].z;
+        uint16_t inliers = 0;
+        for (uint16_t i = 0; i < _num_candidates; i++) {
+            if (fabsf(_candidates[i].z - c) < AC_GROUNDPLANE_INLIER_M) {
+                inliers++;
+            }
+        }
+        if (inliers > best_inliers) {
+            best_inliers = inliers;
+            best_c = c;
+        }
+    }
+    if (best_inliers < AC_GROUNDPLANE_MIN_INLIERS) {
+        return false;
+    }
+
+    // refine to the mean height of the inliers
+    float sum = 0;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        if (fabsf(_candidates[i].z - best_c) < AC_GROUNDPLANE_INLIER_M) {
+            sum += _candidates[i].z;
+        }
+    }
+    best_c = sum / best_inliers;
+
+    // count inliers and measure roughness against the refined height
+    float sum_sq = 0;
+    uint16_t num_rough = 0;
+    for (uint16_t i = 0; i < _num_candidates; i++) {
+        const float residual = fabsf(_candidates[i].z - best_c);
+        if (residual < AC_GROUNDPLANE_INLIER_M) {
+            estimate.num_inliers++;
+        }
+        if (residual < AC_GROUNDPLANE_ROUGHNESS_BAND_M) {
+            sum_sq += sq(residual);
+            num_rough++;
+        }
+    }
+    if (estimate.num_inliers < AC_GROUNDPLANE_MIN_INLIERS) {
+        return false;
+    }
+
+    estimate.height_m = best_c;
+    estimate.slope_deg = 0;
+    estimate.roughness_m = sqrtf(sum_sq / num_rough);
+    estimate.slope_valid = false;
+    return true;
+}
+
+// returns a pseudo random index below num
+uint16_t AC_GroundPlane::random_index(uint16_t num)
+{
+    return get_random16() % num;
+}
@@ -0,0 +1,82 @@
+/// @file   AC_GroundPlane.h
+/// @brief  Plane fit to rangefinder and lidar returns below the vehicle
+
+/**
+    Returns are held as earth-frame (NED) points so that a single downward
+    rangefinder sweeping the ground as the airframe rocks builds up a
+    surface as well as a scanning lidar does.  Each update fits a plane to
+    the recent points below the vehicle using a fixed number of RANSAC
+    hypotheses followed by a least squares refine on the inliers, so the
+    cost per call is bounded by AC_GROUNDPLANE_MAX_POINTS and
+    AC_GROUNDPLANE_RANSAC_ITERATIONS regardless of how many returns arrive.
+    Like AC_LandDetector it holds no vehicle state.
+**/
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+#ifndef AC_GROUNDPLANE_MAX_POINTS
+#define AC_GROUNDPLANE_MAX_POINTS           64      // number of points held and the maximum number used for each fit
+#endif
+#define AC_GROUNDPLANE_RANSAC_ITERATIONS    16      // number of plane hypotheses tested per fit
+#define AC_GROUNDPLANE_POINT_TIMEOUT_MS     1000    // points older than this are not used
+#define AC_GROUNDPLANE_RADIUS_M             2.0f    // horizontal radius around the vehicle within which points are used
+#define AC_GROUNDPLANE_CONE_RATIO           1.0f    // points must be at least this far below the vehicle per meter horizontally, i.e. within 45 degrees of straight down
+#define AC_GROUNDPLANE_INLIER_M             0.05f   // points within this vertical distance of a hypothesis support it
+#define AC_GROUNDPLANE_SLOPE_MAX_DEG        60.0f   // hypotheses and fits steeper than this are rejected as walls
+#define AC_GROUNDPLANE_SPREAD_MIN_M         0.1f    // points must spread at least this far horizontally for the slope to be observable
+#define AC_GROUNDPLANE_MIN_INLIERS          5       // minimum number of inliers for a valid estimate
+
+class AC_GroundPlane {
+public:
+
+    struct Estimate {
+        float height_m;         // height of the position passed to update() above the plane, measured vertically
+        float slope_deg;        // slope of the plane, zero if slope_valid is false
+        float roughness_m;      // RMS vertical distance of the inliers from the plane
+        uint16_t num_points;    // number of points fitted
+        uint16_t num_inliers;   // number of points within AC_GROUNDPLANE_INLIER_M of the plane
+        bool slope_valid;       // false if the points were too close together horizontally and a level plane was fitted
+        uint32_t time_ms;       // system time of the fit
+    };
+
+    // add a point on the ground (NED in meters from the EKF origin) measured at time_ms
+    void add_point(const Vector3f &point_ned_m, uint32_t time_ms);
+
+    // fit a plane to the recent points below the vehicle plus num_extra points (NED in meters
+    // from the EKF origin), for example returns from a scanning lidar's point cloud
+    void update(const Vector3f &vehicle_pos_ned_m, uint32_t now_ms, const Vector3f *extra_points = nullptr, uint16_t num_extra = 0);
+
+    // get the most recent estimate, returns false if it is older than AC_GROUNDPLANE_POINT_TIMEOUT_MS
+    bool get_estimate(Estimate &estimate, uint32_t now_ms) const;
+
+private:
+
+    struct Point {
+        Vector3f pos_ned_m;
+        uint32_t time_ms;
+    };
+
+    // add a point relative to the vehicle to the points to be fitted if it is within a downward cone below the vehicle and within range
+    void add_candidate(const Vector3f &rel_pos_m);
+
+    // fit a plane z = a.x + b.y + c to the candidates, returns false if there are too few inliers
+    bool fit_plane(Estimate &estimate);
+
+    // fit a level plane z = c to the candidates, returns false if there are too few inliers
+    bool fit_level(Estimate &estimate);
+
+    // returns a pseudo random index below num
+    uint16_t random_index(uint16_t num);
+
+    // ring of recent points
+    Point _points[AC_GROUNDPLANE_MAX_POINTS] {};
+    uint8_t _points_head = 0;
+
+    // points used by the current fit, relative to the vehicle
+    Vector3f _candidates[AC_GROUNDPLANE_MAX_POINTS];
+    uint16_t _num_candidates = 0;
+
+    Estimate _estimate {};
+    bool _estimate_ok = false;
+};
@@ -0,0 +1,73 @@
+#include "AC_LandDetector.h"
+
+#include <math.h>
+
+bool AC_LandDetector::criteria_met(const Params &params, const Inputs &in)
+{
+    // check that the airframe is not accelerating (not falling or braking after fast forward flight)
+    const bool accel_stationary = (in.accel_ef_filt_length <= params.accel_max * in.scalar);
+
+    // check that vertical speed is within 1m/s of zero
+    const bool descent_rate_low = fabsf(in.climb_rate_cms) < 100 * in.scalar;
+
+    // if we have a healthy rangefinder only allow landing detection below 2 meters
+    const bool rangefinder_check = (!in.rangefinder_alt_ok || in.rangefinder_alt_cm < params.rangefinder_min_alt_cm);
+
+    // mot_low is used instead of motor_at_lower_limit when landing on the rangefinder,
+    // it must be between motor_at_lower_limit and hover
+    const bool land_mot_low = in.throttle_out < params.mot_low;
+
+    // rangefinder at ground clearance allows landing regardless of accel_stationary.
+    // The ground contact classifier looks at the spread and trend of recent
+    // readings, so a single noisy reading neither triggers nor resets it
+    bool height_gnd_clear;
+    if (in.gnd_contact_valid) {
+        height_gnd_clear = in.gnd_contact >= params.gnd_contact_min;
+    } else {
+        height_gnd_clear = in.rangefinder_alt_cm < in.gnd_clear_cm && in.rangefinder_alt_cm > 0;
+    }
+    // a single beam reading swings as the airframe rocks on uneven ground,
+    // the plane fitted to all the returns below the vehicle does not
+    height_gnd_clear = height_gnd_clear || ground_plane_contact(params, in);
+
+    return (in.motor_at_lower_limit && accel_stationary && descent_rate_low && in.throttle_mix_at_min && rangefinder_check && in.wow_check) ||
+           (params.use_rangefinder && land_mot_low && descent_rate_low && in.throttle_mix_at_min && rangefinder_check && in.wow_check && height_gnd_clear);
+}
+
+bool AC_LandDetector::ground_plane_contact(const Params &params, const Inputs &in)
+{
+    return in.ground_plane_valid &&
+           (in.ground_plane_roughness_cm <= params.ground_plane_roughness_max_cm) &&
+           (in.ground_plane_height_cm < in.gnd_clear_cm + params.ground_plane_margin_cm);
+}
+
+float AC_LandDetector::trigger_sec(const Params &params, const Inputs &in, float trigger_sec)
+{
+    // a rangefinder which has settled at ground clearance is strong
+    // evidence of touchdown, so don't wait as long for the other criteria
+    if (params.use_rangefinder && ((in.gnd_contact_valid && in.gnd_contact >= params.gnd_contact_min) ||
+                                   ground_plane_contact(params, in))) {
+        return fminf(trigger_sec, params.gnd_contact_trigger_sec);
+    }
+    return trigger_sec;
+}
+
+bool AC_LandDetector::update(bool criteria, uint32_t steps, uint32_t trigger_count, uint32_t &steps_used)
+{
+    steps_used = steps;
+    if (!criteria) {
+        // we've sensed movement up or down so reset land_detector
+        count = 0;
+        return false;
+    }
+    // the counter saturates at trigger_count and landing is declared
+    // on the following loop
+    const uint32_t remaining = trigger_count - (count < trigger_count ? count : trigger_count);
+    if (steps <= remaining) {
+        count += steps;
+        return false;
+    }
+    steps_used = remaining + 1;
+    count = trigger_count;
+    return true;
+}
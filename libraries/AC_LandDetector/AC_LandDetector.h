@@ -0,0 +1,72 @@
+/// @file   AC_LandDetector.h
+/// @brief  Multicopter landing detector predicate and trigger counter
+
+/**
+    The landed criteria are kept free of any vehicle state so that the
+    same logic runs in ArduCopter's update_land_detector() and in the
+    offline evaluator (Tools/LandDetectorReplay) which feeds it values
+    decoded from a DataFlash log.
+**/
+#pragma once
+
+#include <stdint.h>
+
+class AC_LandDetector {
+public:
+
+    // tuning values which are parameters or compile-time constants in the vehicle
+    struct Params {
+        bool use_rangefinder;               // LAND_DET_RNGFND == 1
+        float mot_low;                      // LAND_DET_MOT_LOW
+        int32_t rangefinder_min_alt_cm;     // LAND_RANGEFINDER_MIN_ALT_CM
+        float accel_max;                    // LAND_DETECTOR_ACCEL_MAX in m/s/s
+        float gnd_contact_min;              // ground contact confidence at which the rangefinder counts as on the ground
+        float ground_plane_margin_cm;       // ground plane height above ground clearance which counts as on the ground
+        float ground_plane_roughness_max_cm; // ground plane is not used on surfaces rougher than this
+        float gnd_contact_trigger_sec;      // trigger time once the rangefinder or ground plane shows ground contact
+    };
+
+    // vehicle state sampled once per main loop
+    struct Inputs {
+        bool motor_at_lower_limit;
+        bool throttle_mix_at_min;
+        bool rangefinder_alt_ok;
+        bool wow_check;                     // weight on wheels or unknown
+        uint8_t scalar;                     // 2 if a WoW sensor is fitted, 1 otherwise
+        float accel_ef_filt_length;         // length of 1hz filtered earth-frame accel in m/s/s
+        float climb_rate_cms;
+        float throttle_out;
+        int32_t rangefinder_alt_cm;
+        int16_t gnd_clear_cm;               // rangefinder ground clearance
+        bool gnd_contact_valid;             // true if gnd_contact is available
+        float gnd_contact;                  // rangefinder ground contact confidence, 0 to 1
+        bool ground_plane_valid;            // true if the ground_plane values are available
+        float ground_plane_height_cm;       // height above the plane fitted to returns below the vehicle
+        float ground_plane_roughness_cm;    // RMS distance of the returns from the plane
+    };
+
+    // returns true if the landed criteria are met for these inputs
+    static bool criteria_met(const Params &params, const Inputs &in);
+
+    // returns true if the ground plane puts the vehicle at ground clearance
+    static bool ground_plane_contact(const Params &params, const Inputs &in);
+
+    // returns the time the criteria must be met for before landing is
+    // declared, shortened from trigger_sec when there is ground contact
+    static float trigger_sec(const Params &params, const Inputs &in, float trigger_sec);
+
+    // advance the detector by steps loops during which criteria_met
+    // held the same value.  Returns true if a landing was detected,
+    // in which case steps_used is the number of loops consumed up to
+    // and including the loop in which it triggered.
+    bool update(bool criteria, uint32_t steps, uint32_t trigger_count, uint32_t &steps_used);
+
+    // reset the counter (e.g. on standby or change of landed state)
+    void reset() { count = 0; }
+
+    uint32_t get_count() const { return count; }
+
+private:
+    // number of consecutive loops the landed criteria have been met
+    uint32_t count = 0;
+};
@@ -0,0 +1,144 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AC_LandDetector/AC_GroundPlane.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define TEST_TIME_MS        5000U
+#define TEST_HEIGHT_M       2.0f
+
+// add a grid of points on the plane z = height + slope_x.x below a vehicle at the origin
+static uint16_t add_grid(AC_GroundPlane &plane, float slope_x)
+{
+    uint16_t count = 0;
+    for (int8_t i = -3; i <= 3; i++) {
+        for (int8_t j = -3; j <= 3; j++) {
+            const Vector3f point {i * 0.2f, j * 0.2f, TEST_HEIGHT_M + slope_x * i * 0.2f};
+            plane.add_point(point, TEST_TIME_MS);
+            count++;
+        }
+    }
+    return count;
+}
+
+TEST(AC_GroundPlane, flat)
+{
+    AC_GroundPlane plane;
+    const uint16_t count = add_grid(plane, 0);
+    plane.update(Vector3f(), TEST_TIME_MS);
+
+    AC_GroundPlane::Estimate estimate;
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M, 1.0e-3f);
+    EXPECT_TRUE(estimate.slope_valid);
+    EXPECT_NEAR(estimate.slope_deg, 0, 0.1f);
+    EXPECT_NEAR(estimate.roughness_m, 0, 1.0e-3f);
+    EXPECT_EQ(estimate.num_points, count);
+    EXPECT_EQ(estimate.num_inliers, count);
+
+    // the height is measured from the vehicle
+    plane.update(Vector3f(0, 0, 0.5f), TEST_TIME_MS);
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M - 0.5f, 1.0e-3f);
+
+    // the estimate goes stale
+    EXPECT_FALSE(plane.get_estimate(estimate, TEST_TIME_MS + AC_GROUNDPLANE_POINT_TIMEOUT_MS + 1));
+}
+
+TEST(AC_GroundPlane, tilted)
+{
+    AC_GroundPlane plane;
+    add_grid(plane, 0.2f);
+    plane.update(Vector3f(), TEST_TIME_MS);
+
+    AC_GroundPlane::Estimate estimate;
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M, 1.0e-3f);
+    EXPECT_TRUE(estimate.slope_valid);
+    EXPECT_NEAR(estimate.slope_deg, degrees(atanf(0.2f)), 0.1f);
+    EXPECT_NEAR(estimate.roughness_m, 0, 1.0e-3f);
+}
+
+TEST(AC_GroundPlane, outliers)
+{
+    AC_GroundPlane plane;
+    const uint16_t count = add_grid(plane, 0);
+    // returns from an object on the ground and from spray well above it
+    const Vector3f extra[] {
+        {0.1f, 0.1f, TEST_HEIGHT_M - 0.2f},
+        {-0.1f, 0.3f, TEST_HEIGHT_M - 0.2f},
+        {0.3f, -0.1f, TEST_HEIGHT_M - 0.2f},
+        {0.3f, 0.3f, 0.5f},
+        {-0.5f, 0.1f, 0.7f},
+    };
+    plane.update(Vector3f(), TEST_TIME_MS, extra, ARRAY_SIZE(extra));
+
+    AC_GroundPlane::Estimate estimate;
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M, 1.0e-3f);
+    EXPECT_NEAR(estimate.slope_deg, 0, 0.1f);
+    EXPECT_EQ(estimate.num_points, count + ARRAY_SIZE(extra));
+    EXPECT_EQ(estimate.num_inliers, count);
+    // the object is close enough to count towards the roughness, the spray is not
+    EXPECT_GT(estimate.roughness_m, 0.01f);
+    EXPECT_LT(estimate.roughness_m, 0.2f);
+}
+
+TEST(AC_GroundPlane, wall)
+{
+    AC_GroundPlane plane;
+    const uint16_t count = add_grid(plane, 0);
+    // returns from a wall beside the vehicle are outside the downward cone
+    for (uint8_t i = 0; i < 10; i++) {
+        plane.add_point(Vector3f(1.5f, (i - 5) * 0.1f, 0.2f + i * 0.1f), TEST_TIME_MS);
+    }
+    plane.update(Vector3f(), TEST_TIME_MS);
+
+    AC_GroundPlane::Estimate estimate;
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_EQ(estimate.num_points, count);
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M, 1.0e-3f);
+    EXPECT_NEAR(estimate.slope_deg, 0, 0.1f);
+
+    // without the ground there is nothing to fit
+    AC_GroundPlane wall_only;
+    for (uint8_t i = 0; i < 20; i++) {
+        wall_only.add_point(Vector3f(1.5f, (i % 5) * 0.1f, 0.2f + (i / 5) * 0.2f), TEST_TIME_MS);
+    }
+    wall_only.update(Vector3f(), TEST_TIME_MS);
+    EXPECT_FALSE(wall_only.get_estimate(estimate, TEST_TIME_MS));
+}
+
+TEST(AC_GroundPlane, too_few_points)
+{
+    AC_GroundPlane plane;
+    for (uint8_t i = 0; i < AC_GROUNDPLANE_MIN_INLIERS - 1; i++) {
+        plane.add_point(Vector3f(i * 0.2f, 0, TEST_HEIGHT_M), TEST_TIME_MS);
+    }
+    // points above the vehicle, outside the radius or too old are not used
+    plane.add_point(Vector3f(0, 0, -1.0f), TEST_TIME_MS);
+    plane.add_point(Vector3f(AC_GROUNDPLANE_RADIUS_M + 1, 0, TEST_HEIGHT_M), TEST_TIME_MS);
+    plane.add_point(Vector3f(0, 0.2f, TEST_HEIGHT_M), TEST_TIME_MS - AC_GROUNDPLANE_POINT_TIMEOUT_MS);
+    plane.update(Vector3f(), TEST_TIME_MS);
+
+    AC_GroundPlane::Estimate estimate;
+    EXPECT_FALSE(plane.get_estimate(estimate, TEST_TIME_MS));
+}
+
+TEST(AC_GroundPlane, single_beam)
+{
+    // a hovering vehicle's single rangefinder sees one patch of ground
+    AC_GroundPlane plane;
+    for (uint8_t i = 0; i < 10; i++) {
+        plane.add_point(Vector3f(0, 0, TEST_HEIGHT_M + (i % 2) * 0.01f), TEST_TIME_MS);
+    }
+    plane.update(Vector3f(), TEST_TIME_MS);
+
+    AC_GroundPlane::Estimate estimate;
+    ASSERT_TRUE(plane.get_estimate(estimate, TEST_TIME_MS));
+    EXPECT_FALSE(estimate.slope_valid);
+    EXPECT_NEAR(estimate.height_m, TEST_HEIGHT_M + 0.005f, 1.0e-3f);
+}
+
+AP_GTEST_MAIN()
@@ -589,6 +589,83 @@ private:
     uint16_t _head;  // first element
 };
 
+/*
+  lock-free ring of timestamped objects passed from exactly one producer
+  thread to exactly one consumer thread, e.g. from a driver's bus thread
+  to the main loop, so that neither side ever waits on a semaphore held
+  by the other. The producer only writes tail and the consumer only
+  writes head; the object is written before tail is released and read
+  before head is released. When the ring is full push() fails and the
+  new object is dropped rather than overwriting one being read.
+  N must be a power of two
+ */
+template <class T, uint16_t N>
+class ObjectBuffer_SPSC {
+public:
+    static_assert(N > 0 && N <= 32768 && (N & (N - 1)) == 0, "ObjectBuffer_SPSC size must be a power of two");
+
+    // producer: add an object to the back of the queue. Returns false if full.
+    // The timestamp is 64 bit so it can be compared with millis() after conversion
+    bool push(const T &object, uint64_t timestamp_us) {
+        const uint16_t t = tail.load(std::memory_order_relaxed);
+        if (uint16_t(t - head.load(std::memory_order_acquire)) >= N) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        Item &item = items[t & (N - 1)];
+        item.timestamp_us = timestamp_us;
+        item.object = object;
+        tail.store(uint16_t(t + 1), std::memory_order_release);
+        return true;
+    }
+
+    // consumer: take the oldest object from the front of the queue. Returns false if empty
+    bool pop(T &object, uint64_t &timestamp_us) WARN_IF_UNUSED {
+        const uint16_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const Item &item = items[h & (N - 1)];
+        timestamp_us = item.timestamp_us;
+        object = item.object;
+        head.store(uint16_t(h + 1), std::memory_order_release);
+        return true;
+    }
+
+    // consumer: discard everything in the queue
+    void clear(void) {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // number of objects waiting to be read. Exact from the consumer, a lower bound from the producer
+    uint16_t available(void) const {
+        return uint16_t(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    // number of objects which could be pushed. Exact from the producer, a lower bound from the consumer
+    uint16_t space(void) const {
+        return N - available();
+    }
+
+    // number of objects dropped because the queue was full
+    uint32_t get_dropped(void) const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    uint16_t get_size(void) const { return N; }
+
+private:
+    struct Item {
+        uint64_t timestamp_us;
+        T object;
+    };
+    Item items[N];
+
+    std::atomic<uint16_t> head{0};      // next object to read, written by the consumer
+    std::atomic<uint16_t> tail{0};      // next slot to write, written by the producer
+    std::atomic<uint32_t> dropped{0};   // written by the producer
+};
+
 typedef ObjectBuffer<float> FloatBuffer;
 typedef ObjectBuffer_TS<float> FloatBuffer_TS;
 typedef ObjectArray<float> FloatArray;
@@ -16,6 +16,7 @@
  */
 #include <AP_gtest.h>
 
+#include <thread>
 #include <utility>
 #include <AP_HAL/utility/RingBuffer.h>
 
@@ -122,4 +123,80 @@ TEST(ObjectBufferTest, PeekTest)
     }
 }
 
+TEST(ObjectBufferSPSCTest, Basic)
+{
+    ObjectBuffer_SPSC<uint32_t, 8> x;
+    EXPECT_EQ(x.available(), 0U);
+    EXPECT_EQ(x.space(), 8U);
+
+    uint32_t object;
+    uint64_t timestamp_us;
+    EXPECT_FALSE(x.pop(object, timestamp_us));
+
+    // fill it, wrapping the indices several times
+    uint32_t next_pop = 0;
+    for (uint32_t i=0; i<100; i++) {
+        while (x.space() == 0) {
+            EXPECT_TRUE(x.pop(object, timestamp_us));
+            EXPECT_EQ(object, next_pop);
+            EXPECT_EQ(timestamp_us, next_pop * 10);
+            next_pop++;
+        }
+        EXPECT_TRUE(x.push(i, i * 10));
+    }
+    EXPECT_EQ(x.available(), 8U);
+
+    // a full ring drops new objects
+    EXPECT_FALSE(x.push(1000, 0));
+    EXPECT_EQ(x.get_dropped(), 1U);
+    EXPECT_TRUE(x.pop(object, timestamp_us));
+    EXPECT_EQ(object, next_pop);
+
+    x.clear();
+    EXPECT_EQ(x.available(), 0U);
+    EXPECT_FALSE(x.pop(object, timestamp_us));
+
+    // timestamps survive past the 32 bit micros() wrap
+    EXPECT_TRUE(x.push(7, 0x100000005ULL));
+    EXPECT_TRUE(x.pop(object, timestamp_us));
+    EXPECT_EQ(timestamp_us, 0x100000005ULL);
+}
+
+TEST(ObjectBufferSPSCTest, Threads)
+{
+    struct Reading {
+        uint32_t seq;
+        float distance;
+    };
+    static ObjectBuffer_SPSC<Reading, 16> x;
+    const uint32_t count = 100000;
+
+    std::thread producer([&]() {
+        for (uint32_t i=0; i<count; ) {
+            if (x.push(Reading{i, i * 0.5f}, i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // every object arrives once, in order and intact
+    Reading reading;
+    uint64_t timestamp_us;
+    uint32_t expected = 0;
+    while (expected < count) {
+        if (x.pop(reading, timestamp_us)) {
+            ASSERT_EQ(reading.seq, expected);
+            ASSERT_EQ(timestamp_us, expected);
+            ASSERT_FLOAT_EQ(reading.distance, expected * 0.5f);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_EQ(x.available(), 0U);
+}
+
 AP_GTEST_MAIN()
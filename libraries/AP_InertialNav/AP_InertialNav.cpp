@@ -43,6 +43,50 @@ void AP_InertialNav::update(bool high_vibes)
             _velocity_cm.z = -rate_z * 100; // convert from m/s in NED to cm/s in NEU
         }
     }
+
+#if AP_INERTIALNAV_ALT_HISTORY_ENABLED
+    update_alt_history();
+#endif
+}
+
+#if AP_INERTIALNAV_ALT_HISTORY_ENABLED
+void AP_InertialNav::update_alt_history()
+{
+    if (_alt_history == nullptr) {
+        return;
+    }
+    float pos_d_delta;
+    const uint32_t reset_ms = _ahrs_ekf.getLastPosDownReset(pos_d_delta);
+    if (reset_ms != _last_pos_d_reset_ms) {
+        _last_pos_d_reset_ms = reset_ms;
+        for (uint16_t i=0; i<_alt_history_count; i++) {
+            _alt_history[i].alt_cm -= pos_d_delta * 100;
+        }
+    }
+
+    _alt_history[_alt_history_head] = { AP_HAL::micros(), _relpos_cm.z };
+    _alt_history_head = (_alt_history_head + 1) % AP_INERTIALNAV_ALT_HISTORY_LEN;
+    if (_alt_history_count < AP_INERTIALNAV_ALT_HISTORY_LEN) {
+        _alt_history_count++;
+    }
+}
+#endif  // AP_INERTIALNAV_ALT_HISTORY_ENABLED
+
+/**
+ * init_alt_history - allocate the altitude history used by get_position_z_up_cm_at
+ *
+ * @return false if the history is not available or could not be allocated
+ */
+bool AP_InertialNav::init_alt_history()
+{
+#if AP_INERTIALNAV_ALT_HISTORY_ENABLED
+    if (_alt_history == nullptr) {
+        _alt_history = new AltHistory[AP_INERTIALNAV_ALT_HISTORY_LEN];
+    }
+    return _alt_history != nullptr;
+#else
+    return false;
+#endif
 }
 
 /**
@@ -84,6 +128,57 @@ float AP_InertialNav::get_position_z_up_cm() const
     return _relpos_cm.z;
 }
 
+/**
+ * get_position_z_up_cm_at - returns the z position, frame z-axis up, in cm, at a past system time
+ *
+ * @return false if time_us is older than the history or there is none
+ */
+bool AP_InertialNav::get_position_z_up_cm_at(uint32_t time_us, float &alt_cm) const
+{
+#if AP_INERTIALNAV_ALT_HISTORY_ENABLED
+    if (_alt_history_count == 0) {
+        return false;
+    }
+    // entries are in time order starting from the oldest, so binary
+    // search for the last one at or before time_us. Times are compared
+    // relative to the newest entry to cope with wrap
+    const uint16_t oldest = (_alt_history_head + AP_INERTIALNAV_ALT_HISTORY_LEN - _alt_history_count) % AP_INERTIALNAV_ALT_HISTORY_LEN;
+    const AltHistory &newest = _alt_history[(_alt_history_head + AP_INERTIALNAV_ALT_HISTORY_LEN - 1) % AP_INERTIALNAV_ALT_HISTORY_LEN];
+    const int32_t age_us = newest.time_us - time_us;
+    if (age_us <= 0) {
+        alt_cm = newest.alt_cm;
+        return true;
+    }
+    const auto age = [&](uint16_t i) {
+        return int32_t(newest.time_us - _alt_history[(oldest + i) % AP_INERTIALNAV_ALT_HISTORY_LEN].time_us);
+    };
+    if (age(0) < age_us) {
+        return false;
+    }
+    uint16_t lo = 0;
+    uint16_t hi = _alt_history_count - 1;
+    while (hi - lo > 1) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (age(mid) >= age_us) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const AltHistory &a = _alt_history[(oldest + lo) % AP_INERTIALNAV_ALT_HISTORY_LEN];
+    const AltHistory &b = _alt_history[(oldest + hi) % AP_INERTIALNAV_ALT_HISTORY_LEN];
+    const uint32_t span_us = b.time_us - a.time_us;
+    if (span_us == 0) {
+        alt_cm = b.alt_cm;
+        return true;
+    }
+    alt_cm = a.alt_cm + (b.alt_cm - a.alt_cm) * (float(time_us - a.time_us) / span_us);
+    return true;
+#else
+    return false;
+#endif
+}
+
 /**
  * get_velocity_neu_cms - returns the current velocity in cm/s
  *
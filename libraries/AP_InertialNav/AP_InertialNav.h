@@ -7,6 +7,19 @@
 
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_NavEKF/AP_Nav_Common.h>              // definitions shared by inertial and ekf nav filters
+#include <AP_RangeFinder/AP_RangeFinder_config.h>
+
+// altitude history for get_position_z_up_cm_at(), used to align
+// rangefinder readings with the altitude when they were measured
+#ifndef AP_INERTIALNAV_ALT_HISTORY_ENABLED
+#define AP_INERTIALNAV_ALT_HISTORY_ENABLED AP_RANGEFINDER_ENABLED
+#endif
+
+// number of past altitudes kept for get_position_z_up_cm_at(), which
+// at a 400Hz main loop covers the last 320ms
+#ifndef AP_INERTIALNAV_ALT_HISTORY_LEN
+#define AP_INERTIALNAV_ALT_HISTORY_LEN 128
+#endif
 
 class AP_InertialNav
 {
@@ -46,6 +59,23 @@ public:
      */
     float              get_position_z_up_cm() const;
 
+    /**
+     * init_alt_history - allocate the altitude history used by get_position_z_up_cm_at.
+     *      Only vehicles with a sensor which needs it should call this
+     *
+     * @return false if the history is not available or could not be allocated
+     */
+    bool               init_alt_history();
+
+    /**
+     * get_position_z_up_cm_at - returns the z position, frame z up, in cm, at a past
+     *      system time, interpolated between updates. Lets sensors with latency be
+     *      compared with the altitude at the time they measured it.
+     *
+     * @return false if time_us is older than the history or there is none
+     */
+    bool               get_position_z_up_cm_at(uint32_t time_us, float &alt_cm) const;
+
     /**
      * get_velocity_neu_cms - returns the current velocity in cm/s
      *
@@ -81,4 +111,18 @@ private:
     Vector3f _relpos_cm;   // NEU
     Vector3f _velocity_cm; // NEU
     AP_AHRS &_ahrs_ekf;
+
+#if AP_INERTIALNAV_ALT_HISTORY_ENABLED
+    // record the altitude after each update, moving past altitudes
+    // with any EKF height reset so the history stays continuous
+    void update_alt_history();
+
+    struct AltHistory {
+        uint32_t time_us;
+        float alt_cm;
+    } *_alt_history = nullptr;      // allocated by init_alt_history()
+    uint16_t _alt_history_head = 0; // next entry to write
+    uint16_t _alt_history_count = 0;
+    uint32_t _last_pos_d_reset_ms = 0;
+#endif
 };
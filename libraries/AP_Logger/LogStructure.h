@@ -489,6 +489,8 @@ struct PACKED log_TERRAIN {
     uint16_t pending;
     uint16_t loaded;
     float reference_offset;
+    uint8_t hit_ratio;
+    uint16_t late;
 };
 
 struct PACKED log_CSRV {
@@ -573,6 +575,18 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_TaskHistogram {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t task_id;
+    uint32_t count;
+    uint16_t p50_us;
+    uint16_t p95_us;
+    uint16_t p99_us;
+    uint16_t max_us;
+    char name[16];
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -934,6 +948,17 @@ struct PACKED log_VER {
 // @Field: I2CI: Number of i2c interrupts serviced
 // @Field: Ex: number of microseconds being added to each loop to address scheduler overruns
 
+// @LoggerMessage: PMTH
+// @Description: Scheduler task and main loop time distribution since the previous PM message
+// @Field: TimeUS: Time since system startup
+// @Field: Id: task index in the order tasks are run, 255 for the main loop
+// @Field: N: number of times the task ran or number of loops
+// @Field: P50: median time taken, rounded up to a histogram bucket boundary
+// @Field: P95: 95th percentile time taken, rounded up to a histogram bucket boundary
+// @Field: P99: 99th percentile time taken, rounded up to a histogram bucket boundary
+// @Field: Max: maximum time taken
+// @Field: Name: task name
+
 // @LoggerMessage: POWR
 // @Description: System power information
 // @Field: TimeUS: Time since system startup
@@ -1100,6 +1125,8 @@ struct PACKED log_VER {
 // @Field: Pending: Number of tile requests outstanding
 // @Field: Loaded: Number of tiles in memory
 // @Field: ROfs: terrain reference offset for arming altitude
+// @Field: HitR: percentage of terrain height lookups since startup that found data
+// @Field: Late: number of tiles that were not loaded when the vehicle reached them while armed
 
 // @LoggerMessage: TSYN
 // @Description: Time synchronisation response information
@@ -1240,13 +1267,15 @@ LOG_STRUCTURE_FROM_MOUNT \
     LOG_STRUCTURE_FROM_PROXIMITY                                    \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHHIIHHIIIIII", "TimeUS,LR,NLon,NL,MaxT,Mem,Load,ErrL,IntE,ErrC,SPIC,I2CC,I2CI,Ex", "sz---b%------s", "F----0A------F" }, \
+    { LOG_TASK_HISTOGRAM_MSG, sizeof(log_TaskHistogram),                \
+      "PMTH", "QBIHHHHN", "TimeUS,Id,N,P50,P95,P99,Max,Name", "s#-ssss-", "F--FFFF-", true }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
 LOG_STRUCTURE_FROM_AVOIDANCE \
     { LOG_SIMSTATE_MSG, sizeof(log_AHRS), \
       "SIM","QccCfLLffff","TimeUS,Roll,Pitch,Yaw,Alt,Lat,Lng,Q1,Q2,Q3,Q4", "sddhmDU----", "FBBB0GG0000", true }, \
     { LOG_TERRAIN_MSG, sizeof(log_TERRAIN), \
-      "TERR","QBLLHffHHf","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded,ROfs", "s-DU-mm--m", "F-GG-00--0", true }, \
+      "TERR","QBLLHffHHfBH","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded,ROfs,HitR,Late", "s-DU-mm--m%-", "F-GG-00--00-", true }, \
 LOG_STRUCTURE_FROM_ESC_TELEM \
     { LOG_CSRV_MSG, sizeof(log_CSRV), \
       "CSRV","QBfffBfffffB","TimeUS,Id,Pos,Force,Speed,Pow,PosCmd,V,A,MotT,PCBT,Err", "s#---%dvAOO-", "F-000000000-", true }, \
@@ -1373,6 +1402,7 @@ enum LogMessages : uint8_t {
     LOG_DF_FILE_STATS,
     LOG_SRTL_MSG,
     LOG_PERFORMANCE_MSG,
+    LOG_TASK_HISTOGRAM_MSG,
     LOG_OPTFLOW_MSG,
     LOG_EVENT_MSG,
     LOG_WHEELENCODER_MSG,
@@ -196,6 +196,92 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
     return sqrtf(closest_sq);
 }
 
+/*
+  batch version of Polygon_closest_distance_line. The crossings are
+  found as Polygon_intersects does and the closest distances as
+  closest_distance_between_lines_squared, but with the polygon's points
+  relative to p1 and without branches in the per-line loops so they
+  can be vectorised
+ */
+void Polygon_closest_distance_lines(const Vector2f *V, unsigned N, const Vector2f &p1, const float *end_x, const float *end_y, uint8_t count, float *dist, float *work)
+{
+    // dist holds the closest distance squared, work the squared
+    // distance from p1 of the crossing closest to p1 or FLT_MAX
+    for (uint8_t k = 0; k < count; k++) {
+        dist[k] = FLT_MAX;
+        work[k] = FLT_MAX;
+    }
+    if (N < 2) {
+        for (uint8_t k = 0; k < count; k++) {
+            dist[k] = sqrtf(dist[k]);
+        }
+        return;
+    }
+
+    // closest distance from each line to each edge is the closest of
+    // the distances from the edge's ends to the line and from the line's
+    // ends to the edge. The closing edge is only included if the last
+    // point repeats the first
+    float start_dist_sq = FLT_MAX;
+    for (unsigned i = 0; i < N; i++) {
+        const Vector2f v1 = V[i] - p1;
+        for (uint8_t k = 0; k < count; k++) {
+            // as Vector2f::closest_point, the closest point on a zero length line is its start
+            const float len_sq = sq(end_x[k]) + sq(end_y[k]);
+            const float inv_len_sq = (len_sq < FLT_EPSILON) ? 0.0f : 1.0f / len_sq;
+            const float t = MIN(MAX((v1.x * end_x[k] + v1.y * end_y[k]) * inv_len_sq, 0.0f), 1.0f);
+            dist[k] = MIN(dist[k], sq(end_x[k] * t - v1.x) + sq(end_y[k] * t - v1.y));
+        }
+        if (i + 1 >= N) {
+            break;
+        }
+        const Vector2f edge = V[i + 1] - V[i];
+        start_dist_sq = MIN(start_dist_sq, Vector2f::closest_distance_between_radial_and_point_squared(edge, -v1));
+        // and the closest point on a zero length edge is its end
+        const float edge_len_sq = edge.length_squared();
+        const float edge_inv_len_sq = (edge_len_sq < FLT_EPSILON) ? 0.0f : 1.0f / edge_len_sq;
+        const float t_min = (edge_len_sq < FLT_EPSILON) ? 1.0f : 0.0f;
+        for (uint8_t k = 0; k < count; k++) {
+            const float px = end_x[k] - v1.x;
+            const float py = end_y[k] - v1.y;
+            const float t = MIN(MAX((px * edge.x + py * edge.y) * edge_inv_len_sq, t_min), 1.0f);
+            dist[k] = MIN(dist[k], sq(edge.x * t - px) + sq(edge.y * t - py));
+        }
+    }
+    for (uint8_t k = 0; k < count; k++) {
+        dist[k] = MIN(dist[k], start_dist_sq);
+    }
+
+    // crossings of the polygon's edges as Vector2f::segment_intersection
+    // with the edge as the first segment. The closing edge is always included
+    const unsigned num_edges = Polygon_complete(V, N) ? N - 1 : N;
+    for (unsigned i = 0; i < num_edges; i++) {
+        const Vector2f v1 = V[i] - p1;
+        const Vector2f edge = V[(i + 1 < num_edges) ? i + 1 : 0] - V[i];
+        const float start_x_edge = v1.y * edge.x - v1.x * edge.y;
+        for (uint8_t k = 0; k < count; k++) {
+            const float edge_x_line = edge.x * end_y[k] - edge.y * end_x[k];
+            const bool parallel = fabsf(edge_x_line) < FLT_EPSILON;
+            const float inv = 1.0f / (parallel ? 1.0f : edge_x_line);
+            // fraction along the edge and along the line of the crossing
+            const float t = (v1.y * end_x[k] - v1.x * end_y[k]) * inv;
+            const float u = start_x_edge * inv;
+            const bool crosses = !parallel && (t >= 0) && (t <= 1) && (u >= 0) && (u <= 1);
+            // crossing point on the edge, relative to p1
+            const float cx = v1.x + edge.x * t;
+            const float cy = v1.y + edge.y * t;
+            const float cross_dist_sq = sq(cx) + sq(cy);
+            const bool closer = crosses && (cross_dist_sq < work[k]);
+            work[k] = closer ? cross_dist_sq : work[k];
+            // negative distance from the crossing to the line's end
+            dist[k] = closer ? -sqrtf(sq(cx - end_x[k]) + sq(cy - end_y[k])) : dist[k];
+        }
+    }
+    for (uint8_t k = 0; k < count; k++) {
+        dist[k] = (work[k] < FLT_MAX) ? dist[k] : sqrtf(dist[k]);
+    }
+}
+
 /*
   return the closest distance that point p comes to an edge of closed
   polygon V, defined by N points
@@ -39,6 +39,14 @@ bool Polygon_intersects(const Vector2f *V, unsigned N, const Vector2f &p1, const
  */
 float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2f &p1, const Vector2f &p2);
 
+/*
+  Polygon_closest_distance_line for count lines which all start at p1,
+  the k'th ending at p1 + (end_x[k], end_y[k]). Values which only depend
+  on p1 or the polygon are shared between the lines. dist returns the
+  result for each line and work must hold count values
+ */
+void Polygon_closest_distance_lines(const Vector2f *V, unsigned N, const Vector2f &p1, const float *end_x, const float *end_y, uint8_t count, float *dist, float *work);
+
 /*
   return the closest distance that a point p comes to an edge of
   closed polygon V, defined by N points
@@ -356,6 +356,58 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+// repeatable pseudo random numbers in the range lo to hi, get_random16() has a fixed seed
+static float rand_range(float lo, float hi)
+{
+    return lo + (hi - lo) * (get_random16() * (1.0f / 65536));
+}
+
+// the batch distances must match Polygon_closest_distance_line for each line
+TEST(Polygon, closest_distance_lines)
+{
+    uint32_t num_lines = 0;
+    uint32_t num_crossing = 0;
+    for (uint16_t n = 0; n < 500; n++) {
+        // star shaped polygon around a centre which may be far from the origin
+        Vector2f boundary[21];
+        const uint8_t num_points = 3 + n % 18;
+        const Vector2f centre { rand_range(-20000, 20000), rand_range(-20000, 20000) };
+        for (uint8_t i = 0; i < num_points; i++) {
+            const float angle = (i + rand_range(0, 0.9f)) * M_2PI / num_points;
+            const float radius = rand_range(500, 5000);
+            boundary[i] = centre + Vector2f{cosf(angle), sinf(angle)} * radius;
+        }
+        // half of the polygons repeat the first point
+        const uint8_t num_boundary = (n & 1) ? num_points + 1 : num_points;
+        boundary[num_points] = boundary[0];
+
+        const Vector2f start = centre + Vector2f{ rand_range(-6000, 6000), rand_range(-6000, 6000) };
+        float end_x[32], end_y[32], dist[32], work[32];
+        const uint8_t count = ARRAY_SIZE(end_x);
+        for (uint8_t k = 0; k < count; k++) {
+            const float bearing = rand_range(0, M_2PI);
+            // include a zero length line
+            const float length = (k == 0) ? 0 : rand_range(0, 4000);
+            end_x[k] = cosf(bearing) * length;
+            end_y[k] = sinf(bearing) * length;
+        }
+        Polygon_closest_distance_lines(boundary, num_boundary, start, end_x, end_y, count, dist, work);
+
+        for (uint8_t k = 0; k < count; k++) {
+            const float expected = Polygon_closest_distance_line(boundary, num_boundary, start, start + Vector2f{end_x[k], end_y[k]});
+            // points are relative to start rather than the origin so rounding differs
+            EXPECT_NEAR(dist[k], expected, 0.05f) << "polygon " << n << " line " << unsigned(k);
+            num_lines++;
+            if (expected < 0) {
+                num_crossing++;
+            }
+        }
+    }
+    // make sure both cases were covered
+    EXPECT_GT(num_crossing, num_lines / 10);
+    EXPECT_LT(num_crossing, num_lines * 9 / 10);
+}
+
 AP_GTEST_MAIN()
 
 
@@ -19,8 +19,24 @@
 #include <stdint.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
+#include <AP_Vehicle/AP_Vehicle_Type.h>
 #include "AP_Nav_Common.h"
 
+/*
+  Replay on desktop builds can update the cores of a filter on
+  separate threads (see EK3_FEATURE_PARALLEL_LANES), so there each
+  thread gets its own copy of the scratch space
+ */
+#ifndef EKF_SCRATCH_THREAD_LOCAL
+#define EKF_SCRATCH_THREAD_LOCAL (APM_BUILD_TYPE(APM_BUILD_Replay) && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX))
+#endif
+
+#if EKF_SCRATCH_THREAD_LOCAL
+#define EKF_SCRATCH thread_local
+#else
+#define EKF_SCRATCH
+#endif
+
 /*
   this declares a common parent class for AP_NavEKF2 and
   AP_NavEKF3. The purpose of this class is to hold common static
@@ -42,10 +58,10 @@ public:
 #endif
 
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    static EKF_SCRATCH Matrix24 KH;       // intermediate result used for covariance updates
+    static EKF_SCRATCH Matrix24 KHP;      // intermediate result used for covariance updates
+    static EKF_SCRATCH Matrix24 nextP;    // Predicted covariance matrix before addition of process noise to diagonals
+    static EKF_SCRATCH Vector28 Kfusion;  // intermediate fusion vector
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
@@ -1,6 +1,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "AP_NavEKF3_core.h"
+#include "AP_NavEKF3_Lanes.h"
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
@@ -743,6 +744,15 @@ NavEKF3::NavEKF3()
     AP_Param::setup_object_defaults(this, var_info2);
 }
 
+NavEKF3::~NavEKF3()
+{
+#if EK3_FEATURE_PARALLEL_LANES
+    // joins the lane threads before the cores they run go away
+    delete lanes;
+    lanes = nullptr;
+#endif
+}
+
 
 // Initialise the filter
 bool NavEKF3::InitialiseFilter(void)
@@ -906,17 +916,28 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = AP::dal().micros64();
 
+    bool allow_state_prediction[MAX_EKF_CORES];
     for (uint8_t i=0; i<num_cores; i++) {
         // if we have not overrun by more than 3 IMU frames, and we
         // have already used more than 1/3 of the CPU budget for this
         // loop then suppress the prediction step. This allows
         // multiple EKF instances to cooperate on scheduling
-        bool allow_state_prediction = true;
+        allow_state_prediction[i] = true;
         if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
             AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
-            allow_state_prediction = false;
+            allow_state_prediction[i] = false;
+        }
+    }
+
+#if EK3_FEATURE_PARALLEL_LANES
+    if (lanes != nullptr && (lanes->running() || lanes->start(core, num_cores))) {
+        lanes->update(allow_state_prediction);
+    } else
+#endif
+    {
+        for (uint8_t i=0; i<num_cores; i++) {
+            core[i].UpdateFilter(allow_state_prediction[i]);
         }
-        core[i].UpdateFilter(allow_state_prediction);
     }
 
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
@@ -2073,3 +2094,22 @@ const EKFGSF_yaw *NavEKF3::get_yawEstimator(void) const
     }
     return nullptr;
 }
+
+#if EK3_FEATURE_PARALLEL_LANES
+void NavEKF3::set_parallel_lanes(bool enable)
+{
+    if (enable && lanes == nullptr) {
+        lanes = new NavEKF3_Lanes();
+    } else if (!enable && lanes != nullptr) {
+        delete lanes;
+        lanes = nullptr;
+    }
+}
+
+void NavEKF3::wait_lower_cores(uint8_t core_index) const
+{
+    if (lanes != nullptr) {
+        lanes->wait_for_lower(core_index);
+    }
+}
+#endif
@@ -24,8 +24,10 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
+#include "AP_NavEKF3_feature.h"
 
 class NavEKF3_core;
+class NavEKF3_Lanes;
 class EKFGSF_yaw;
 
 class NavEKF3 {
@@ -33,6 +35,7 @@ class NavEKF3 {
 
 public:
     NavEKF3();
+    ~NavEKF3();
 
     /* Do not allow copies */
     CLASS_NO_COPY(NavEKF3);
@@ -365,6 +368,12 @@ public:
     // get a yaw estimator instance
     const EKFGSF_yaw *get_yawEstimator(void) const;
 
+#if EK3_FEATURE_PARALLEL_LANES
+    // update each core on its own thread; results are identical to
+    // the serial update. Used by Replay
+    void set_parallel_lanes(bool enable);
+#endif
+
 private:
     uint8_t num_cores; // number of allocated cores
     uint8_t primary;   // current primary core
@@ -532,6 +541,15 @@ private:
     // origin set by one of the cores
     Location common_EKF_origin;
     bool common_origin_valid;
+
+    // cores call this before touching state shared between cores so
+    // that parallel lanes see it in the same order as a serial update
+#if EK3_FEATURE_PARALLEL_LANES
+    void wait_lower_cores(uint8_t core_index) const;
+    NavEKF3_Lanes *lanes = nullptr;
+#else
+    void wait_lower_cores(uint8_t core_index) const {}
+#endif
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
@@ -661,6 +661,7 @@ bool NavEKF3_core::setOrigin(const Location &loc)
     validOrigin = true;
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
+    frontend->wait_lower_cores(core_index);
     if (!frontend->common_origin_valid) {
         frontend->common_origin_valid = true;
         // put origin in frontend as well to ensure it stays in sync between lanes
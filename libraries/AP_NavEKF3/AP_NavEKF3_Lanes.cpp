@@ -0,0 +1,130 @@
+#include "AP_NavEKF3_Lanes.h"
+
+#if EK3_FEATURE_PARALLEL_LANES
+
+#include "AP_NavEKF3_core.h"
+
+#include <sched.h>
+
+// number of polls before a waiting thread starts yielding or sleeping;
+// frames arrive at the IMU rate so lanes are normally only briefly idle
+#define LANE_SPIN_COUNT 2000
+
+NavEKF3_Lanes::~NavEKF3_Lanes()
+{
+    stop();
+}
+
+bool NavEKF3_Lanes::start(NavEKF3_core *_core, uint8_t num_cores)
+{
+    stop();
+    if (_core == nullptr || num_cores < 2 || num_cores > MAX_EKF_CORES) {
+        return false;
+    }
+    core = _core;
+    quit.store(false);
+    frame.store(0);
+    for (uint8_t i=0; i<num_cores; i++) {
+        done[i].store(0);
+    }
+    for (uint8_t i=1; i<num_cores; i++) {
+        args[i] = {this, i};
+        if (pthread_create(&threads[i], nullptr, thread_main, &args[i]) != 0) {
+            num_lanes = i;
+            stop();
+            return false;
+        }
+    }
+    num_lanes = num_cores;
+    return true;
+}
+
+void NavEKF3_Lanes::stop()
+{
+    if (num_lanes == 0) {
+        return;
+    }
+    pthread_mutex_lock(&mutex);
+    quit.store(true);
+    frame.fetch_add(1, std::memory_order_release);
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+    for (uint8_t i=1; i<num_lanes; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+    num_lanes = 0;
+}
+
+void *NavEKF3_Lanes::thread_main(void *arg)
+{
+    const lane_arg *a = (const lane_arg *)arg;
+    a->lanes->run_lane(a->lane);
+    return nullptr;
+}
+
+void NavEKF3_Lanes::run_lane(uint8_t lane)
+{
+    uint32_t seen = frame.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t f;
+        for (uint16_t i=0; (f = frame.load(std::memory_order_acquire)) == seen && i<LANE_SPIN_COUNT; i++) {
+        }
+        if (f == seen) {
+            pthread_mutex_lock(&mutex);
+            while ((f = frame.load(std::memory_order_acquire)) == seen) {
+                pthread_cond_wait(&cond, &mutex);
+            }
+            pthread_mutex_unlock(&mutex);
+        }
+        seen = f;
+        if (quit.load()) {
+            return;
+        }
+        core[lane].UpdateFilter(allow[lane]);
+        done[lane].store(f, std::memory_order_release);
+    }
+}
+
+void NavEKF3_Lanes::wait_for_lane(uint8_t lane) const
+{
+    const uint32_t f = frame.load(std::memory_order_relaxed);
+    for (uint32_t i=0; done[lane].load(std::memory_order_acquire) != f; i++) {
+        if (i >= LANE_SPIN_COUNT) {
+            sched_yield();
+        }
+    }
+}
+
+void NavEKF3_Lanes::update(const bool allow_state_prediction[])
+{
+    for (uint8_t i=0; i<num_lanes; i++) {
+        allow[i] = allow_state_prediction[i];
+    }
+    in_frame.store(true, std::memory_order_relaxed);
+
+    pthread_mutex_lock(&mutex);
+    const uint32_t f = frame.load(std::memory_order_relaxed) + 1;
+    frame.store(f, std::memory_order_release);
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+
+    core[0].UpdateFilter(allow[0]);
+    done[0].store(f, std::memory_order_release);
+
+    for (uint8_t i=1; i<num_lanes; i++) {
+        wait_for_lane(i);
+    }
+    in_frame.store(false, std::memory_order_relaxed);
+}
+
+void NavEKF3_Lanes::wait_for_lower(uint8_t core_index) const
+{
+    if (!in_frame.load(std::memory_order_relaxed)) {
+        return;
+    }
+    for (uint8_t i=0; i<core_index && i<num_lanes; i++) {
+        wait_for_lane(i);
+    }
+}
+
+#endif // EK3_FEATURE_PARALLEL_LANES
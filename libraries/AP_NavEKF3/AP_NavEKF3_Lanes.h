@@ -0,0 +1,95 @@
+/*
+  run the UpdateFilter step of each EKF3 core on its own thread
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_NavEKF3_feature.h"
+
+#if EK3_FEATURE_PARALLEL_LANES
+
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
+#include <atomic>
+#include <pthread.h>
+
+#if !EKF_SCRATCH_THREAD_LOCAL
+#error "parallel EKF3 lanes need thread local EKF scratch space"
+#endif
+
+#include "AP_NavEKF3.h"
+
+/*
+  Each frame (one NavEKF3::UpdateFilter call, between AP_DAL
+  start_frame and end_frame) the calling thread releases the lane
+  threads, updates core 0 itself and then waits for every core to
+  finish before the frontend carries on. Cores are otherwise
+  independent; the few places where a core touches state shared with
+  other cores call wait_for_lower() first, which makes them happen in
+  core order exactly as in a serial update.
+ */
+class NavEKF3_Lanes {
+public:
+    NavEKF3_Lanes() {}
+    ~NavEKF3_Lanes();
+
+    CLASS_NO_COPY(NavEKF3_Lanes);
+
+    // start one thread for each core after the first
+    bool start(NavEKF3_core *core, uint8_t num_cores);
+
+    // stop and join the lane threads
+    void stop();
+
+    bool running() const { return num_lanes > 0; }
+
+    // run UpdateFilter on every core and return when all have finished
+    void update(const bool allow_state_prediction[]);
+
+    // block until every core below core_index has finished the
+    // current frame. Returns immediately outside update()
+    void wait_for_lower(uint8_t core_index) const;
+
+private:
+    static void *thread_main(void *arg);
+    void run_lane(uint8_t lane);
+
+    // wait for done[lane] to reach the current frame
+    void wait_for_lane(uint8_t lane) const;
+
+    struct lane_arg {
+        NavEKF3_Lanes *lanes;
+        uint8_t lane;
+    };
+
+    NavEKF3_core *core = nullptr;
+    uint8_t num_lanes = 0;
+
+    pthread_t threads[MAX_EKF_CORES];
+    lane_arg args[MAX_EKF_CORES];
+    bool allow[MAX_EKF_CORES];
+
+    // frame is bumped to release the lanes, each lane sets its done
+    // entry to the frame number when its core is finished
+    std::atomic<uint32_t> frame {0};
+    std::atomic<uint32_t> done[MAX_EKF_CORES] {};
+    std::atomic<bool> in_frame {false};
+    std::atomic<bool> quit {false};
+
+    // idle lanes sleep here once they have spun for a while
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+};
+
+#endif // EK3_FEATURE_PARALLEL_LANES
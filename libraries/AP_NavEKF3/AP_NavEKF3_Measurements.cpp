@@ -1395,6 +1395,8 @@ void NavEKF3_core::updateMovementCheck(void)
     if (logStatusChange || imuSampleTime_ms - lastMoveCheckLogTime_ms > 200) {
         lastMoveCheckLogTime_ms = imuSampleTime_ms;
 #if HAL_LOGGING_ENABLED
+        // keep the log order of the cores fixed
+        frontend->wait_lower_cores(core_index);
         const struct log_XKFM pkt{
             LOG_PACKET_HEADER_INIT(LOG_XKFM_MSG),
             time_us            : dal.micros64(),
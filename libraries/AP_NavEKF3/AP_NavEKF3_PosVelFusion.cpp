@@ -399,6 +399,7 @@ void NavEKF3_core::CorrectExtNavForSensorOffset(ext_nav_elements &ext_nav_data)
     ext_nav_data.corrected = true;
 
     // external nav data is against the public_origin, so convert to offset from EKF_origin
+    frontend->wait_lower_cores(core_index);
     ext_nav_data.pos.xy() += EKF_origin.get_distance_NE_ftype(public_origin);
 
 #if HAL_VISUALODOM_ENABLED
@@ -984,9 +984,7 @@ void NavEKF3_core::calcOutputStates()
 }
 
 /*
- * Calculate the predicted state covariance matrix using algebraic equations generated using SymPy
- * See AP_NavEKF3/derivation/main.py for derivation
- * Output for change reference: AP_NavEKF3/derivation/generated/covariance_generated.cpp
+ * Calculate the predicted state covariance matrix, see predictCovariance() for the prediction itself
  * Argument rotVarVecPtr is pointer to a vector defining the earth frame uncertainty variance of the quaternion states
  * used to perform a reset of the quaternion state covariances only. Set to null for normal operation.
 */
@@ -995,25 +993,6 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
     ftype daxVar;       // X axis delta angle noise variance rad^2
     ftype dayVar;       // Y axis delta angle noise variance rad^2
     ftype dazVar;       // Z axis delta angle noise variance rad^2
-    ftype dvxVar;       // X axis delta velocity variance noise (m/s)^2
-    ftype dvyVar;       // Y axis delta velocity variance noise (m/s)^2
-    ftype dvzVar;       // Z axis delta velocity variance noise (m/s)^2
-    ftype dvx;          // X axis delta velocity (m/s)
-    ftype dvy;          // Y axis delta velocity (m/s)
-    ftype dvz;          // Z axis delta velocity (m/s)
-    ftype dax;          // X axis delta angle (rad)
-    ftype day;          // Y axis delta angle (rad)
-    ftype daz;          // Z axis delta angle (rad)
-    ftype q0;           // attitude quaternion
-    ftype q1;           // attitude quaternion
-    ftype q2;           // attitude quaternion
-    ftype q3;           // attitude quaternion
-    ftype dax_b;        // X axis delta angle measurement bias (rad)
-    ftype day_b;        // Y axis delta angle measurement bias (rad)
-    ftype daz_b;        // Z axis delta angle measurement bias (rad)
-    ftype dvx_b;        // X axis delta velocity measurement bias (rad)
-    ftype dvy_b;        // Y axis delta velocity measurement bias (rad)
-    ftype dvz_b;        // Z axis delta velocity measurement bias (rad)
 
     // Calculate the time step used by the covariance prediction as an average of the gyro and accel integration period
     // Constrain to prevent bad timing jitter causing numerical conditioning problems with the covariance prediction
@@ -1093,24 +1072,6 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
         }
     }
 
-    // set variables used to calculate covariance growth
-    dvx = imuDataDelayed.delVel.x;
-    dvy = imuDataDelayed.delVel.y;
-    dvz = imuDataDelayed.delVel.z;
-    dax = imuDataDelayed.delAng.x;
-    day = imuDataDelayed.delAng.y;
-    daz = imuDataDelayed.delAng.z;
-    q0 = stateStruct.quat[0];
-    q1 = stateStruct.quat[1];
-    q2 = stateStruct.quat[2];
-    q3 = stateStruct.quat[3];
-    dax_b = stateStruct.gyro_bias.x;
-    day_b = stateStruct.gyro_bias.y;
-    daz_b = stateStruct.gyro_bias.z;
-    dvx_b = stateStruct.accel_bias.x;
-    dvy_b = stateStruct.accel_bias.y;
-    dvz_b = stateStruct.accel_bias.z;
-
     bool quatCovResetOnly = false;
     if (rotVarVecPtr != nullptr) {
         // Handle special case where we are initialising the quaternion covariances using an earth frame
@@ -1136,7 +1097,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
         daxVar = dayVar = dazVar = sq(dt*_gyrNoise);
     }
     ftype _accNoise = badIMUdata ? BAD_IMU_DATA_ACC_P_NSE : constrain_ftype(frontend->_accNoise, 0.0f, BAD_IMU_DATA_ACC_P_NSE);
-    dvxVar = dvyVar = dvzVar = sq(dt*_accNoise);
+    const ftype dVelVar = sq(dt*_accNoise);   // delta velocity variance noise (m/s)^2
 
     if (!inhibitDelVelBiasStates) {
         for (uint8_t stateIndex = 13; stateIndex <= 15; stateIndex++) {
@@ -1156,6 +1117,86 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
         }
     }
 
+    // calculate the predicted covariance due to inertial sensor error propagation, using the
+    // kernel for the states that are active
+    const Vector3F dAngVar {daxVar, dayVar, dazVar};
+#if EK3_FEATURE_COVARIANCE_KERNELS
+    switch (stateIndexLim) {
+    case 9:
+        predictCovariance<9>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+        break;
+    case 12:
+        predictCovariance<12>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+        break;
+    case 15:
+        predictCovariance<15>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+        break;
+    case 21:
+        predictCovariance<21>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+        break;
+    default:
+        predictCovariance<23>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+        break;
+    }
+#else
+    predictCovariance<0>(processNoiseVariance, dAngVar, dVelVar, quatCovResetOnly);
+#endif
+
+    if (quatCovResetOnly) {
+        calcTiltErrorVariance();
+        return;
+    }
+
+    // constrain values to prevent ill-conditioning
+    ConstrainVariances();
+
+    if (vertVelVarClipCounter > 0) {
+        vertVelVarClipCounter--;
+    }
+
+    calcTiltErrorVariance();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    verifyTiltErrorVariance();
+#endif
+}
+
+/*
+ * Predict the covariance of states 0 to stateLim using algebraic equations generated using SymPy
+ * See AP_NavEKF3/derivation/main.py for derivation
+ * Output for change reference: AP_NavEKF3/derivation/generated/covariance_generated.cpp
+ * kernelLim is the value of stateIndexLim. Each value has its own kernel so the covariances of inhibited states,
+ * and the intermediate terms only they use, are removed at compile time rather than tested for every prediction.
+ * A kernelLim of zero gives a single kernel which tests stateIndexLim instead, see EK3_FEATURE_COVARIANCE_KERNELS.
+ * If quatCovResetOnly is true only the quaternion covariances are updated.
+*/
+template <uint8_t kernelLim>
+void NavEKF3_core::predictCovariance(const Vector14 &processNoiseVariance, const Vector3F &dAngVar, ftype dVelVar, bool quatCovResetOnly)
+{
+    const uint8_t stateLim = (kernelLim != 0) ? kernelLim : stateIndexLim;
+    const ftype daxVar = dAngVar.x;     // X axis delta angle noise variance rad^2
+    const ftype dayVar = dAngVar.y;     // Y axis delta angle noise variance rad^2
+    const ftype dazVar = dAngVar.z;     // Z axis delta angle noise variance rad^2
+    const ftype dvxVar = dVelVar;       // X axis delta velocity variance noise (m/s)^2
+    const ftype dvyVar = dVelVar;       // Y axis delta velocity variance noise (m/s)^2
+    const ftype dvzVar = dVelVar;       // Z axis delta velocity variance noise (m/s)^2
+    const ftype dvx = imuDataDelayed.delVel.x;      // X axis delta velocity (m/s)
+    const ftype dvy = imuDataDelayed.delVel.y;      // Y axis delta velocity (m/s)
+    const ftype dvz = imuDataDelayed.delVel.z;      // Z axis delta velocity (m/s)
+    const ftype dax = imuDataDelayed.delAng.x;      // X axis delta angle (rad)
+    const ftype day = imuDataDelayed.delAng.y;      // Y axis delta angle (rad)
+    const ftype daz = imuDataDelayed.delAng.z;      // Z axis delta angle (rad)
+    const ftype q0 = stateStruct.quat[0];           // attitude quaternion
+    const ftype q1 = stateStruct.quat[1];           // attitude quaternion
+    const ftype q2 = stateStruct.quat[2];           // attitude quaternion
+    const ftype q3 = stateStruct.quat[3];           // attitude quaternion
+    const ftype dax_b = stateStruct.gyro_bias.x;    // X axis delta angle measurement bias (rad)
+    const ftype day_b = stateStruct.gyro_bias.y;    // Y axis delta angle measurement bias (rad)
+    const ftype daz_b = stateStruct.gyro_bias.z;    // Z axis delta angle measurement bias (rad)
+    const ftype dvx_b = stateStruct.accel_bias.x;   // X axis delta velocity measurement bias (rad)
+    const ftype dvy_b = stateStruct.accel_bias.y;   // Y axis delta velocity measurement bias (rad)
+    const ftype dvz_b = stateStruct.accel_bias.z;   // Z axis delta velocity measurement bias (rad)
+
     // calculate the predicted covariance due to inertial sensor error propagation
     // we calculate the lower diagonal and copy to take advantage of symmetry
 
@@ -1406,7 +1447,6 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
                 P[row][column] = P[column][row] = nextP[column][row];
             }
         }
-        calcTiltErrorVariance();
         return;
     }
 
@@ -1456,7 +1496,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
     nextP[8][9] = P[5][9]*dt + P[8][9] + dt*(P[5][6]*dt + P[6][8]);
     nextP[9][9] = P[6][9]*dt + P[9][9] + dt*(P[6][6]*dt + P[6][9]);
 
-    if (stateIndexLim > 9) {
+    if (stateLim > 9) {
         nextP[0][10] = PS14;
         nextP[1][10] = PS105;
         nextP[2][10] = PS133;
@@ -1494,7 +1534,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
         nextP[11][12] = P[11][12];
         nextP[12][12] = P[12][12];
 
-        if (stateIndexLim > 12) {
+        if (stateLim > 12) {
             nextP[0][13] = PS44;
             nextP[1][13] = PS113;
             nextP[2][13] = PS138;
@@ -1541,7 +1581,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
             nextP[14][15] = P[14][15];
             nextP[15][15] = P[15][15];
 
-            if (stateIndexLim > 15) {
+            if (stateLim > 15) {
                 nextP[0][16] = -PS11*P[1][16] - PS12*P[2][16] - PS13*P[3][16] + PS6*P[10][16] + PS7*P[11][16] + PS9*P[12][16] + P[0][16];
                 nextP[1][16] = PS11*P[0][16] - PS12*P[3][16] + PS13*P[2][16] - PS34*P[10][16] - PS7*P[12][16] + PS9*P[11][16] + P[1][16];
                 nextP[2][16] = PS11*P[3][16] + PS12*P[0][16] - PS13*P[1][16] - PS34*P[11][16] + PS6*P[12][16] - PS9*P[10][16] + P[2][16];
@@ -1660,7 +1700,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
                 nextP[20][21] = P[20][21];
                 nextP[21][21] = P[21][21];
 
-                if (stateIndexLim > 21) {
+                if (stateLim > 21) {
                     nextP[0][22] = -PS11*P[1][22] - PS12*P[2][22] - PS13*P[3][22] + PS6*P[10][22] + PS7*P[11][22] + PS9*P[12][22] + P[0][22];
                     nextP[1][22] = PS11*P[0][22] - PS12*P[3][22] + PS13*P[2][22] - PS34*P[10][22] - PS7*P[12][22] + PS9*P[11][22] + P[1][22];
                     nextP[2][22] = PS11*P[3][22] + PS12*P[0][22] - PS13*P[1][22] - PS34*P[11][22] + PS6*P[12][22] - PS9*P[10][22] + P[2][22];
@@ -1714,8 +1754,8 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
     }
 
     // add the general state process noise variances
-    if (stateIndexLim > 9) {
-        for (uint8_t i=10; i<=stateIndexLim; i++) {
+    if (stateLim > 9) {
+        for (uint8_t i=10; i<=stateLim; i++) {
             nextP[i][i] = nextP[i][i] + processNoiseVariance[i-10];
         }
     }
@@ -1739,7 +1779,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
     if ((P[7][7] + P[8][8]) > 1e4f) {
         for (uint8_t i=7; i<=8; i++)
         {
-            for (uint8_t j=0; j<=stateIndexLim; j++)
+            for (uint8_t j=0; j<=stateLim; j++)
             {
                 nextP[i][j] = P[i][j];
                 nextP[j][i] = P[j][i];
@@ -1749,7 +1789,7 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
 
     // covariance matrix is symmetrical, so copy diagonals and copy lower half in nextP
     // to lower and upper half in P
-    for (uint8_t row = 0; row <= stateIndexLim; row++) {
+    for (uint8_t row = 0; row <= stateLim; row++) {
         // copy diagonals
         P[row][row] = nextP[row][row];
         // copy off diagonals
@@ -1757,19 +1797,6 @@ void NavEKF3_core::CovariancePrediction(Vector3F *rotVarVecPtr)
             P[row][column] = P[column][row] = nextP[column][row];
         }
     }
-
-    // constrain values to prevent ill-conditioning
-    ConstrainVariances();
-
-    if (vertVelVarClipCounter > 0) {
-        vertVelVarClipCounter--;
-    }
-
-    calcTiltErrorVariance();
-
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-    verifyTiltErrorVariance();
-#endif
 }
 
 // zero specified range of rows in the state covariance matrix
@@ -2178,6 +2205,8 @@ void NavEKF3_core::verifyTiltErrorVariance()
     tiltErrorVarianceAlt = MIN(tiltErrorVarianceAlt, sq(radians(30.0f)));
     if (imuSampleTime_ms - lastLogTime_ms > 500) {
         lastLogTime_ms = imuSampleTime_ms;
+        // keep the XKTV order across cores the same as a serial update
+        frontend->wait_lower_cores(core_index);
         const struct log_XKTV msg {
             LOG_PACKET_HEADER_INIT(LOG_XKTV_MSG),
             time_us      : dal.micros64(),
@@ -2199,6 +2228,7 @@ void NavEKF3_core::verifyTiltErrorVariance()
 void NavEKF3_core::moveEKFOrigin(void)
 {
     // only move origin when we have a origin and we're using GPS
+    frontend->wait_lower_cores(core_index);
     if (!frontend->common_origin_valid || !filterStatus.flags.using_gps) {
         return;
     }
@@ -123,6 +123,9 @@
 
 class NavEKF3_core : public NavEKF_core_common
 {
+    friend class NavEKF3_Benchmark;
+    friend class NavEKF3_Test;
+
 public:
     // Constructor
     NavEKF3_core(class NavEKF3 *_frontend);
@@ -692,6 +695,11 @@ private:
     // used to perform a reset of the quaternion state covariances only. Set to null for normal operation.
     void CovariancePrediction(Vector3F *rotVarVecPtr);
 
+    // predict the covariance of states 0 to kernelLim, which must equal stateIndexLim, or
+    // to stateIndexLim tested at run time if kernelLim is zero
+    template <uint8_t kernelLim>
+    void predictCovariance(const Vector14 &processNoiseVariance, const Vector3F &dAngVar, ftype dVelVar, bool quatCovResetOnly);
+
     // force symmetry on the state covariance matrix
     void ForceSymmetry();
 
@@ -35,3 +35,15 @@
 #ifndef EK3_FEATURE_POSITION_RESET
 #define EK3_FEATURE_POSITION_RESET EK3_FEATURE_ALL || AP_AHRS_POSITION_RESET_ENABLED
 #endif
+
+// updating each core on its own thread, for Replay on desktop builds
+#ifndef EK3_FEATURE_PARALLEL_LANES
+#define EK3_FEATURE_PARALLEL_LANES APM_BUILD_TYPE(APM_BUILD_Replay) && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// a covariance prediction kernel for each set of active states rather
+// than one which tests the state limit at run time. Faster with fewer
+// states, but costs flash, so only on desktop and 2M boards
+#ifndef EK3_FEATURE_COVARIANCE_KERNELS
+#define EK3_FEATURE_COVARIANCE_KERNELS CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || BOARD_FLASH_SIZE > 1024
+#endif
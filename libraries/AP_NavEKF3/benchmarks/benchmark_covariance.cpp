@@ -0,0 +1,101 @@
+/*
+ * Time one covariance prediction step of EKF3 for each set of active states.
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class NavEKF3_Benchmark {
+public:
+    // set up the core as if it were flying at the EKF target rate with the
+    // states up to state_index_lim active, starting from a well conditioned covariance
+    static void setup(NavEKF3_core &core, uint8_t state_index_lim);
+
+    // run one covariance prediction
+    static void predict(NavEKF3_core &core) {
+        core.CovariancePrediction(nullptr);
+    }
+
+    // returns true if the covariance is still finite and symmetric
+    static bool covariance_ok(const NavEKF3_core &core);
+};
+
+void NavEKF3_Benchmark::setup(NavEKF3_core &core, uint8_t state_index_lim)
+{
+    // the inhibit flags which give each value of stateIndexLim
+    core.inhibitDelAngBiasStates = state_index_lim < 12;
+    core.inhibitDelVelBiasStates = state_index_lim < 15;
+    core.inhibitMagStates = state_index_lim < 21;
+    core.inhibitWindStates = state_index_lim < 23;
+    core.lastInhibitMagStates = core.inhibitMagStates;
+    core.updateStateIndexLim();
+
+    core.dtEkfAvg = EKF_TARGET_DT;
+    core.imuDataDelayed.delAngDT = EKF_TARGET_DT;
+    core.imuDataDelayed.delVelDT = EKF_TARGET_DT;
+    core.imuDataDelayed.delAng = Vector3F(0.001, 0.002, -0.0015);
+    core.imuDataDelayed.delVel = Vector3F(0.01, -0.02, -GRAVITY_MSS * EKF_TARGET_DT);
+    core.stateStruct.quat.from_euler(0.1, -0.2, 1.0);
+    core.stateStruct.gyro_bias = Vector3F(1e-5, -2e-5, 3e-5);
+    core.stateStruct.accel_bias = Vector3F(1e-3, -2e-3, 3e-3);
+    core.onGround = false;
+
+    // small fixed correlations so no covariance is trivially zero
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            core.P[i][j] = core.P[j][i] = (i + j) % 2 ? 1e-6 : -1e-6;
+        }
+        core.P[i][i] = 1e-3 * (1 + i % 4);
+    }
+}
+
+bool NavEKF3_Benchmark::covariance_ok(const NavEKF3_core &core)
+{
+    for (uint8_t i = 0; i <= core.stateIndexLim; i++) {
+        for (uint8_t j = 0; j <= i; j++) {
+            if (isnan(core.P[i][j]) || isinf(core.P[i][j]) || !is_equal(core.P[i][j], core.P[j][i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static NavEKF3 ekf;
+static NavEKF3_core core {&ekf};
+
+static void BM_CovariancePrediction(benchmark::State& state)
+{
+    NavEKF3_Benchmark::setup(core, state.range(0));
+
+    while (state.KeepRunning()) {
+        NavEKF3_Benchmark::predict(core);
+        gbenchmark_escape(&core);
+    }
+
+    if (!NavEKF3_Benchmark::covariance_ok(core)) {
+        state.SkipWithError("covariance not finite and symmetric");
+    }
+}
+
+/* Attitude, velocity and position only, then adding gyro bias, accel bias,
+ * magnetic field and wind states */
+BENCHMARK(BM_CovariancePrediction)->Arg(9)->Arg(12)->Arg(15)->Arg(21)->Arg(23);
+
+BENCHMARK_MAIN();
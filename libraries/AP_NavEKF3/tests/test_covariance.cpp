@@ -0,0 +1,112 @@
+/*
+ * Check each reduced state covariance prediction kernel of EKF3 against
+ * the full 24-state kernel.
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class NavEKF3_Test {
+public:
+    // set up the core as if it were flying with the states up to
+    // state_index_lim active. The covariances of the inactive states
+    // are zero, as ConstrainVariances() leaves them
+    static void setup(NavEKF3_core &core, uint8_t state_index_lim);
+
+    // run one covariance prediction, using the kernel for kernel_lim
+    // rather than the one for the active states
+    static void predict(NavEKF3_core &core, uint8_t kernel_lim, Vector3F *rotVarVecPtr) {
+        core.stateIndexLim = kernel_lim;
+        core.CovariancePrediction(rotVarVecPtr);
+    }
+
+    static ftype P(const NavEKF3_core &core, uint8_t i, uint8_t j) {
+        return core.P[i][j];
+    }
+};
+
+void NavEKF3_Test::setup(NavEKF3_core &core, uint8_t state_index_lim)
+{
+    // the inhibit flags which give each value of stateIndexLim
+    core.inhibitDelAngBiasStates = state_index_lim < 12;
+    core.inhibitDelVelBiasStates = state_index_lim < 15;
+    core.inhibitMagStates = state_index_lim < 21;
+    core.inhibitWindStates = state_index_lim < 23;
+    core.lastInhibitMagStates = core.inhibitMagStates;
+    core.updateStateIndexLim();
+
+    core.dtEkfAvg = EKF_TARGET_DT;
+    core.imuDataDelayed.delAngDT = EKF_TARGET_DT;
+    core.imuDataDelayed.delVelDT = EKF_TARGET_DT;
+    core.imuDataDelayed.delAng = Vector3F(0.001, 0.002, -0.0015);
+    core.imuDataDelayed.delVel = Vector3F(0.01, -0.02, -GRAVITY_MSS * EKF_TARGET_DT);
+    core.stateStruct.quat.from_euler(0.1, -0.2, 1.0);
+    core.stateStruct.gyro_bias = Vector3F(1e-5, -2e-5, 3e-5);
+    core.stateStruct.accel_bias = Vector3F(1e-3, -2e-3, 3e-3);
+    core.onGround = false;
+
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j <= i; j++) {
+            ftype p = 0;
+            if (i <= state_index_lim) {
+                p = (i == j) ? 1e-3 * (1 + i % 4) : ((i + j) % 2 ? 1e-6 : -1e-6);
+            }
+            core.P[i][j] = core.P[j][i] = p;
+        }
+    }
+}
+
+static NavEKF3 ekf;
+static NavEKF3_core reduced {&ekf};
+static NavEKF3_core full {&ekf};
+
+static void check_kernel(uint8_t state_index_lim, bool quat_reset_only)
+{
+    Vector3F rot_var_reduced {1e-4, 2e-4, 3e-4};
+    Vector3F rot_var_full = rot_var_reduced;
+
+    NavEKF3_Test::setup(reduced, state_index_lim);
+    NavEKF3_Test::setup(full, state_index_lim);
+    NavEKF3_Test::predict(reduced, state_index_lim, quat_reset_only ? &rot_var_reduced : nullptr);
+    NavEKF3_Test::predict(full, 23, quat_reset_only ? &rot_var_full : nullptr);
+
+    for (uint8_t i = 0; i <= state_index_lim; i++) {
+        for (uint8_t j = 0; j <= state_index_lim; j++) {
+            const ftype expected = NavEKF3_Test::P(full, i, j);
+            EXPECT_NEAR(NavEKF3_Test::P(reduced, i, j), expected, 1e-6 * fabsF(expected) + 1e-12)
+                << "lim " << unsigned(state_index_lim) << " P[" << unsigned(i) << "][" << unsigned(j) << "]";
+        }
+    }
+}
+
+TEST(NavEKF3_Covariance, reduced_kernels)
+{
+    for (const uint8_t lim : {9, 12, 15, 21}) {
+        check_kernel(lim, false);
+    }
+}
+
+TEST(NavEKF3_Covariance, reduced_kernels_quat_reset)
+{
+    for (const uint8_t lim : {9, 12, 15, 21}) {
+        check_kernel(lim, true);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -24,6 +24,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_Proximity_Params.h"
 #include "AP_Proximity_Boundary_3D.h"
+#include "AP_Proximity_PointCloud.h"
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 #include <AP_HAL/Semaphores.h>
@@ -134,14 +135,24 @@ public:
     bool get_horizontal_distances(Proximity_Distance_Array &prx_dist_array) const;
 
     // get total number of obstacles, used in GPS based Simple Avoidance
-    uint8_t get_obstacle_count() const;
+    uint16_t get_obstacle_count() const;
+
+    // get the first obstacle_num at or after the passed one which may hold a valid obstacle, used in GPS based Simple Avoidance
+    // returns get_obstacle_count() if there are no more obstacles
+    uint16_t get_next_obstacle(uint16_t obstacle_num) const;
 
     // get vector to obstacle based on obstacle_num passed, used in GPS based Simple Avoidance
-    bool get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const;
+    bool get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const;
 
     // returns shortest distance to "obstacle_num" obstacle, from a line segment formed between "seg_start" and "seg_end"
     // returns FLT_MAX if it's an invalid instance.
-    bool closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
+    bool closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // get vector to the closest return in the point cloud within max_distance_m, in the same frame and units as get_obstacle
+    // returns near the ground are ignored as for the boundary, used in GPS based Simple Avoidance
+    bool get_closest_pointcloud_obstacle(float max_distance_m, Vector3f& vec_to_obstacle) const;
+#endif
 
     // get distance and angle to closest object (used for pre-arm check)
     //   returns true on success, false if no valid readings
@@ -152,7 +163,7 @@ public:
     bool get_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const;
 
     // get obstacle pitch and angle for a particular obstacle num
-    bool get_obstacle_info(uint8_t obstacle_num, float &angle_deg, float &pitch, float &distance) const;
+    bool get_obstacle_info(uint16_t obstacle_num, float &angle_deg, float &pitch, float &distance) const;
 
     //
     // mavlink related methods
@@ -201,6 +212,11 @@ public:
     // 3D boundary
     AP_Proximity_Boundary_3D boundary;
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // voxel grid of recent returns from all sensors
+    AP_Proximity_PointCloud pointcloud;
+#endif
+
     // Check if Obstacle defined by body-frame yaw and pitch is near ground
     bool check_obstacle_near_ground(float pitch, float yaw, float distance) const;
 
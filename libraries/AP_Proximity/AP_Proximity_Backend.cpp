@@ -70,21 +70,28 @@ bool AP_Proximity_Backend::ignore_reading(float pitch, float yaw, float distance
         }
     }
 
-    if (check_for_ign_area) {
-        // check angle vs each ignore area
-        for (uint8_t i=0; i < PROXIMITY_MAX_IGNORE; i++) {
-            if (params.ignore_width_deg[i] != 0) {
-                if (abs(yaw - params.ignore_angle_deg[i]) <= (params.ignore_width_deg[i]/2)) {
-                    return true;
-                }
-            }
-        }
+    if (check_for_ign_area && in_ignore_area(yaw)) {
+        return true;
     }
 
    // check if obstacle is near land
    return frontend.check_obstacle_near_ground(pitch, yaw, distance_m);
 }
 
+// returns true if the body-frame yaw (in degrees) falls into one of the ignore areas
+bool AP_Proximity_Backend::in_ignore_area(float yaw) const
+{
+    // check angle vs each ignore area
+    for (uint8_t i=0; i < PROXIMITY_MAX_IGNORE; i++) {
+        if (params.ignore_width_deg[i] != 0) {
+            if (abs(yaw - params.ignore_angle_deg[i]) <= (params.ignore_width_deg[i]/2)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // returns true if database is ready to be pushed to and all cached data is ready
 bool AP_Proximity_Backend::database_prepare_for_push(Vector3f &current_pos, Matrix3f &body_to_ned)
 {
@@ -145,4 +152,26 @@ void AP_Proximity_Backend::database_push(float angle, float pitch, float distanc
 #endif  // AP_OADATABASE_ENABLED
 }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+// add a reading to the point cloud. angle and pitch are the body-frame yaw and pitch in degrees, distance is in meters
+void AP_Proximity_Backend::pointcloud_push(float angle, float pitch, float distance)
+{
+    if ((pitch > 90.0f) || (pitch < -90.0f) || in_ignore_area(angle)) {
+        return;
+    }
+    Vector3f point_frd;
+    point_frd.offset_bearing(wrap_180(angle), (pitch * -1.0f), distance);
+    frontend.pointcloud.add_point_body(point_frd);
+}
+
+// add a body-frame (FRD) reading in meters to the point cloud
+void AP_Proximity_Backend::pointcloud_push(const Vector3f &point_frd)
+{
+    if (in_ignore_area(wrap_360(degrees(atan2f(point_frd.y, point_frd.x))))) {
+        return;
+    }
+    frontend.pointcloud.add_point_body(point_frd);
+}
+#endif  // AP_PROXIMITY_POINTCLOUD_ENABLED
+
 #endif // HAL_PROXIMITY_ENABLED
@@ -71,6 +71,9 @@ protected:
     bool ignore_reading(float pitch, float yaw, float distance_m, bool check_for_ign_area = true) const;
     bool ignore_reading(float yaw, float distance_m, bool check_for_ign_area = true) const { return ignore_reading(0.0f, yaw, distance_m, check_for_ign_area); }
 
+    // returns true if the body-frame yaw (in degrees) falls into one of the ignore areas
+    bool in_ignore_area(float yaw) const;
+
     // database helpers. All angles are in degrees
     static bool database_prepare_for_push(Vector3f &current_pos, Matrix3f &body_to_ned);
     // Note: "angle" refers to yaw (in body frame) towards the obstacle
@@ -84,6 +87,14 @@ protected:
     };
     static void database_push(float angle, float pitch, float distance, uint32_t timestamp_ms, const Vector3f &current_pos, const Matrix3f &body_to_ned);
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // point cloud helpers. Unlike the boundary and database, readings near the ground are kept so the ground can be found
+    // callers should check the distance is within the sensor's range
+    void pointcloud_push(float angle, float pitch, float distance);
+    void pointcloud_push(float angle, float distance) { pointcloud_push(angle, 0.0f, distance); }
+    void pointcloud_push(const Vector3f &point_frd);
+#endif
+
     // semaphore for access to shared frontend data
     HAL_Semaphore _sem;
 
@@ -28,13 +28,12 @@ AP_Proximity_Boundary_3D::AP_Proximity_Boundary_3D()
 }
 
 // initialise the boundary and sector_edge_vector array used for object avoidance
-//   should be called if the sector_middle_deg or _sector_width_deg arrays are changed
 void AP_Proximity_Boundary_3D::init()
 {
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        const float pitch = ((float)_pitch_middle_deg[layer]);
+        const float pitch = get_pitch_middle_deg(layer);
         for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float angle_rad = ((float)_sector_middle_deg[sector]+(PROXIMITY_SECTOR_WIDTH_DEG/2.0f));
+            const float angle_rad = get_sector_middle_deg(sector)+(PROXIMITY_SECTOR_WIDTH_DEG/2.0f);
             _sector_edge_vector[layer][sector].offset_bearing(angle_rad, pitch, 100.0f);
             _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * PROXIMITY_BOUNDARY_DIST_DEFAULT;
         }
@@ -46,9 +45,10 @@ void AP_Proximity_Boundary_3D::init()
 // yaw is the horizontal body-frame angle (in degrees) to the obstacle (0=directly ahead of the vehicle, 90 is to the right of the vehicle)
 AP_Proximity_Boundary_3D::Face AP_Proximity_Boundary_3D::get_face(float pitch, float yaw) const
 {
-    const uint8_t sector = wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / 45.0f;
-    const float pitch_limited = constrain_float(pitch, -75.0f, 74.9f);
-    const uint8_t layer = (pitch_limited + 75.0f)/PROXIMITY_PITCH_WIDTH_DEG;
+    // MIN protects against rounding up to PROXIMITY_NUM_SECTORS when yaw is just short of 360
+    const uint8_t sector = MIN(wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / PROXIMITY_SECTOR_WIDTH_DEG, PROXIMITY_NUM_SECTORS - 1);
+    const float pitch_limited = constrain_float(pitch, -PROXIMITY_PITCH_MAX_DEG, PROXIMITY_PITCH_MAX_DEG - 0.1f);
+    const uint8_t layer = (pitch_limited + PROXIMITY_PITCH_MAX_DEG)/PROXIMITY_PITCH_WIDTH_DEG;
     return Face{layer, sector};
 }
 
@@ -75,7 +75,7 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     _angle[face.layer][face.sector] = angle;
     _pitch[face.layer][face.sector] = pitch;
     _distance[face.layer][face.sector] = distance;
-    _distance_valid[face.layer][face.sector] = true;
+    set_distance_valid(face.layer, face.sector, true);
     _prx_instance[face.layer][face.sector] = prx_instance;
 
     // apply filter
@@ -178,6 +178,21 @@ void AP_Proximity_Boundary_3D::reset()
         for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
             _distance_valid[layer][sector] = false;
         }
+        _num_valid_faces[layer] = 0;
+    }
+}
+
+// mark a face's distance as valid or invalid, keeping count of the valid faces in each layer
+void AP_Proximity_Boundary_3D::set_distance_valid(uint8_t layer, uint8_t sector, bool valid)
+{
+    if (_distance_valid[layer][sector] == valid) {
+        return;
+    }
+    _distance_valid[layer][sector] = valid;
+    if (valid) {
+        _num_valid_faces[layer]++;
+    } else {
+        _num_valid_faces[layer]--;
     }
 }
 
@@ -203,7 +218,7 @@ void AP_Proximity_Boundary_3D::reset_face(const Face &face, uint8_t prx_instance
         }
     }
 
-    _distance_valid[face.layer][face.sector] = false;
+    set_distance_valid(face.layer, face.sector, false);
 
     // update simple avoidance boundary
     update_boundary(face);
@@ -220,11 +235,11 @@ void AP_Proximity_Boundary_3D::check_face_timeout()
     _last_check_face_timeout_ms = now_ms;
 
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        for (uint8_t sector=0; (sector < PROXIMITY_NUM_SECTORS) && (_num_valid_faces[layer] > 0); sector++) {
             if (_distance_valid[layer][sector]) {
                 if ((now_ms - _last_update_ms[layer][sector]) > PROXIMITY_FACE_RESET_MS) {
                     // this face has a valid distance but wasn't updated for a long time, reset it
-                    _distance_valid[layer][sector] = false;
+                    set_distance_valid(layer, sector, false);
                     update_boundary(AP_Proximity_Boundary_3D::Face{layer, sector});
                 }
             }
@@ -247,18 +262,44 @@ bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) c
 }
 
 // get the total number of obstacles 
-uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
+uint16_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 {
     return PROXIMITY_NUM_LAYERS * PROXIMITY_NUM_SECTORS;
 }
 
+// Returns the first obstacle_num at or after the passed one which may produce a valid obstacle
+// Layers without any valid faces are skipped so avoidance only walks the populated parts of the boundary
+// get_obstacle_count() is returned if there are no more obstacles
+uint16_t AP_Proximity_Boundary_3D::get_next_obstacle(uint16_t obstacle_num) const
+{
+    const uint16_t obstacle_count = get_obstacle_count();
+    while (obstacle_num < obstacle_count) {
+        const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
+        if (_num_valid_faces[layer] == 0) {
+            // skip to the start of the next layer
+            obstacle_num = (layer + 1) * PROXIMITY_NUM_SECTORS;
+            continue;
+        }
+        Face face;
+        if (convert_obstacle_num_to_face(obstacle_num, face)) {
+            return obstacle_num;
+        }
+        obstacle_num++;
+    }
+    return obstacle_count;
+}
+
 // Converts obstacle_num passed from avoidance library into appropriate face of the boundary
 // Returns false if the face is invalid
 // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
 // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
 // The resultant is packed into a Boundary Location object and returned by reference as "face"
-bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const
+bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const
 {
+    if (obstacle_num >= get_obstacle_count()) {
+        return false;
+    }
+
     // obstacle num is just "flattened layers, and sectors"
     const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
     const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
@@ -284,7 +325,7 @@ bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num
 // Then returns the closest point on this line from vehicle, in body-frame. 
 // Used by GPS based Simple Avoidance  
 // False is returned if the obstacle_num provided does not produce a valid obstacle 
-bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const
+bool AP_Proximity_Boundary_3D::get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -308,7 +349,7 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
 // This helps us know if the passed line segment was in the direction of the boundary, or going in a different direction.
 // Used by GPS based Simple Avoidance  - for "brake mode"
 // False is returned if the obstacle_num provided does not produce a valid obstacle
-bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
+bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -343,6 +384,9 @@ bool AP_Proximity_Boundary_3D::get_closest_object(float& angle_deg, float &dista
     // only check for middle layers and higher
     // lower layers might contain ground, which will give false pre-arm failure
     for (uint8_t layer=PROXIMITY_MIDDLE_LAYER; layer<PROXIMITY_NUM_LAYERS; layer++) {
+        if (_num_valid_faces[layer] == 0) {
+            continue;
+        }
         for (uint8_t sector=0; sector<PROXIMITY_NUM_SECTORS; sector++) {
             if (_distance_valid[layer][sector]) {
                 if (!closest_found || (_distance[layer][sector] < _distance[closest_layer][closest_sector])) {
@@ -381,8 +425,12 @@ bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t
 
 // get an obstacle info for AP_Periph
 // returns false if no angle or distance could be returned for some reason
-bool AP_Proximity_Boundary_3D::get_obstacle_info(uint8_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
+bool AP_Proximity_Boundary_3D::get_obstacle_info(uint16_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
 {
+    if (obstacle_num >= get_obstacle_count()) {
+        return false;
+    }
+
     // obstacle num is just "flattened layers, and sectors"
     const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
     const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
@@ -412,31 +460,47 @@ bool AP_Proximity_Boundary_3D::get_filtered_distance(const Face &face, float &di
     return true;
 }
 
-// Get raw and filtered distances in 8 directions per layer
+// Get raw and filtered distances in PROXIMITY_MAX_DIRECTION directions per layer
+// each direction holds the shortest distance of the sectors whose middle falls within it
 bool AP_Proximity_Boundary_3D::get_layer_distances(uint8_t layer_number, float dist_max, Proximity_Distance_Array &prx_dist_array, Proximity_Distance_Array &prx_filt_dist_array) const
 {
-    // cycle through all sectors filling in distances and orientations
+    if (layer_number >= PROXIMITY_NUM_LAYERS) {
+        return false;
+    }
+
+    // fill in orientations
     // see MAV_SENSOR_ORIENTATION for orientations (0 = forward, 1 = 45 degree clockwise from north, etc)
-    bool valid_distances = false;
     prx_dist_array.offset_valid = 0;
     prx_filt_dist_array.offset_valid = 0;
     for (uint8_t i=0; i<PROXIMITY_MAX_DIRECTION; i++) {
         prx_dist_array.orientation[i] = i;
-        const AP_Proximity_Boundary_3D::Face face(layer_number, i);
-        if (!face.valid()) {
-            return false;
+        prx_dist_array.distance[i] = dist_max;
+        prx_filt_dist_array.distance[i] = dist_max;
+    }
+    if (_num_valid_faces[layer_number] == 0) {
+        return false;
+    }
+
+    // cycle through all sectors keeping the shortest distance in each direction
+    const float direction_width_deg = 360.0f / PROXIMITY_MAX_DIRECTION;
+    for (uint8_t sector=0; sector<PROXIMITY_NUM_SECTORS; sector++) {
+        const Face face(layer_number, sector);
+        float distance, filt_distance;
+        if (!get_distance(face, distance) || !get_filtered_distance(face, filt_distance)) {
+            continue;
+        }
+        const uint8_t i = MIN(wrap_360(get_sector_middle_deg(sector) + direction_width_deg * 0.5f) / direction_width_deg, PROXIMITY_MAX_DIRECTION - 1);
+        if (!prx_dist_array.valid(i) || (distance < prx_dist_array.distance[i])) {
+            prx_dist_array.distance[i] = distance;
         }
-        if (get_distance(face, prx_dist_array.distance[i]) && get_filtered_distance(face, prx_filt_dist_array.distance[i])) {
-            valid_distances = true;
-            prx_dist_array.offset_valid |= (1U << i);
-            prx_filt_dist_array.offset_valid |= (1U << i);
-        } else {
-            prx_dist_array.distance[i] = dist_max;
-            prx_filt_dist_array.distance[i] = dist_max;
+        if (!prx_filt_dist_array.valid(i) || (filt_distance < prx_filt_dist_array.distance[i])) {
+            prx_filt_dist_array.distance[i] = filt_distance;
         }
+        prx_dist_array.offset_valid |= (1U << i);
+        prx_filt_dist_array.offset_valid |= (1U << i);
     }
 
-    return valid_distances;
+    return true;
 }
 
 // reset the temporary boundary. This fills in distances with FLT_MAX
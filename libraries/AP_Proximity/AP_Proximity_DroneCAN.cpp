@@ -25,9 +25,6 @@
 
 extern const AP_HAL::HAL& hal;
 
-
-ObjectBuffer_TS<AP_Proximity_DroneCAN::ObstacleItem> AP_Proximity_DroneCAN::items(50);
-
 #define PROXIMITY_TIMEOUT_MS    500 // distance messages must arrive within this many milliseconds
 
 
@@ -115,26 +112,30 @@ AP_Proximity_DroneCAN* AP_Proximity_DroneCAN::get_dronecan_backend(AP_DroneCAN*
 // update the state of the sensor
 void AP_Proximity_DroneCAN::update(void)
 {
+    // apply the messages received since the last update
+    ObstacleItem object_item;
+    uint64_t timestamp_us;
+    while (items.pop(object_item, timestamp_us)) {
+        _last_update_ms = uint32_t(timestamp_us / 1000U);
+        _status = object_item.status;
+        if (_status != AP_Proximity::Status::Good) {
+            continue;
+        }
+        const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(object_item.pitch_deg, object_item.yaw_deg);
+        if (!is_zero(object_item.distance_m) && !ignore_reading(object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m, false)) {
+            // update boundary used for avoidance
+            frontend.boundary.set_face_attributes(face, object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m, state.instance);
+            // update OA database
+            database_push(object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m);
+        }
+    }
+
     // check for timeout and set health status
     if ((_last_update_ms == 0 || (AP_HAL::millis() - _last_update_ms > PROXIMITY_TIMEOUT_MS))) {
         set_status(AP_Proximity::Status::NoData);
     } else {
         set_status(_status);
     }
-
-    if (_status == AP_Proximity::Status::Good) {
-        ObstacleItem object_item;
-        WITH_SEMAPHORE(_sem);
-        while (items.pop(object_item)) {
-            const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(object_item.pitch_deg, object_item.yaw_deg);
-            if (!is_zero(object_item.distance_m) && !ignore_reading(object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m, false)) {
-                // update boundary used for avoidance
-                frontend.boundary.set_face_attributes(face, object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m, state.instance);
-                // update OA database
-                database_push(object_item.pitch_deg, object_item.yaw_deg, object_item.distance_m);
-            }
-        }
-    }
 }
 
 // get maximum and minimum distances (in meters)
@@ -161,34 +162,23 @@ void AP_Proximity_DroneCAN::handle_measurement(AP_DroneCAN *ap_dronecan, const C
     if (driver == nullptr) {
         return;
     }
-    WITH_SEMAPHORE(driver->_sem);
+    ObstacleItem item {msg.yaw, msg.pitch, msg.distance, AP_Proximity::Status::Good};
     switch (msg.reading_type) {
-        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_GOOD: {
-            //update the states in backend instance
-            driver->_last_update_ms = AP_HAL::millis();
-            driver->_status = AP_Proximity::Status::Good;
-            const ObstacleItem item = {msg.yaw, msg.pitch, msg.distance};
-
-            if (driver->items.space()) {
-                // ignore reading if no place to put it in the queue
-                driver->items.push(item);
-            }
+        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_GOOD:
             break;
-        }
         //Additional states supported by Proximity message
-        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_NOT_CONNECTED: {
-            driver->_last_update_ms = AP_HAL::millis();
-            driver->_status = AP_Proximity::Status::NotConnected;
+        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_NOT_CONNECTED:
+            item.status = AP_Proximity::Status::NotConnected;
             break;
-        }
-        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_NO_DATA: {
-            driver->_last_update_ms = AP_HAL::millis();
-            driver->_status = AP_Proximity::Status::NoData;
+        case ARDUPILOT_EQUIPMENT_PROXIMITY_SENSOR_PROXIMITY_READING_TYPE_NO_DATA:
+            item.status = AP_Proximity::Status::NoData;
             break;
-        }
         default:
-            break;
+            return;
     }
+    // the state is updated by update() on the main thread. The message is
+    // ignored if there is no place to put it in the queue
+    driver->items.push(item, AP_HAL::micros64());
 }
 
 #endif // AP_PROXIMITY_DRONECAN_ENABLED
@@ -7,6 +7,9 @@
 #include "AP_Proximity_Backend.h"
 
 #include <AP_DroneCAN/AP_DroneCAN.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+#define PROXIMITY_DRONECAN_QUEUE_SIZE   64  // readings which can be received between calls to update()
 
 class AP_Proximity_DroneCAN : public AP_Proximity_Backend
 {
@@ -40,9 +43,11 @@ private:
         float yaw_deg;
         float pitch_deg;
         float distance_m;
+        AP_Proximity::Status status;
     };
 
-    static ObjectBuffer_TS<ObstacleItem> items;
+    // messages handed from the DroneCAN thread to update() without locking
+    ObjectBuffer_SPSC<ObstacleItem, PROXIMITY_DRONECAN_QUEUE_SIZE> items;
 
     AP_Proximity::Status _status;
 };
@@ -153,6 +153,10 @@ void AP_Proximity_LD06::parse_response_data()
     // Calculates the angle that this point was sampled at
     float sampled_counts = 0;
     const float angle_step = (end_angle - start_angle) /  (PAYLOAD_COUNT - 1);
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // angle between individual measurements, allowing for the angles wrapping from 360 to 0
+    const float point_angle_step = (angle_step < 0) ? (end_angle + 360 - start_angle) / (PAYLOAD_COUNT - 1) : angle_step;
+#endif
     float uncorrected_angle = start_angle + (end_angle - start_angle) * 0.5;
 
     // Handles the case that the angles read went from 360 to 0 (jumped)
@@ -173,6 +177,11 @@ void AP_Proximity_LD06::parse_response_data()
 
         // Validates data and checks if it should be included
         if (distance_meas > distance_min() && distance_meas < distance_max()) {
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+            // the point cloud keeps every measurement at its own angle
+            const uint8_t point_num = (i - START_PAYLOAD) / MEASUREMENT_PAYLOAD_LENGTH;
+            pointcloud_push(correct_angle_for_orientation(wrap_360(start_angle + point_angle_step * point_num)), distance_meas);
+#endif
             if (ignore_reading(push_angle, distance_meas)) {
                 continue;
             }
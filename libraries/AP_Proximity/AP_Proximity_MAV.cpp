@@ -252,6 +252,10 @@ void AP_Proximity_MAV::handle_obstacle_distance_3d_msg(const mavlink_message_t &
         return;
     }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    pointcloud_push(obstacle_FRD);
+#endif
+
     // convert to FRU
     const Vector3f obstacle(obstacle_FRD.x, obstacle_FRD.y, obstacle_FRD.z * -1.0f);
 
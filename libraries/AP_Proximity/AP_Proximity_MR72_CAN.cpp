@@ -49,7 +49,26 @@ AP_Proximity_MR72_CAN::AP_Proximity_MR72_CAN(AP_Proximity &_frontend,
 // update state
 void AP_Proximity_MR72_CAN::update(void)
 {
-    WITH_SEMAPHORE(_sem);
+    // apply the objects received since the last update
+    ObjectItem item;
+    uint64_t timestamp_us;
+    while (_objects.pop(item, timestamp_us)) {
+        if (item.scan_start) {
+            _temp_boundary.update_3D_boundary(state.instance, frontend.boundary);
+            _temp_boundary.reset();
+            last_update_ms = uint32_t(timestamp_us / 1000U);
+            continue;
+        }
+        const float yaw = correct_angle_for_orientation(wrap_360(degrees(atan2f(item.position_fr_m.x, item.position_fr_m.y))));
+        const float objects_dist = item.position_fr_m.length();
+        if (ignore_reading(yaw, objects_dist)) {
+            // obstacle is probably near ground or out of range
+            continue;
+        }
+        const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(yaw);
+        _temp_boundary.add_distance(face, yaw, objects_dist);
+    }
+
     const uint32_t now = AP_HAL::millis();
     if (now - last_update_ms > 500) {
         // no new data.
@@ -62,9 +81,6 @@ void AP_Proximity_MR72_CAN::update(void)
 // handler for incoming frames. These come in at 100Hz
 bool AP_Proximity_MR72_CAN::handle_frame(AP_HAL::CANFrame &frame)
 {
-    WITH_SEMAPHORE(_sem);
-
-
     // check if message is coming from the right sensor ID
     const uint16_t id = frame.id;
 
@@ -77,9 +93,7 @@ bool AP_Proximity_MR72_CAN::handle_frame(AP_HAL::CANFrame &frame)
         // number of objects
         _object_count = frame.data[0];
         _current_object_index = 0;
-        _temp_boundary.update_3D_boundary(state.instance, frontend.boundary);
-        _temp_boundary.reset();
-        last_update_ms = AP_HAL::millis();
+        _objects.push(ObjectItem{Vector2f(), true}, AP_HAL::micros64());
         break;
     case 0xBU:
         // obstacle data
@@ -106,18 +120,9 @@ bool AP_Proximity_MR72_CAN::parse_distance_message(AP_HAL::CANFrame &frame)
     // This parsing comes from the NanoRadar MR72 datasheet
     obstacle_fr.x = ((frame.data[2] & 0x07U) * 256 + frame.data[3]) * 0.2 - 204.6;
     obstacle_fr.y = (frame.data[1] * 32 + (frame.data[2] >> 3)) * 0.2 - 500;
-    const float yaw = correct_angle_for_orientation(wrap_360(degrees(atan2f(obstacle_fr.x, obstacle_fr.y))));
-
-    const float objects_dist = obstacle_fr.length();
 
-    if (ignore_reading(yaw, objects_dist)) {
-        // obstacle is probably near ground or out of range
-        return false;
-    }
-
-    const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(yaw);
-    _temp_boundary.add_distance(face, yaw, objects_dist);
-    return true;
+    // the boundary is updated by update() on the main thread
+    return _objects.push(ObjectItem{obstacle_fr, false}, AP_HAL::micros64());
 }
 
 #endif // HAL_PROXIMITY_ENABLED
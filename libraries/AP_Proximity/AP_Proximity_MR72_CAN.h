@@ -7,9 +7,11 @@
 #include "AP_Proximity_Backend.h"
 #include <AP_HAL/AP_HAL.h>
 #include <AP_CANManager/AP_CANSensor.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 #define MR72_MAX_RANGE_M             50.0f   // max range of the sensor in meters
 #define MR72_MIN_RANGE_M             0.2f   // min range of the sensor in meters
+#define MR72_QUEUE_SIZE              64     // objects which can be received between calls to update()
 
 class MR72_MultiCAN;
 
@@ -43,6 +45,14 @@ private:
     uint32_t _current_object_index;     // current object index
     uint32_t last_update_ms;            // last update time in ms
 
+    // objects handed from the CAN thread to update() without locking.
+    // A scan starts with an item with scan_start set
+    struct ObjectItem {
+        Vector2f position_fr_m;         // position of the object, forward and right of the sensor
+        bool scan_start;
+    };
+    ObjectBuffer_SPSC<ObjectItem, MR72_QUEUE_SIZE> _objects;
+
     AP_Int32 receive_id;                // ID of the sensor
 
     MultiCAN* multican_MR72;            // Allows for multiple CAN rangefinders on a single bus
@@ -0,0 +1,130 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Proximity_PointCloud.h"
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_HAL/AP_HAL.h>
+
+// cache the vehicle's position and attitude used to rotate body-frame readings into the earth frame
+// should be called once per loop before backends push readings
+void AP_Proximity_PointCloud::update_vehicle_state()
+{
+    const AP_AHRS &ahrs = AP::ahrs();
+    _vehicle_state_ok = ahrs.get_relative_position_NED_origin(_vehicle_pos_ned);
+    if (_vehicle_state_ok) {
+        _body_to_ned = ahrs.get_rotation_body_to_ned();
+    }
+}
+
+// add a body-frame (FRD) reading in meters. The reading is dropped if the vehicle's position is unknown
+void AP_Proximity_PointCloud::add_point_body(const Vector3f &point_frd_m)
+{
+    if (!_vehicle_state_ok) {
+        return;
+    }
+    add_point_NED(_vehicle_pos_ned + _body_to_ned * point_frd_m, AP_HAL::millis());
+}
+
+// add an earth-frame point (NED in meters from the EKF origin)
+void AP_Proximity_PointCloud::add_point_NED(const Vector3f &point_ned_m, uint32_t now_ms)
+{
+    const int32_t north = floorf(point_ned_m.x * (1.0f / AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M));
+    const int32_t east = floorf(point_ned_m.y * (1.0f / AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M));
+    const int16_t down = constrain_int32(floorf(point_ned_m.z * (1.0f / AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M)), INT16_MIN, INT16_MAX);
+
+    // search the probe window for this voxel, remembering the slot that has gone longest without a hit
+    const uint16_t start = hash(north, east, down);
+    Voxel *replace = nullptr;
+    uint32_t replace_age_ms = 0;
+    for (uint8_t i = 0; i < AP_PROXIMITY_POINTCLOUD_MAX_PROBE; i++) {
+        Voxel &voxel = _voxels[(start + i) & (AP_PROXIMITY_POINTCLOUD_NUM_VOXELS - 1)];
+        if ((voxel.hits > 0) && (voxel.north == north) && (voxel.east == east) && (voxel.down == down)) {
+            if (!voxel_live(voxel, now_ms)) {
+                // forget returns from before the voxel timed out
+                voxel.hits = 0;
+            }
+            if (voxel.hits < UINT16_MAX) {
+                voxel.hits++;
+            }
+            voxel.centroid += (point_ned_m - voxel.centroid) / voxel.hits;
+            voxel.last_hit_ms = now_ms;
+            return;
+        }
+        const uint32_t age_ms = (voxel.hits == 0) ? UINT32_MAX : (now_ms - voxel.last_hit_ms);
+        if ((replace == nullptr) || (age_ms > replace_age_ms)) {
+            replace = &voxel;
+            replace_age_ms = age_ms;
+        }
+    }
+
+    // start a new voxel in the unused or oldest slot
+    replace->north = north;
+    replace->east = east;
+    replace->down = down;
+    replace->hits = 1;
+    replace->last_hit_ms = now_ms;
+    replace->centroid = point_ned_m;
+}
+
+// fill points with the mean position of the returns in each voxel (NED in meters from the EKF origin) within radius_m of centre_ned_m
+// returns the number of points filled in
+uint16_t AP_Proximity_PointCloud::get_points(const Vector3f &centre_ned_m, float radius_m, Vector3f *points, uint16_t max_points) const
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const float radius_sq = sq(radius_m);
+    uint16_t count = 0;
+    for (uint16_t i = 0; (i < AP_PROXIMITY_POINTCLOUD_NUM_VOXELS) && (count < max_points); i++) {
+        const Voxel &voxel = _voxels[i];
+        if (voxel_live(voxel, now_ms) && ((voxel.centroid - centre_ned_m).length_squared() <= radius_sq)) {
+            points[count++] = voxel.centroid;
+        }
+    }
+    return count;
+}
+
+// get the mean position of the returns in the voxel closest to pos_ned_m that is within max_distance_m
+// voxels more than max_below_m below pos_ned_m are ignored, e.g. so the ground does not count as an obstacle
+// returns true on success
+bool AP_Proximity_PointCloud::get_closest_point(const Vector3f &pos_ned_m, float max_distance_m, float max_below_m, Vector3f &closest_ned_m) const
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    float closest_dist_sq = sq(max_distance_m);
+    bool found = false;
+    for (const Voxel &voxel : _voxels) {
+        if (!voxel_live(voxel, now_ms) || (voxel.centroid.z - pos_ned_m.z > max_below_m)) {
+            continue;
+        }
+        const float dist_sq = (voxel.centroid - pos_ned_m).length_squared();
+        if (dist_sq <= closest_dist_sq) {
+            closest_dist_sq = dist_sq;
+            closest_ned_m = voxel.centroid;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// hash of voxel indices to the first slot to probe
+uint16_t AP_Proximity_PointCloud::hash(int32_t north, int32_t east, int16_t down)
+{
+    uint32_t h = (uint32_t(north) * 73856093U) ^ (uint32_t(east) * 19349663U) ^ (uint32_t(uint16_t(down)) * 83492791U);
+    h ^= h >> 16;
+    return h & (AP_PROXIMITY_POINTCLOUD_NUM_VOXELS - 1);
+}
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
@@ -0,0 +1,90 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "AP_Proximity_config.h"
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#ifndef AP_PROXIMITY_POINTCLOUD_NUM_VOXELS
+#define AP_PROXIMITY_POINTCLOUD_NUM_VOXELS      2048    // number of voxels held, must be a power of two
+#endif
+#define AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M    0.2f    // width of each cubic voxel in meters
+#define AP_PROXIMITY_POINTCLOUD_MAX_PROBE       8       // number of slots searched for a voxel before the oldest is replaced
+#define AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS      1000    // voxels not hit for this long are forgotten, this covers the last few revolutions of a scanning lidar
+
+static_assert((AP_PROXIMITY_POINTCLOUD_NUM_VOXELS & (AP_PROXIMITY_POINTCLOUD_NUM_VOXELS - 1)) == 0, "AP_PROXIMITY_POINTCLOUD_NUM_VOXELS must be a power of two");
+
+/*
+  Earth-frame voxel grid accumulating proximity sensor returns over the last few revolutions.
+  Voxels live in a fixed size hash table, nothing is allocated after construction and every insert costs at most
+  AP_PROXIMITY_POINTCLOUD_MAX_PROBE slot checks. When the table is full the least recently hit voxel is replaced.
+  Positions are NED in meters relative to the EKF origin. All methods should be called from the main thread.
+*/
+class AP_Proximity_PointCloud
+{
+public:
+
+    // cache the vehicle's position and attitude used to rotate body-frame readings into the earth frame
+    // should be called once per loop before backends push readings
+    void update_vehicle_state();
+
+    // add a body-frame (FRD) reading in meters. The reading is dropped if the vehicle's position is unknown
+    void add_point_body(const Vector3f &point_frd_m);
+
+    // add an earth-frame point (NED in meters from the EKF origin)
+    void add_point_NED(const Vector3f &point_ned_m, uint32_t now_ms);
+
+    // fill points with the mean position of the returns in each voxel (NED in meters from the EKF origin) within radius_m of centre_ned_m
+    // returns the number of points filled in
+    uint16_t get_points(const Vector3f &centre_ned_m, float radius_m, Vector3f *points, uint16_t max_points) const;
+
+    // get the mean position of the returns in the voxel closest to pos_ned_m that is within max_distance_m
+    // voxels more than max_below_m below pos_ned_m are ignored, e.g. so the ground does not count as an obstacle
+    // returns true on success
+    bool get_closest_point(const Vector3f &pos_ned_m, float max_distance_m, float max_below_m, Vector3f &closest_ned_m) const;
+
+private:
+
+    struct Voxel {
+        int32_t north;          // voxel index north of the origin
+        int32_t east;           // voxel index east of the origin
+        int16_t down;           // voxel index below the origin
+        uint16_t hits;          // number of returns within this voxel, zero if the slot is unused
+        uint32_t last_hit_ms;   // system time of the most recent return within this voxel
+        Vector3f centroid;      // mean position of the returns within this voxel
+    };
+
+    // returns true if the voxel is in use and has been hit recently
+    bool voxel_live(const Voxel &voxel, uint32_t now_ms) const {
+        return (voxel.hits > 0) && ((now_ms - voxel.last_hit_ms) < AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS);
+    }
+
+    // hash of voxel indices to the first slot to probe
+    static uint16_t hash(int32_t north, int32_t east, int16_t down);
+
+    Voxel _voxels[AP_PROXIMITY_POINTCLOUD_NUM_VOXELS];
+
+    // vehicle state cached by update_vehicle_state
+    Vector3f _vehicle_pos_ned;          // vehicle position (NED in meters from the EKF origin)
+    Matrix3f _body_to_ned;              // vehicle attitude
+    bool _vehicle_state_ok;             // true if the above are valid
+};
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
@@ -381,6 +381,11 @@ void AP_Proximity_RPLidarA2::parse_response_data()
     Debug(2, "   D%02.2f A%03.1f Q%0.2f", distance_m, angle_deg, quality);
 #endif
     _last_distance_received_ms = AP_HAL::millis();
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    if ((distance_m > distance_min()) && (distance_m < distance_max())) {
+        pointcloud_push(angle_deg, distance_m);
+    }
+#endif
     if (!ignore_reading(angle_deg, distance_m)) {
         const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(angle_deg);
 
@@ -88,5 +88,35 @@ bool AP_Proximity::check_obstacle_near_ground(float pitch, float yaw, float dist
     return false;
 }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+// get vector to the closest return in the point cloud within max_distance_m, in the same frame and units as get_obstacle
+// returns near the ground are ignored as for the boundary, used in GPS based Simple Avoidance
+bool AP_Proximity::get_closest_pointcloud_obstacle(float max_distance_m, Vector3f& vec_to_obstacle) const
+{
+    const AP_AHRS &ahrs = AP::ahrs();
+    Vector3f pos_ned_m;
+    if (!ahrs.get_relative_position_NED_origin(pos_ned_m)) {
+        return false;
+    }
+
+    // as in check_obstacle_near_ground, returns within _alt_min of the ground are not obstacles
+    float max_below_m = max_distance_m;
+    float alt_m;
+    if (_ign_gnd_enable && get_rangefinder_alt(alt_m)) {
+        max_below_m = MIN(max_below_m, alt_m - _alt_min);
+    }
+
+    Vector3f closest_ned_m;
+    if (!pointcloud.get_closest_point(pos_ned_m, max_distance_m, max_below_m, closest_ned_m)) {
+        return false;
+    }
+
+    // the boundary is rotated by yaw only, with z up
+    const Vector3f rel_ned_m = closest_ned_m - pos_ned_m;
+    const Vector2f rel_body_m = ahrs.earth_to_body2D(rel_ned_m.xy());
+    vec_to_obstacle = Vector3f{rel_body_m.x, rel_body_m.y, -rel_ned_m.z} * 100.0f;
+    return true;
+}
+#endif
 
 #endif // HAL_PROXIMITY_ENABLED
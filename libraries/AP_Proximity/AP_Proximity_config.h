@@ -73,3 +73,32 @@
 #ifndef AP_PROXIMITY_LD06_ENABLED
 #define AP_PROXIMITY_LD06_ENABLED AP_PROXIMITY_BACKEND_DEFAULT_ENABLED
 #endif
+
+// voxel grid accumulating individual lidar returns, needs more memory than most flight controllers can spare
+#ifndef AP_PROXIMITY_POINTCLOUD_ENABLED
+#define AP_PROXIMITY_POINTCLOUD_ENABLED HAL_PROXIMITY_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// resolution of the 3D boundary. Sectors divide the horizontal plane around
+// the vehicle, layers divide the pitch range -75 to +75 degrees. The 72x9
+// boundary takes around 40k of RAM, so is only the default on boards with
+// plenty of memory. SITL uses the same rule, so it flies what those boards do
+#ifndef AP_PROXIMITY_BOUNDARY_HIGH_RES_ENABLED
+#define AP_PROXIMITY_BOUNDARY_HIGH_RES_ENABLED HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#endif
+
+#ifndef AP_PROXIMITY_BOUNDARY_NUM_SECTORS
+#if AP_PROXIMITY_BOUNDARY_HIGH_RES_ENABLED
+#define AP_PROXIMITY_BOUNDARY_NUM_SECTORS 72
+#else
+#define AP_PROXIMITY_BOUNDARY_NUM_SECTORS 8
+#endif
+#endif
+
+#ifndef AP_PROXIMITY_BOUNDARY_NUM_LAYERS
+#if AP_PROXIMITY_BOUNDARY_HIGH_RES_ENABLED
+#define AP_PROXIMITY_BOUNDARY_NUM_LAYERS 9
+#else
+#define AP_PROXIMITY_BOUNDARY_NUM_LAYERS 5
+#endif
+#endif
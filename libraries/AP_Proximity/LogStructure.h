@@ -10,7 +10,7 @@
 // @LoggerMessage: PRX
 // @Description: Proximity Filtered sensor data
 // @Field: TimeUS: Time since system startup
-// @Field: Layer: Pitch(instance) at which the obstacle is at. 0th layer {-75,-45} degrees. 1st layer {-45,-15} degrees. 2nd layer {-15, 15} degrees. 3rd layer {15, 45} degrees. 4th layer {45,75} degrees. Minimum distance in each layer will be logged.
+// @Field: Layer: Pitch(instance) at which the obstacle is at. Layers evenly divide -75 to 75 degrees, with 5 layers the 0th layer is {-75,-45} degrees. 1st layer {-45,-15} degrees. 2nd layer {-15, 15} degrees. 3rd layer {15, 45} degrees. 4th layer {45,75} degrees. Minimum distance in each layer will be logged.
 // @Field: He: True if proximity sensor is healthy
 // @Field: D0: Nearest object in sector surrounding 0-degrees
 // @Field: D45: Nearest object in sector surrounding 45-degrees
@@ -46,7 +46,7 @@ struct PACKED log_Proximity {
 // @LoggerMessage: PRXR
 // @Description: Proximity Raw sensor data
 // @Field: TimeUS: Time since system startup
-// @Field: Layer: Pitch(instance) at which the obstacle is at. 0th layer {-75,-45} degrees. 1st layer {-45,-15} degrees. 2nd layer {-15, 15} degrees. 3rd layer {15, 45} degrees. 4th layer {45,75} degrees. Minimum distance in each layer will be logged.
+// @Field: Layer: Pitch(instance) at which the obstacle is at. Layers evenly divide -75 to 75 degrees, with 5 layers the 0th layer is {-75,-45} degrees. 1st layer {-45,-15} degrees. 2nd layer {-15, 15} degrees. 3rd layer {15, 45} degrees. 4th layer {45,75} degrees. Minimum distance in each layer will be logged.
 // @Field: D0: Nearest object in sector surrounding 0-degrees
 // @Field: D45: Nearest object in sector surrounding 45-degrees
 // @Field: D90: Nearest object in sector surrounding 90-degrees
@@ -0,0 +1,124 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_Proximity/AP_Proximity_PointCloud.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+// number of live voxels within radius_m of centre
+static uint16_t count_points(const AP_Proximity_PointCloud &cloud, const Vector3f &centre, float radius_m)
+{
+    static Vector3f points[AP_PROXIMITY_POINTCLOUD_NUM_VOXELS];
+    return cloud.get_points(centre, radius_m, points, ARRAY_SIZE(points));
+}
+
+TEST(AP_Proximity_PointCloud, insert)
+{
+    AP_Proximity_PointCloud *cloud = new AP_Proximity_PointCloud();
+    const uint32_t now_ms = AP_HAL::millis();
+
+    // returns in the same voxel are merged into their mean
+    cloud->add_point_NED(Vector3f(0.05f, 0.05f, 0.05f), now_ms);
+    cloud->add_point_NED(Vector3f(0.15f, 0.15f, 0.15f), now_ms);
+    Vector3f points[4];
+    ASSERT_EQ(cloud->get_points(Vector3f(), 1.0f, points, ARRAY_SIZE(points)), 1U);
+    EXPECT_TRUE(points[0] == Vector3f(0.1f, 0.1f, 0.1f));
+
+    // a return in the next voxel is kept separately
+    cloud->add_point_NED(Vector3f(0.25f, 0.05f, 0.05f), now_ms);
+    EXPECT_EQ(count_points(*cloud, Vector3f(), 1.0f), 2U);
+
+    // only voxels within the radius are returned, and no more than asked for
+    cloud->add_point_NED(Vector3f(5.0f, 0, 0), now_ms);
+    EXPECT_EQ(count_points(*cloud, Vector3f(), 1.0f), 2U);
+    EXPECT_EQ(count_points(*cloud, Vector3f(), 10.0f), 3U);
+    EXPECT_EQ(cloud->get_points(Vector3f(), 10.0f, points, 2), 2U);
+
+    delete cloud;
+}
+
+TEST(AP_Proximity_PointCloud, age_out)
+{
+    AP_Proximity_PointCloud *cloud = new AP_Proximity_PointCloud();
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t stale_ms = now_ms - AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS - 100;
+
+    cloud->add_point_NED(Vector3f(0.05f, 0.05f, 0.05f), stale_ms);
+    cloud->add_point_NED(Vector3f(1.05f, 0.05f, 0.05f), stale_ms);
+    EXPECT_EQ(count_points(*cloud, Vector3f(), 10.0f), 0U);
+
+    // a new return in a stale voxel does not average with the forgotten ones
+    cloud->add_point_NED(Vector3f(0.15f, 0.15f, 0.15f), now_ms);
+    Vector3f points[4];
+    ASSERT_EQ(cloud->get_points(Vector3f(), 10.0f, points, ARRAY_SIZE(points)), 1U);
+    EXPECT_TRUE(points[0] == Vector3f(0.15f, 0.15f, 0.15f));
+
+    delete cloud;
+}
+
+TEST(AP_Proximity_PointCloud, eviction)
+{
+    AP_Proximity_PointCloud *cloud = new AP_Proximity_PointCloud();
+    const uint32_t now_ms = AP_HAL::millis();
+    const float voxel = AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M;
+
+    // overfill the table with older returns spread over a large area
+    for (uint16_t i = 0; i < AP_PROXIMITY_POINTCLOUD_NUM_VOXELS * 3; i++) {
+        cloud->add_point_NED(Vector3f((i % 64 + 0.5f) * voxel, (i / 64 + 0.5f) * voxel, 0.5f * voxel), now_ms - 500);
+    }
+    const uint16_t full = count_points(*cloud, Vector3f(), 1000.0f);
+    EXPECT_LE(full, AP_PROXIMITY_POINTCLOUD_NUM_VOXELS);
+    EXPECT_GT(full, AP_PROXIMITY_POINTCLOUD_NUM_VOXELS / 2);
+
+    // newer returns replace the least recently hit voxels, so all of them are kept
+    const Vector3f centre {-100, -100, 0};
+    for (uint8_t i = 0; i < 64; i++) {
+        cloud->add_point_NED(centre + Vector3f((i % 8 + 0.5f) * voxel, (i / 8 + 0.5f) * voxel, 0.5f * voxel), now_ms);
+    }
+    EXPECT_EQ(count_points(*cloud, centre, 5.0f), 64U);
+    EXPECT_LE(count_points(*cloud, Vector3f(), 1000.0f), AP_PROXIMITY_POINTCLOUD_NUM_VOXELS);
+
+    delete cloud;
+}
+
+TEST(AP_Proximity_PointCloud, closest_point)
+{
+    AP_Proximity_PointCloud *cloud = new AP_Proximity_PointCloud();
+    const uint32_t now_ms = AP_HAL::millis();
+    Vector3f closest;
+
+    EXPECT_FALSE(cloud->get_closest_point(Vector3f(), 10.0f, 10.0f, closest));
+
+    // a pole 2m north, a wall 3m east and the ground 1.5m below
+    cloud->add_point_NED(Vector3f(2.05f, 0.05f, 0.05f), now_ms);
+    cloud->add_point_NED(Vector3f(0.05f, 3.05f, 0.05f), now_ms);
+    cloud->add_point_NED(Vector3f(0.05f, 0.05f, 1.55f), now_ms);
+
+    ASSERT_TRUE(cloud->get_closest_point(Vector3f(), 10.0f, 10.0f, closest));
+    EXPECT_TRUE(closest == Vector3f(0.05f, 0.05f, 1.55f));
+
+    // ignoring the ground leaves the pole
+    ASSERT_TRUE(cloud->get_closest_point(Vector3f(), 10.0f, 1.0f, closest));
+    EXPECT_TRUE(closest == Vector3f(2.05f, 0.05f, 0.05f));
+
+    // nothing within range
+    EXPECT_FALSE(cloud->get_closest_point(Vector3f(), 1.0f, 1.0f, closest));
+
+    // closer to the wall than the pole
+    ASSERT_TRUE(cloud->get_closest_point(Vector3f(0, 2.0f, 0), 10.0f, 1.0f, closest));
+    EXPECT_TRUE(closest == Vector3f(0.05f, 3.05f, 0.05f));
+
+    // stale returns are not obstacles
+    cloud->add_point_NED(Vector3f(0.55f, 0.05f, 0.05f), now_ms - AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS - 100);
+    ASSERT_TRUE(cloud->get_closest_point(Vector3f(), 10.0f, 1.0f, closest));
+    EXPECT_TRUE(closest == Vector3f(2.05f, 0.05f, 0.05f));
+
+    delete cloud;
+}
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
+
+AP_GTEST_MAIN()
@@ -242,6 +242,15 @@ void RangeFinder::update(void)
                 continue;
             }
             drivers[i]->update();
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+            drivers[i]->update_samples();
+#endif
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+            drivers[i]->update_ground_contact();
+#endif
+#if AP_RANGEFINDER_FUSION_ENABLED
+            drivers[i]->update_noise();
+#endif
         }
     }
 #if HAL_LOGGING_ENABLED
@@ -262,6 +271,9 @@ bool RangeFinder::_add_backend(AP_RangeFinder_Backend *backend, uint8_t instance
         INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
     }
     backend->init_serial(serial_instance);
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    backend->init_median_filter(instance);
+#endif
     drivers[instance] = backend;
     num_instances = MAX(num_instances, instance+1);
 
@@ -780,6 +792,149 @@ uint32_t RangeFinder::last_reading_ms(enum Rotation orientation) const
     return backend->last_reading_ms();
 }
 
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+// the confidence decays to zero once readings stop, so callers should only
+// use it while the sensor is in range or below its minimum distance
+bool RangeFinder::ground_contact_valid_orient(enum Rotation orientation) const
+{
+    switch (status_orient(orientation)) {
+    case Status::Good:
+    case Status::OutOfRangeLow:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// confidence from 0 to 1 that the rangefinder has settled at its ground clearance
+float RangeFinder::ground_contact_confidence_orient(enum Rotation orientation) const
+{
+    AP_RangeFinder_Backend *backend = find_instance(orientation);
+    if (backend == nullptr) {
+        return 0;
+    }
+    return backend->ground_contact_confidence();
+}
+#endif
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+/*
+  fuse the readings of all healthy instances with an orientation, e.g.
+  several downward lidars. Each good reading is weighted by the inverse
+  of its instance's noise variance, scaled down while its
+  range_valid_count is still building. Readings further than
+  RANGEFINDER_FUSION_GATE_SIGMA standard deviations (and at least
+  RANGEFINDER_FUSION_GATE_MIN_M) from a reference are rejected, so one
+  lidar seeing grass tips or a passing object doesn't pull the result
+  off the ground. The reference is the median with three or more
+  readings, otherwise the previous result if it is recent. If every
+  reading is rejected, e.g. after a real step in the terrain, the
+  quietest reading becomes the reference instead. Distances are
+  corrected for each instance's position offset first, and are measured
+  from the first instance with the orientation, so the result is
+  comparable with its ground clearance and with distance_cm_orient().
+ */
+bool RangeFinder::fuse_orient(enum Rotation orientation, const Matrix3f &body_to_ned, Fused &fused) const
+{
+    const AP_RangeFinder_Backend *primary = find_instance(orientation);
+    if (primary == nullptr) {
+        return false;
+    }
+    const Vector3f &primary_offset = primary->get_pos_offset();
+    FusionInput inputs[RANGEFINDER_MAX_INSTANCES];
+    uint8_t num = 0;
+    for (uint8_t i=0; i<num_instances; i++) {
+        const AP_RangeFinder_Backend *backend = get_backend(i);
+        if (backend == nullptr ||
+            backend->orientation() != orientation ||
+            backend->status() != Status::Good) {
+            continue;
+        }
+        inputs[num].distance_m = distance_from_origin(backend->distance(), orientation, backend->get_pos_offset() - primary_offset, body_to_ned);
+        inputs[num].variance_m2 = backend->noise_variance_m2();
+        inputs[num].last_reading_ms = backend->last_reading_ms();
+        inputs[num].range_valid_count = backend->range_valid_count();
+        num++;
+    }
+    return fuse(inputs, num, AP_HAL::millis(), fused);
+}
+
+/*
+  the sensor is (R * pos_offset).z further down than the origin, so the
+  origin is that much further along an axis pointing down at the ground
+  or that much less far along one pointing up at a ceiling
+ */
+float RangeFinder::distance_from_origin(float distance_m, enum Rotation orientation, const Vector3f &pos_offset, const Matrix3f &body_to_ned)
+{
+    Vector3f dir_ned {1, 0, 0};
+    dir_ned.rotate(orientation);
+    dir_ned = body_to_ned * dir_ned;
+    if (fabsf(dir_ned.z) < 0.1f) {
+        // nearly horizontal, the offset can't be expressed along the axis
+        return distance_m;
+    }
+    return distance_m + (body_to_ned * pos_offset).z / dir_ned.z;
+}
+
+bool RangeFinder::fuse(const FusionInput inputs[], uint8_t num, uint32_t now_ms, Fused &fused)
+{
+    if (num == 0) {
+        return false;
+    }
+    float variance_m2[RANGEFINDER_MAX_INSTANCES];
+    uint8_t quietest = 0;
+    for (uint8_t i=0; i<num; i++) {
+        variance_m2[i] = MAX(inputs[i].variance_m2, sq(RANGEFINDER_FUSION_NOISE_MIN_M));
+        if (variance_m2[i] < variance_m2[quietest]) {
+            quietest = i;
+        }
+    }
+
+    float reference_m = inputs[quietest].distance_m;
+    if (num >= 3) {
+        float sorted[RANGEFINDER_MAX_INSTANCES];
+        for (uint8_t i=0; i<num; i++) {
+            const float d = inputs[i].distance_m;
+            uint8_t j = i;
+            for (; j>0 && sorted[j-1] > d; j--) {
+                sorted[j] = sorted[j-1];
+            }
+            sorted[j] = d;
+        }
+        reference_m = (num & 1) ? sorted[num/2] : 0.5f * (sorted[num/2-1] + sorted[num/2]);
+    } else if (fused.last_reading_ms != 0 && now_ms - fused.last_reading_ms < RANGEFINDER_FUSION_TIMEOUT_MS) {
+        reference_m = fused.distance_m;
+    }
+
+    for (uint8_t pass=0; pass<2; pass++) {
+        float sum_w = 0;
+        float sum_wd = 0;
+        Fused result {};
+        for (uint8_t i=0; i<num; i++) {
+            const float gate_m = MAX(RANGEFINDER_FUSION_GATE_SIGMA * sqrtf(variance_m2[i]), RANGEFINDER_FUSION_GATE_MIN_M);
+            if (fabsf(inputs[i].distance_m - reference_m) > gate_m) {
+                result.num_rejected++;
+                continue;
+            }
+            const uint8_t valid_count = inputs[i].range_valid_count;
+            const float w = MAX(valid_count, 1U) * 0.1f / variance_m2[i];
+            sum_w += w;
+            sum_wd += w * inputs[i].distance_m;
+            result.last_reading_ms = MAX(result.last_reading_ms, inputs[i].last_reading_ms);
+            result.range_valid_count = MAX(result.range_valid_count, valid_count);
+            result.num_used++;
+        }
+        if (result.num_used > 0) {
+            result.distance_m = sum_wd / sum_w;
+            fused = result;
+            return true;
+        }
+        reference_m = inputs[quietest].distance_m;
+    }
+    return false;
+}
+#endif
+
 MAV_DISTANCE_SENSOR RangeFinder::get_mav_distance_sensor_type_orient(enum Rotation orientation) const
 {
     AP_RangeFinder_Backend *backend = find_instance(orientation);
@@ -34,6 +34,24 @@
 #endif
 
 #define RANGEFINDER_GROUND_CLEARANCE_CM_DEFAULT 10
+
+// number of timestamped readings kept per instance for batch consumers
+#ifndef RANGEFINDER_SAMPLE_BATCH_SIZE
+#define RANGEFINDER_SAMPLE_BATCH_SIZE 64
+#endif
+
+// readings a driver's bus thread can queue between calls to update()
+#ifndef RANGEFINDER_READING_QUEUE_SIZE
+#define RANGEFINDER_READING_QUEUE_SIZE 16
+#endif
+
+// fusion of instances with the same orientation
+#define RANGEFINDER_FUSION_NOISE_INIT_M     0.05f   // noise assumed for an instance until it has been measured
+#define RANGEFINDER_FUSION_NOISE_MIN_M      0.01f   // lower limit on the noise so that no instance takes all the weight
+#define RANGEFINDER_FUSION_NOISE_ALPHA      0.05f   // filter constant of the noise estimate, applied once per reading
+#define RANGEFINDER_FUSION_GATE_SIGMA       3.0f    // readings further than this many standard deviations from the reference are outliers
+#define RANGEFINDER_FUSION_GATE_MIN_M       0.3f    // readings within this distance of the reference are never outliers
+#define RANGEFINDER_FUSION_TIMEOUT_MS       500     // the previous fused distance is used as the reference if it is this recent
 #define RANGEFINDER_PREARM_ALT_MAX_CM           200
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #define RANGEFINDER_PREARM_REQUIRED_CHANGE_CM   0
@@ -215,6 +233,52 @@ public:
         const struct AP_Param::GroupInfo *var_info;
     };
 
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    // an individual reading, for consumers which want every reading
+    // rather than the latest (possibly averaged) distance
+    struct Sample {
+        uint32_t time_us;               // system time of the reading
+        float distance_m;
+    };
+
+    // a contiguous run of samples within a backend's sample ring
+    struct SampleSpan {
+        const Sample *samples;
+        uint16_t count;
+    };
+#endif
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+    // result of fusing all instances with an orientation. The previous
+    // result is used to reject readings which jump away from it, so the
+    // caller keeps one of these per orientation between calls
+    struct Fused {
+        float distance_m;               // noise weighted mean of the readings which were used
+        uint32_t last_reading_ms;       // system time of the latest reading used
+        uint8_t range_valid_count;      // largest range_valid_count of the instances used
+        uint8_t num_used;               // number of instances used
+        uint8_t num_rejected;           // number of healthy instances rejected as outliers
+    };
+
+    // one instance's reading as passed to fuse()
+    struct FusionInput {
+        float distance_m;               // distance along the sensor axis from the first instance's mount
+        float variance_m2;              // noise variance of the instance
+        uint32_t last_reading_ms;       // system time of the reading
+        uint8_t range_valid_count;
+    };
+
+    // fuse num readings into fused, see fuse_orient(). Returns false,
+    // leaving fused unchanged, if every reading is rejected
+    static bool fuse(const FusionInput inputs[], uint8_t num, uint32_t now_ms, Fused &fused);
+
+    // distance along the sensor axis from the vehicle origin rather
+    // than from the sensor, so instances mounted at different offsets
+    // agree. The sensor is at pos_offset in body frame, which may be
+    // relative to another sensor to measure from that one instead
+    static float distance_from_origin(float distance_m, enum Rotation orientation, const Vector3f &pos_offset, const Matrix3f &body_to_ned);
+#endif
+
     static const struct AP_Param::GroupInfo *backend_var_info[RANGEFINDER_MAX_INSTANCES];
 
     // parameters for each instance
@@ -281,6 +345,18 @@ public:
     uint8_t range_valid_count_orient(enum Rotation orientation) const;
     const Vector3f &get_pos_offset_orient(enum Rotation orientation) const;
     uint32_t last_reading_ms(enum Rotation orientation) const;
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+    // true if the sensor is currently returning distances, so its
+    // ground contact confidence means something
+    bool ground_contact_valid_orient(enum Rotation orientation) const;
+    float ground_contact_confidence_orient(enum Rotation orientation) const;
+#endif
+#if AP_RANGEFINDER_FUSION_ENABLED
+    // fuse the readings of all healthy instances with an orientation
+    // rather than using the first one. Returns false, leaving fused
+    // unchanged, if no instance has a good reading
+    bool fuse_orient(enum Rotation orientation, const Matrix3f &body_to_ned, Fused &fused) const;
+#endif
 
     // get temperature reading in C.  returns true on success and populates temp argument
     bool get_temp(enum Rotation orientation, float &temp) const;
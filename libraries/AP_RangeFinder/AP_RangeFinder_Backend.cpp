@@ -17,6 +17,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_RangeFinder.h"
 #include "AP_RangeFinder_Backend.h"
+#include <GCS_MAVLink/GCS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -52,9 +53,145 @@ bool AP_RangeFinder_Backend::has_data() const {
             (state.status != RangeFinder::Status::NoData));
 }
 
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+void AP_RangeFinder_Backend::add_sample(float distance_m, uint32_t time_us)
+{
+    // only readings update_status() would report as Good go in the batch
+    if (distance_m > max_distance_cm() * 0.01f || distance_m < min_distance_cm() * 0.01f) {
+        return;
+    }
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    // with a median window the raw readings are not what distance()
+    // reports, so update_samples() adds the filtered distance instead
+    if (median_filter != nullptr) {
+        return;
+    }
+#endif
+    push_sample(distance_m, time_us);
+}
+
+void AP_RangeFinder_Backend::push_sample(float distance_m, uint32_t time_us)
+{
+    samples[samples_added % RANGEFINDER_SAMPLE_BATCH_SIZE] = { time_us, distance_m };
+    samples_added++;
+}
+
+void AP_RangeFinder_Backend::set_sample_times(uint32_t seq, uint32_t start_us, uint32_t end_us)
+{
+    const uint32_t n = MIN(samples_added - seq, uint32_t(RANGEFINDER_SAMPLE_BATCH_SIZE));
+    const uint32_t span_us = end_us - start_us;
+    for (uint32_t i=0; i<n; i++) {
+        const uint32_t s = samples_added - n + i;
+        samples[s % RANGEFINDER_SAMPLE_BATCH_SIZE].time_us = start_us + uint64_t(span_us) * (i+1) / n;
+    }
+}
+
+void AP_RangeFinder_Backend::update_samples()
+{
+    if (samples_added == samples_added_at_update &&
+        state.last_reading_ms != samples_reading_ms &&
+        status() == RangeFinder::Status::Good) {
+        // already filtered and range checked
+        push_sample(state.distance_m, state.last_reading_ms * 1000U);
+    }
+    samples_added_at_update = samples_added;
+    samples_reading_ms = state.last_reading_ms;
+}
+
+uint8_t AP_RangeFinder_Backend::get_samples(uint32_t &seq, RangeFinder::SampleSpan spans[2]) const
+{
+    if (samples_added - seq > RANGEFINDER_SAMPLE_BATCH_SIZE) {
+        seq = samples_added - RANGEFINDER_SAMPLE_BATCH_SIZE;
+    }
+    uint16_t n = samples_added - seq;
+    uint8_t num_spans = 0;
+    while (n > 0) {
+        const uint16_t idx = seq % RANGEFINDER_SAMPLE_BATCH_SIZE;
+        const uint16_t count = MIN(n, uint16_t(RANGEFINDER_SAMPLE_BATCH_SIZE - idx));
+        spans[num_spans++] = { &samples[idx], count };
+        seq += count;
+        n -= count;
+    }
+    return num_spans;
+}
+#endif  // AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+
+// queue a reading in meters timestamped now. Called from the bus thread
+void AP_RangeFinder_Backend::queue_reading(ReadingQueue &queue, float distance_m)
+{
+    // if update() has stopped being called the newest readings are dropped
+    queue.push(distance_m, AP_HAL::micros64());
+}
+
+// get the mean of the readings queued since the last call and the time of the latest
+bool AP_RangeFinder_Backend::get_queued_reading(ReadingQueue &queue, float &distance_m, uint32_t &reading_ms)
+{
+    float distance;
+    uint64_t time_us;
+    float sum = 0;
+    uint16_t count = 0;
+    while (queue.pop(distance, time_us)) {
+        sum += distance;
+        count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+        add_sample(distance, uint32_t(time_us));
+#endif
+    }
+    if (count == 0) {
+        return false;
+    }
+    distance_m = sum / count;
+    // millis() is derived from the 64 bit clock, so this compares
+    // correctly with it after micros() has wrapped
+    reading_ms = uint32_t(time_us / 1000U);
+    return true;
+}
+
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+// allocate the median filter if RNGFNDx_MED_WIN is set. Called once
+// when the backend is added, never from the update path
+void AP_RangeFinder_Backend::init_median_filter(uint8_t instance)
+{
+    const uint8_t window = constrain_int16(params.median_window.get(), 0, SLIDING_QUANTILE_FILTER_MAX);
+    if (window <= 1 || median_filter != nullptr) {
+        return;
+    }
+    median_filter = new SlidingQuantileFilter();
+    if (median_filter == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "RangeFinder %u: no memory for median filter", unsigned(instance + 1));
+        return;
+    }
+    median_filter->set_window(window);
+}
+
+// replace the distance with the median of the last RNGFNDx_MED_WIN readings
+void AP_RangeFinder_Backend::apply_median_filter(RangeFinder::RangeFinder_State &state_arg)
+{
+    if (median_filter == nullptr) {
+        return;
+    }
+    // the window can be resized at runtime but enabling the filter needs a reboot
+    const uint8_t window = constrain_int16(params.median_window.get(), 1, SLIDING_QUANTILE_FILTER_MAX);
+    if (median_filter->get_window() != window) {
+        median_filter->set_window(window);
+    }
+    // some drivers update status more often than they get readings;
+    // the distance has already been filtered if so
+    if (state_arg.last_reading_ms == median_reading_ms && median_filter->count() > 0) {
+        return;
+    }
+    median_reading_ms = state_arg.last_reading_ms;
+    state_arg.distance_m = median_filter->apply(state_arg.distance_m);
+}
+#endif  // AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+
 // update status based on distance measurement
-void AP_RangeFinder_Backend::update_status(RangeFinder::RangeFinder_State &state_arg) const
+void AP_RangeFinder_Backend::update_status(RangeFinder::RangeFinder_State &state_arg)
 {
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    apply_median_filter(state_arg);
+#endif
+
     // check distance
     if (state_arg.distance_m > max_distance_cm() * 0.01f) {
         set_status(state_arg, RangeFinder::Status::OutOfRangeHigh);
@@ -80,6 +217,59 @@ void AP_RangeFinder_Backend::set_status(RangeFinder::RangeFinder_State &state_ar
     }
 }
 
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+void AP_RangeFinder_Backend::update_ground_contact()
+{
+    switch (status()) {
+    case RangeFinder::Status::Good:
+    case RangeFinder::Status::OutOfRangeLow:
+        // sensors often read below their minimum distance when the
+        // vehicle is on the ground, so those readings are kept
+        if (state.last_reading_ms != ground_contact_reading_ms) {
+            ground_contact_reading_ms = state.last_reading_ms;
+            ground_contact.update(state.distance_m, state.last_reading_ms, ground_clearance_cm());
+        }
+        break;
+    default:
+        ground_contact.reset();
+        break;
+    }
+}
+
+float AP_RangeFinder_Backend::ground_contact_confidence() const
+{
+    return ground_contact.confidence(AP_HAL::millis());
+}
+#endif  // AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+/*
+  estimate the noise from the second difference of consecutive good
+  readings, which is unaffected by climbing or descending at a steady
+  rate. For independent noise of variance v the second difference has
+  variance 6v
+ */
+void AP_RangeFinder_Backend::update_noise()
+{
+    if (status() != RangeFinder::Status::Good) {
+        noise_count = 0;
+        return;
+    }
+    if (state.last_reading_ms == noise_reading_ms) {
+        return;
+    }
+    noise_reading_ms = state.last_reading_ms;
+    if (noise_count >= 2) {
+        const float second_diff = state.distance_m - 2 * noise_distance_m[0] + noise_distance_m[1];
+        noise_var_m2 += (sq(second_diff) / 6.0f - noise_var_m2) * RANGEFINDER_FUSION_NOISE_ALPHA;
+    } else {
+        noise_count++;
+    }
+    noise_distance_m[1] = noise_distance_m[0];
+    noise_distance_m[0] = state.distance_m;
+}
+#endif  // AP_RANGEFINDER_FUSION_ENABLED
+
 #if AP_SCRIPTING_ENABLED
 // get a copy of state structure
 void AP_RangeFinder_Backend::get_state(RangeFinder::RangeFinder_State &state_arg)
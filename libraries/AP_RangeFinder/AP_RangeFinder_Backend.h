@@ -17,7 +17,10 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_HAL/Semaphores.h>
+#include <AP_HAL/utility/RingBuffer.h>
 #include "AP_RangeFinder.h"
+#include "AP_RangeFinder_GroundContact.h"
+#include <Filter/SlidingQuantileFilter.h>
 
 class AP_RangeFinder_Backend
 {
@@ -27,12 +30,21 @@ public:
 
     // we declare a virtual destructor so that RangeFinder drivers can
     // override with a custom destructor if need be
-    virtual ~AP_RangeFinder_Backend(void) {}
+    virtual ~AP_RangeFinder_Backend(void) {
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+        delete median_filter;
+#endif
+    }
 
     // update the state structure
     virtual void update() = 0;
     virtual void init_serial(uint8_t serial_instance) {};
 
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    // allocate the median filter if a window is configured
+    void init_median_filter(uint8_t instance);
+#endif
+
     virtual void handle_msg(const mavlink_message_t &msg) { return; }
 
 #if AP_SCRIPTING_ENABLED
@@ -79,10 +91,47 @@ public:
     // parameter value which may be changed at runtime.
     RangeFinder::Type allocated_type() const { return _backend_type; }
 
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    /*
+      get the readings added since seq without copying them, as up to
+      two spans of the sample ring, oldest first. seq is advanced past
+      the returned samples; a caller which has fallen more than
+      RANGEFINDER_SAMPLE_BATCH_SIZE behind skips the lost ones.
+      Returns the number of spans filled in. Must be called from the
+      thread which calls RangeFinder::update()
+     */
+    uint8_t get_samples(uint32_t &seq, RangeFinder::SampleSpan spans[2]) const;
+
+    // sequence number of the next sample to be added
+    uint32_t sample_seq() const { return samples_added; }
+
+    // called after update(): records the latest reading as a sample
+    // if the driver did not add its own
+    void update_samples();
+#endif
+
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+    // feed the latest reading to the ground contact classifier
+    void update_ground_contact();
+
+    // confidence from 0 to 1 that the sensor has settled at its ground clearance
+    float ground_contact_confidence() const;
+#endif
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+    // feed the latest reading to the noise estimate
+    void update_noise();
+
+    // variance of the reading to reading noise in m^2, used to weight
+    // this instance when fusing instances with the same orientation
+    float noise_variance_m2() const { return noise_var_m2; }
+#endif
+
 protected:
 
-    // update status based on distance measurement
-    void update_status(RangeFinder::RangeFinder_State &state_arg) const;
+    // update status based on distance measurement, after applying
+    // the median filter if it is enabled
+    void update_status(RangeFinder::RangeFinder_State &state_arg);
     void update_status() { update_status(state); }
 
     // set status and update valid_count
@@ -99,4 +148,59 @@ protected:
     RangeFinder::Type _backend_type;
 
     virtual MAV_DISTANCE_SENSOR _get_mav_distance_sensor_type() const = 0;
+
+    // readings handed from a driver's bus thread to update() without
+    // locking, so neither can hold up the other
+    typedef ObjectBuffer_SPSC<float, RANGEFINDER_READING_QUEUE_SIZE> ReadingQueue;
+
+    // queue a reading in meters timestamped now. Called from the bus thread
+    static void queue_reading(ReadingQueue &queue, float distance_m);
+
+    // get the mean of the readings queued since the last call and the
+    // time of the latest. Each reading is also added to the sample
+    // batch at its own time. Called from update(), returns false if
+    // nothing was queued
+    bool get_queued_reading(ReadingQueue &queue, float &distance_m, uint32_t &reading_ms);
+
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    // record an individual reading. Drivers which decode several
+    // readings per update() call this for each one. Readings outside
+    // the configured range, or any reading when a median window is set,
+    // are left out; update_samples() then adds the filtered distance
+    void add_sample(float distance_m, uint32_t time_us);
+
+    // store a sample in the batch without checking it
+    void push_sample(float distance_m, uint32_t time_us);
+
+    // set the time of samples from seq onwards, spacing them evenly
+    // up to end_us from start_us
+    void set_sample_times(uint32_t seq, uint32_t start_us, uint32_t end_us);
+#endif
+
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    void apply_median_filter(RangeFinder::RangeFinder_State &state_arg);
+
+    // allocated at boot if RNGFNDx_MED_WIN is set
+    SlidingQuantileFilter *median_filter = nullptr;
+    uint32_t median_reading_ms = 0;
+#endif
+
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    RangeFinder::Sample samples[RANGEFINDER_SAMPLE_BATCH_SIZE] {};
+    uint32_t samples_added = 0;
+    uint32_t samples_added_at_update = 0;
+    uint32_t samples_reading_ms = 0;
+#endif
+
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+    AP_RangeFinder_GroundContact ground_contact;
+    uint32_t ground_contact_reading_ms = 0;
+#endif
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+    float noise_var_m2 = RANGEFINDER_FUSION_NOISE_INIT_M * RANGEFINDER_FUSION_NOISE_INIT_M;
+    float noise_distance_m[2];      // previous two readings, most recent first
+    uint8_t noise_count = 0;        // number of consecutive good readings in noise_distance_m
+    uint32_t noise_reading_ms = 0;
+#endif
 };
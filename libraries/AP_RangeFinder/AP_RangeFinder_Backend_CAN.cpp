@@ -54,29 +54,14 @@ AP_RangeFinder_Backend_CAN::AP_RangeFinder_Backend_CAN(
 // update the state of the sensor
 void AP_RangeFinder_Backend_CAN::update(void)
 {
-    if (get_reading(state.distance_m)) {
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         // update range_valid state based on distance measured
-        state.last_reading_ms = AP_HAL::millis();
         update_status();
     } else if (AP_HAL::millis() - state.last_reading_ms >= read_timeout_ms()) {
         set_status(RangeFinder::Status::NoData);
     }
 }
 
-// get distance measurement
-bool AP_RangeFinder_Backend_CAN::get_reading(float &reading_m)
-{
-    WITH_SEMAPHORE(_sem);
-    if (_distance_count != 0) {
-        reading_m = _distance_sum / _distance_count;
-        _distance_sum = 0;
-        _distance_count = 0;
-        return true;
-    }
-
-    return false;
-}
-
 // return true if the CAN ID is correct
 bool AP_RangeFinder_Backend_CAN::is_correct_id(uint32_t id) const
 {
@@ -26,9 +26,6 @@ protected:
     // update state
     virtual void update(void) override;
 
-    // get distance measurement
-    bool get_reading(float &reading_m);
-
     // it is essential that anyone relying on the base-class update to implement this
     virtual bool handle_frame(AP_HAL::CANFrame &frame) = 0;
 
@@ -42,10 +39,9 @@ protected:
     // return true if the CAN ID is correct
     bool is_correct_id(uint32_t can_id) const;
 
-    // set distance and count
+    // queue a distance from the CAN thread
     void accumulate_distance_m(float distance_m) {
-        _distance_sum += distance_m;
-        _distance_count++;
+        queue_reading(readings, distance_m);
     };
 
     // linked list
@@ -55,10 +51,8 @@ protected:
     AP_Int32 snr_min; // minimum signal strength to accept packet
 
     MultiCAN* multican_rangefinder; // Allows for multiple CAN rangefinders on a single bus
-private:
 
-    float _distance_sum; // meters
-    uint32_t _distance_count;
+    ReadingQueue readings;  // distances from the CAN thread
 };
 
 #endif // HAL_MAX_CAN_PROTOCOL_DRIVERS
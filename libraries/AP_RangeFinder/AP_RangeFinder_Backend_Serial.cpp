@@ -52,6 +52,9 @@ uint32_t AP_RangeFinder_Backend_Serial::initial_baudrate(const uint8_t serial_in
 */
 void AP_RangeFinder_Backend_Serial::update(void)
 {
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    const uint32_t seq = sample_seq();
+#endif
     if (get_reading(state.distance_m)) {
         state.signal_quality_pct = get_signal_quality_pct();
         // update range_valid state based on distance measured
@@ -60,4 +63,14 @@ void AP_RangeFinder_Backend_Serial::update(void)
     } else if (AP_HAL::millis() - state.last_reading_ms > read_timeout_ms()) {
         set_status(RangeFinder::Status::NoData);
     }
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    // the readings queued by get_reading() arrived at some point since
+    // the last update; after a gap, assume they all arrived just now
+    const uint32_t now_us = AP_HAL::micros();
+    if (now_us - last_update_us > read_timeout_ms() * 1000U) {
+        last_update_us = now_us;
+    }
+    set_sample_times(seq, last_update_us, now_us);
+    last_update_us = now_us;
+#endif
 }
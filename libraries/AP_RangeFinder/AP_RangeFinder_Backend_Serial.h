@@ -37,4 +37,13 @@ protected:
 
     // maximum time between readings before we change state to NoData:
     virtual uint16_t read_timeout_ms() const { return 200; }
+
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+    // record each reading decoded by get_reading(). The readings are
+    // spread evenly over the time since the previous update()
+    void queue_sample(float distance_m) { add_sample(distance_m, 0); }
+
+private:
+    uint32_t last_update_us;
+#endif
 };
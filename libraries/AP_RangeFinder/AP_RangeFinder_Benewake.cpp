@@ -102,12 +102,18 @@ bool AP_RangeFinder_Benewake::get_reading(float &reading_m)
                         // no signal byte from TFmini so add distance to sum
                         sum_cm += dist;
                         count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+                        queue_sample(dist * 0.01f);
+#endif
                     } else {
                         // TF02 provides signal reliability (good = 7 or 8)
                         if (linebuf[6] >= 7) {
                             // add distance to sum
                             sum_cm += dist;
                             count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+                            queue_sample(dist * 0.01f);
+#endif
                         } else {
                             // this reading is out of range
                             count_out_of_range++;
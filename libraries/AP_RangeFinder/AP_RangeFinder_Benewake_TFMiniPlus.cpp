@@ -140,13 +140,7 @@ fail:
 
 void AP_RangeFinder_Benewake_TFMiniPlus::update()
 {
-    WITH_SEMAPHORE(_sem);
-
-    if (accum.count > 0) {
-        state.distance_m = (accum.sum * 0.01f) / accum.count;
-        state.last_reading_ms = AP_HAL::millis();
-        accum.sum = 0;
-        accum.count = 0;
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         update_status();
     } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
         set_status(RangeFinder::Status::NoData);
@@ -215,11 +209,7 @@ void AP_RangeFinder_Benewake_TFMiniPlus::timer()
 
     process_raw_measure(u.val.distance, u.val.strength, distance);
 
-    {
-        WITH_SEMAPHORE(_sem);
-        accum.sum += distance;
-        accum.count++;
-    }
+    queue_reading(readings, distance * 0.01f);
 }
 
 #endif  // AP_RANGEFINDER_BENEWAKE_TFMINIPLUS_ENABLED
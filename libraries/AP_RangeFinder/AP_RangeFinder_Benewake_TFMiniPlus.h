@@ -61,10 +61,7 @@ private:
 
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> _dev;
 
-    struct {
-        uint32_t sum;
-        uint32_t count;
-    } accum;
+    ReadingQueue readings;
 };
 
 #endif
@@ -83,16 +83,32 @@ AP_RangeFinder_DroneCAN* AP_RangeFinder_DroneCAN::get_dronecan_backend(AP_DroneC
 //Called from frontend to update with the readings received by handler
 void AP_RangeFinder_DroneCAN::update()
 {
-    WITH_SEMAPHORE(_sem);
+    // apply the measurements queued by the handler since the last update
+    Measurement m;
+    uint64_t time_us;
+    float sum = 0;
+    uint16_t count = 0;
+    while (measurements.pop(m, time_us)) {
+        _last_reading_ms = uint32_t(time_us / 1000U);
+        _status = m.status;
+        _sensor_type = m.sensor_type;
+        if (m.status == RangeFinder::Status::Good) {
+            sum += m.distance_m;
+            count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+            add_sample(m.distance_m, uint32_t(time_us));
+#endif
+        }
+    }
+
     if ((AP_HAL::millis() - _last_reading_ms) > 500) {
         //if data is older than 500ms, report NoData
         set_status(RangeFinder::Status::NoData);
-    } else if (_status == RangeFinder::Status::Good && new_data) {
+    } else if (_status == RangeFinder::Status::Good && count > 0) {
         //copy over states
-        state.distance_m = _distance_cm * 0.01f;
+        state.distance_m = sum / count;
         state.last_reading_ms = _last_reading_ms;
         update_status();
-        new_data = false;
     } else if (_status != RangeFinder::Status::Good) {
         //handle additional states received by measurement handler
         set_status(_status);
@@ -107,58 +123,56 @@ void AP_RangeFinder_DroneCAN::handle_measurement(AP_DroneCAN *ap_dronecan, const
     if (driver == nullptr) {
         return;
     }
-    WITH_SEMAPHORE(driver->_sem);
+    Measurement m {};
     switch (msg.reading_type) {
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_READING_TYPE_VALID_RANGE:
         {
-            //update the states in backend instance
-            driver->_distance_cm = msg.range*100.0f;
-            driver->_last_reading_ms = AP_HAL::millis();
-            driver->_status = RangeFinder::Status::Good;
-            driver->new_data = true;
+            m.distance_m = msg.range;
+            m.status = RangeFinder::Status::Good;
             break;
         }
         //Additional states supported by RFND message
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_READING_TYPE_TOO_CLOSE:
         {
-            driver->_last_reading_ms = AP_HAL::millis();
-            driver->_status = RangeFinder::Status::OutOfRangeLow;
+            m.status = RangeFinder::Status::OutOfRangeLow;
             break;
         }
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_READING_TYPE_TOO_FAR:
         {
-            driver->_last_reading_ms = AP_HAL::millis();
-            driver->_status = RangeFinder::Status::OutOfRangeHigh;
+            m.status = RangeFinder::Status::OutOfRangeHigh;
             break;
         }
         default:
         {
-            break;
+            return;
         }
     }
     //copy over the sensor type of Rangefinder 
     switch (msg.sensor_type) {
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_SENSOR_TYPE_SONAR:
         {
-            driver->_sensor_type = MAV_DISTANCE_SENSOR_ULTRASOUND;
+            m.sensor_type = MAV_DISTANCE_SENSOR_ULTRASOUND;
             break;
         }
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_SENSOR_TYPE_LIDAR:
         {
-            driver->_sensor_type = MAV_DISTANCE_SENSOR_LASER;
+            m.sensor_type = MAV_DISTANCE_SENSOR_LASER;
             break;
         }
         case UAVCAN_EQUIPMENT_RANGE_SENSOR_MEASUREMENT_SENSOR_TYPE_RADAR:
         {
-            driver->_sensor_type = MAV_DISTANCE_SENSOR_RADAR;
+            m.sensor_type = MAV_DISTANCE_SENSOR_RADAR;
             break;
         }
         default:
         {
-            driver->_sensor_type = MAV_DISTANCE_SENSOR_UNKNOWN;
+            m.sensor_type = MAV_DISTANCE_SENSOR_UNKNOWN;
             break;
         }
     }
+    // handed to update() on the main thread without locking. If
+    // update() has stopped being called the newest measurements are dropped
+    driver->measurements.push(m, AP_HAL::micros64());
 }
 
 #endif  // AP_RANGEFINDER_DRONECAN_ENABLED
@@ -27,13 +27,19 @@ protected:
         return _sensor_type;
     }
 private:
+    // a measurement handed from the CAN thread to update()
+    struct Measurement {
+        float distance_m;
+        RangeFinder::Status status;
+        MAV_DISTANCE_SENSOR sensor_type;
+    };
+    ObjectBuffer_SPSC<Measurement, RANGEFINDER_READING_QUEUE_SIZE> measurements;
+
     uint8_t _instance;
     RangeFinder::Status _status;
-    uint16_t _distance_cm;
     uint32_t _last_reading_ms;
     AP_DroneCAN* _ap_dronecan;
     uint8_t _node_id;
-    bool new_data;
     MAV_DISTANCE_SENSOR _sensor_type;
 };
 #endif  // AP_RANGEFINDER_DRONECAN_ENABLED
@@ -0,0 +1,168 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_RangeFinder_GroundContact.h"
+
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+// half width of the band around the ground clearance which counts as
+// being on the ground, before allowing for sensor resolution
+#define GROUND_CONTACT_BAND_MM          50
+
+// standard deviation and rate of change at which confidence falls to zero
+#define GROUND_CONTACT_SIGMA_MAX_MM     30
+#define GROUND_CONTACT_SLOPE_MAX_MS     0.25f
+
+void AP_RangeFinder_GroundContact::reset()
+{
+    head = 0;
+    count = 0;
+    sum = 0;
+    sum_sq = 0;
+    sum_ix = 0;
+    n_below = 0;
+    n_above = 0;
+}
+
+// returns -1 below the band, 1 above it and 0 within it
+int8_t AP_RangeFinder_GroundContact::classify(int32_t mm) const
+{
+    if (mm < band_low_mm) {
+        return -1;
+    }
+    if (mm > band_high_mm) {
+        return 1;
+    }
+    return 0;
+}
+
+void AP_RangeFinder_GroundContact::set_band(int16_t gnd_clear_cm)
+{
+    band_gnd_clear_cm = gnd_clear_cm;
+    const int32_t half_width = MAX(GROUND_CONTACT_BAND_MM, 2 * quantum_mm);
+    band_low_mm = gnd_clear_cm * 10 - half_width;
+    band_high_mm = gnd_clear_cm * 10 + half_width;
+    recount();
+}
+
+// only needed when the band moves, which is rare
+void AP_RangeFinder_GroundContact::recount()
+{
+    n_below = 0;
+    n_above = 0;
+    for (uint8_t i=0; i<count; i++) {
+        const int8_t c = classify(sample_mm[(head + i) % N]);
+        n_below += c < 0;
+        n_above += c > 0;
+    }
+}
+
+void AP_RangeFinder_GroundContact::update(float distance_m, uint32_t time_ms, int16_t gnd_clear_cm)
+{
+    const int32_t x = lrintf(distance_m * 1000);
+
+    bool band_changed = gnd_clear_cm != band_gnd_clear_cm;
+    if (count > 0) {
+        const int32_t step = abs(x - last_mm);
+        if (step > 0 && (quantum_mm == 0 || step < quantum_mm)) {
+            quantum_mm = step;
+            band_changed = true;
+        }
+    }
+    last_mm = x;
+    if (band_changed) {
+        set_band(gnd_clear_cm);
+    }
+
+    if (count < N) {
+        const uint8_t idx = (head + count) % N;
+        sample_mm[idx] = x;
+        sample_ms[idx] = time_ms;
+        sum_ix += int64_t(count) * x;
+        sum += x;
+        sum_sq += int64_t(x) * x;
+        count++;
+    } else {
+        // drop the oldest reading; every remaining reading moves down
+        // one index, which takes their sum off sum_ix
+        const int32_t x0 = sample_mm[head];
+        sum_ix += int64_t(N-1) * x - (sum - x0);
+        sum += x - x0;
+        sum_sq += int64_t(x) * x - int64_t(x0) * x0;
+        const int8_t c0 = classify(x0);
+        n_below -= c0 < 0;
+        n_above -= c0 > 0;
+        sample_mm[head] = x;
+        sample_ms[head] = time_ms;
+        head = (head + 1) % N;
+    }
+
+    const int8_t c = classify(x);
+    n_below += c < 0;
+    n_above += c > 0;
+}
+
+float AP_RangeFinder_GroundContact::variance_m2() const
+{
+    if (count < 2) {
+        return 0;
+    }
+    // exact in integers, then remove the variance of the rounding
+    // error of a sensor with this resolution
+    const int64_t n_var = int64_t(count) * sum_sq - sum * sum;
+    const float var_mm2 = float(n_var) / (float(count) * count) - sq(float(quantum_mm)) / 12;
+    return MAX(var_mm2, 0) * 1.0e-6f;
+}
+
+float AP_RangeFinder_GroundContact::slope_ms() const
+{
+    if (count < 2) {
+        return 0;
+    }
+    const uint32_t span_ms = sample_ms[(head + count - 1) % N] - sample_ms[head];
+    if (span_ms == 0) {
+        return 0;
+    }
+    // least squares slope against index i=0..n-1 in mm per reading
+    const float n = count;
+    const float sxx = n * (sq(n) - 1) / 12;
+    const float sxy = sum_ix - 0.5f * (n - 1) * sum;
+    const float mm_per_reading = sxy / sxx;
+    // mm/ms is m/s
+    return mm_per_reading * (n - 1) / span_ms;
+}
+
+float AP_RangeFinder_GroundContact::confidence(uint32_t now_ms) const
+{
+    if (count < N) {
+        return 0;
+    }
+    const uint32_t newest_ms = sample_ms[(head + N - 1) % N];
+    if (now_ms - newest_ms > RANGEFINDER_GROUND_CONTACT_TIMEOUT_MS) {
+        return 0;
+    }
+    // the median must be within the band
+    if (n_below * 2 >= N || n_above * 2 >= N) {
+        return 0;
+    }
+    const float in_band = float(N - n_below - n_above) / N;
+    const float steady = constrain_float(1 - sqrtf(variance_m2()) / (GROUND_CONTACT_SIGMA_MAX_MM * 0.001f), 0, 1);
+    const float level = constrain_float(1 - fabsf(slope_ms()) / GROUND_CONTACT_SLOPE_MAX_MS, 0, 1);
+    return in_band * steady * level;
+}
+
+#endif  // AP_RANGEFINDER_GROUND_CONTACT_ENABLED
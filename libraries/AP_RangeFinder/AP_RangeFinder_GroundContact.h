@@ -0,0 +1,95 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_RangeFinder_config.h"
+
+#if AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+
+#include <stdint.h>
+
+// number of readings the classifier looks at
+#ifndef RANGEFINDER_GROUND_CONTACT_WINDOW
+#define RANGEFINDER_GROUND_CONTACT_WINDOW 16
+#endif
+
+// readings older than this give no confidence
+#define RANGEFINDER_GROUND_CONTACT_TIMEOUT_MS 500
+
+/*
+  classify whether a downward rangefinder has settled at the vehicle's
+  ground clearance, i.e. whether the vehicle is sitting on the ground.
+
+  Each reading updates running sums over a fixed window, so variance,
+  slope (a least-squares fit against sample index) and the number of
+  readings below, within and above the ground clearance band are all
+  maintained in constant time. The median lies within the band exactly
+  when fewer than half the readings are on either side of it, so the
+  median test needs no sort. The band and the variance are widened by
+  the sensor's resolution, learnt as the smallest non-zero step between
+  readings, so that sensors reporting in whole centimetres or coarser
+  are not penalised for their quantisation.
+ */
+class AP_RangeFinder_GroundContact
+{
+public:
+    // add a reading. gnd_clear_cm is the instance's ground clearance
+    void update(float distance_m, uint32_t time_ms, int16_t gnd_clear_cm);
+
+    // forget all readings, e.g. when the sensor stops reporting
+    void reset();
+
+    // confidence from 0 to 1 that the rangefinder has settled at the
+    // ground clearance. Zero until the window is full or if the last
+    // reading is older than RANGEFINDER_GROUND_CONTACT_TIMEOUT_MS
+    float confidence(uint32_t now_ms) const;
+
+    // statistics over the window, for logging and tuning
+    float variance_m2() const;
+    float slope_ms() const;
+
+private:
+    static constexpr uint8_t N = RANGEFINDER_GROUND_CONTACT_WINDOW;
+
+    // classify a reading against the current band
+    int8_t classify(int32_t mm) const;
+    void set_band(int16_t gnd_clear_cm);
+    void recount();
+
+    // readings in millimetres, oldest at head once the window is full
+    int32_t sample_mm[N] {};
+    uint32_t sample_ms[N] {};
+    uint8_t head = 0;
+    uint8_t count = 0;
+
+    // running sums over the window
+    int64_t sum = 0;             // sum of x
+    int64_t sum_sq = 0;          // sum of x^2
+    int64_t sum_ix = 0;          // sum of i*x, with i=0 for the oldest reading
+
+    // readings below and above the ground clearance band
+    uint8_t n_below = 0;
+    uint8_t n_above = 0;
+
+    // smallest non-zero step between readings seen so far
+    int32_t quantum_mm = 0;
+    int32_t last_mm = 0;
+
+    int16_t band_gnd_clear_cm = -1;
+    int32_t band_low_mm = 0;
+    int32_t band_high_mm = 0;
+};
+
+#endif  // AP_RANGEFINDER_GROUND_CONTACT_ENABLED
@@ -460,26 +460,28 @@ bool AP_RangeFinder_LightWareI2C::sf20_parse_stream(uint8_t *stream_buf,
 */
 void AP_RangeFinder_LightWareI2C::update(void)
 {
-    // nothing to do - its all done in the timer()
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
+        // update range_valid state based on distance measured
+        update_status();
+    } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
+        // if no updates for 0.2s set no-data
+        set_status(RangeFinder::Status::NoData);
+    }
 }
 
 void AP_RangeFinder_LightWareI2C::legacy_timer(void)
 {
-    if (legacy_get_reading(state.distance_m)) {
-        // update range_valid state based on distance measured
-        update_status();
-    } else {
-        set_status(RangeFinder::Status::NoData);
+    float reading_m;
+    if (legacy_get_reading(reading_m)) {
+        queue_reading(readings, reading_m);
     }
 }
 
 void AP_RangeFinder_LightWareI2C::sf20_timer(void)
 {
-    if (sf20_get_reading(state.distance_m)) {
-        // update range_valid state based on distance measured
-        update_status();
-    } else {
-        set_status(RangeFinder::Status::NoData);
+    float reading_m;
+    if (sf20_get_reading(reading_m)) {
+        queue_reading(readings, reading_m);
     }
 }
 
@@ -62,6 +62,7 @@ private:
                            uint16_t &val);
     void data_log(uint16_t *val);
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> _dev;
+    ReadingQueue readings;
 };
 
 #endif  // AP_RANGEFINDER_LWI2C_ENABLED
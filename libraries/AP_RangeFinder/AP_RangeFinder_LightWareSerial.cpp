@@ -53,6 +53,9 @@ bool AP_RangeFinder_LightWareSerial::get_reading(float &reading_m)
                 if (!is_negative(dist) && !is_lost_signal_distance(dist * 100, distance_cm_max)) {
                     sum += dist;
                     valid_count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+                    queue_sample(dist);
+#endif
                     // if still determining protocol update legacy valid count
                     if (protocol_state == ProtocolState::UNKNOWN) {
                         legacy_valid_count++;
@@ -84,6 +87,9 @@ bool AP_RangeFinder_LightWareSerial::get_reading(float &reading_m)
                     if (dist >= 0 && !is_lost_signal_distance(dist, distance_cm_max)) {
                         sum += dist * 0.01f;
                         valid_count++;
+#if AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+                        queue_sample(dist * 0.01f);
+#endif
                         // if still determining protocol update binary valid count
                         if (protocol_state == ProtocolState::UNKNOWN) {
                             binary_valid_count++;
@@ -131,10 +131,7 @@ void AP_RangeFinder_MaxsonarI2CXL::_timer(void)
 {
     uint16_t d;
     if (get_reading(d)) {
-        WITH_SEMAPHORE(_sem);
-        distance = d;
-        new_distance = true;
-        state.last_reading_ms = AP_HAL::millis();
+        queue_reading(readings, d * 0.01f);
     }
 }
 
@@ -143,10 +140,7 @@ void AP_RangeFinder_MaxsonarI2CXL::_timer(void)
 */
 void AP_RangeFinder_MaxsonarI2CXL::update(void)
 {
-    WITH_SEMAPHORE(_sem);
-    if (new_distance) {
-        state.distance_m = distance * 0.01f;
-        new_distance = false;
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         update_status();
     } else if (AP_HAL::millis() - state.last_reading_ms > 300) {
         // if no updates for 0.3 seconds set no-data
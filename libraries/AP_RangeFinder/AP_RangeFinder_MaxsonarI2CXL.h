@@ -38,8 +38,7 @@ private:
     bool _init(void);
     void _timer(void);
 
-    uint16_t distance;
-    bool new_distance;
+    ReadingQueue readings;
     
     // start a reading
     bool start_reading(void);
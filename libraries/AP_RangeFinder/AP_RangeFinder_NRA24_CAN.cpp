@@ -9,13 +9,11 @@
 // update the state of the sensor
 void AP_RangeFinder_NRA24_CAN::update(void)
 {
-    WITH_SEMAPHORE(_sem);
-    if (get_reading(state.distance_m)) {
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         // update range_valid state based on distance measured
-        state.last_reading_ms = AP_HAL::millis();
         update_status();
     } else if (AP_HAL::millis() - state.last_reading_ms > read_timeout_ms()) {
-        if (AP_HAL::millis() - last_heartbeat_ms > read_timeout_ms()) {
+        if (AP_HAL::millis() - last_heartbeat_ms.load(std::memory_order_relaxed) > read_timeout_ms()) {
             // no heartbeat, must be disconnected
             set_status(RangeFinder::Status::NotConnected);
         } else {
@@ -29,7 +27,6 @@ void AP_RangeFinder_NRA24_CAN::update(void)
 // handler for incoming frames
 bool AP_RangeFinder_NRA24_CAN::handle_frame(AP_HAL::CANFrame &frame)
 {
-    WITH_SEMAPHORE(_sem);
     const uint32_t id = frame.id;
 
     if (!is_correct_id(get_radar_id(id))) {
@@ -39,7 +36,7 @@ bool AP_RangeFinder_NRA24_CAN::handle_frame(AP_HAL::CANFrame &frame)
     switch (id & 0xFU) {
         case 0xAU:
             // heart beat in the form of Radar Status. The contents of this message aren't really useful so we won't parse them for now
-            last_heartbeat_ms = AP_HAL::millis();
+            last_heartbeat_ms.store(AP_HAL::millis(), std::memory_order_relaxed);
             break;
 
         case 0xCU:
@@ -3,6 +3,7 @@
 
 #if AP_RANGEFINDER_NRA24_CAN_ENABLED
 #include "AP_RangeFinder_Backend_CAN.h"
+#include <atomic>
 
 class AP_RangeFinder_NRA24_CAN : public AP_RangeFinder_Backend_CAN {
 public:
@@ -21,7 +22,7 @@ public:
 private:
 
     uint32_t get_radar_id(uint32_t id) const { return ((id & 0xF0U) >> 4U); }
-    uint32_t last_heartbeat_ms; // last status message received from the sensor
+    std::atomic<uint32_t> last_heartbeat_ms{0}; // last status message received from the sensor, written by the CAN thread
 };
 
 #endif  // AP_RANGEFINDER_USD1_CAN_ENABLED
@@ -93,6 +93,17 @@ const AP_Param::GroupInfo AP_RangeFinder_Params::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("GNDCLEAR", 12, AP_RangeFinder_Params, ground_clearance_cm, RANGEFINDER_GROUND_CLEARANCE_CM_DEFAULT),
 
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    // @Param: MED_WIN
+    // @DisplayName: Rangefinder median filter length
+    // @Description: Number of readings over which the median distance is taken before the reading is range checked and used. This removes single spikes and dropouts at the cost of a delay of half the window. 0 or 1 disables the filter
+    // @Range: 0 64
+    // @Increment: 1
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("MED_WIN", 13, AP_RangeFinder_Params, median_window, 0),
+#endif
+
     // @Param: ADDR
     // @DisplayName: Bus address of sensor
     // @Description: This sets the bus address of the sensor, where applicable. Used for the I2C and DroneCAN sensors to allow for multiple sensors on different addresses.
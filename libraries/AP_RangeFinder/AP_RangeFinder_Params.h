@@ -2,6 +2,7 @@
 
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
+#include "AP_RangeFinder_config.h"
 
 class AP_RangeFinder_Params {
 public:
@@ -26,4 +27,7 @@ public:
     AP_Int8  ground_clearance_cm;
     AP_Int8  address;
     AP_Int8  orientation;
+#if AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+    AP_Int8  median_window;
+#endif
 };
@@ -93,13 +93,9 @@ void AP_RangeFinder_PulsedLightLRF::timer(void)
             uint16_t _distance_cm = be16toh(val);
             // remove momentary spikes
             if (abs(_distance_cm - last_distance_cm) < 100) {
-                state.distance_m = _distance_cm * 0.01f;
-                state.last_reading_ms = AP_HAL::millis();
-                update_status();                
+                queue_reading(readings, _distance_cm * 0.01f);
             }
             last_distance_cm = _distance_cm;
-        } else {
-            set_status(RangeFinder::Status::NoData);
         }
         if (!v2_hardware) {
             // for v2 hw we use continuous mode
@@ -120,6 +116,19 @@ void AP_RangeFinder_PulsedLightLRF::timer(void)
 }
 
 
+/*
+   update the state of the sensor
+*/
+void AP_RangeFinder_PulsedLightLRF::update(void)
+{
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
+        update_status();
+    } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
+        // if no updates for 0.2s set no-data
+        set_status(RangeFinder::Status::NoData);
+    }
+}
+
 /*
   a table of settings for a lidar
  */
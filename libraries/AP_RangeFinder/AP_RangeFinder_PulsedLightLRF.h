@@ -30,7 +30,7 @@ public:
                                           RangeFinder::Type rftype);
 
     // update state
-    void update(void) override {}
+    void update(void) override;
 
 protected:
 
@@ -59,6 +59,7 @@ private:
     bool v3hp_hardware;
     uint16_t last_distance_cm;
     RangeFinder::Type rftype;
+    ReadingQueue readings;
     
     enum { PHASE_MEASURE, PHASE_COLLECT } phase;
 };
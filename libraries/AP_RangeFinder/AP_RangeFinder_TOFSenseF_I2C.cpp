@@ -131,24 +131,16 @@ void AP_RangeFinder_TOFSenseF_I2C::timer(void)
     uint16_t status;
     uint16_t signal_strength;
 
-    if (get_reading(dist_mm, signal_strength, status)) {
-        WITH_SEMAPHORE(_sem);
-        if (status == 1) {
-            // healthy data
-            distance_mm = dist_mm;
-            new_distance = true;
-            state.last_reading_ms = AP_HAL::millis();
-        }
+    if (get_reading(dist_mm, signal_strength, status) && (status == 1)) {
+        // healthy data
+        queue_reading(readings, dist_mm * 0.001f);
     }
 }
 
 // update the state of the sensor
 void AP_RangeFinder_TOFSenseF_I2C::update(void)
 {
-    WITH_SEMAPHORE(_sem);
-    if (new_distance) {
-        state.distance_m = distance_mm * 0.001f;
-        new_distance = false;
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         update_status();
     } else if (AP_HAL::millis() - state.last_reading_ms > 300) {
         // if no updates for 0.3 seconds set no-data
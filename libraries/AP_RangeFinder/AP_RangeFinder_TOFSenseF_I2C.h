@@ -37,8 +37,7 @@ private:
     bool init(void);
     void timer(void);
 
-    uint32_t distance_mm;
-    bool new_distance; // true if we have a new distance
+    ReadingQueue readings;
 
     // get a reading
     bool start_reading(void);
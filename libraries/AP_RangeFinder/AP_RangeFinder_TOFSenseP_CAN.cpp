@@ -10,7 +10,6 @@
 // handler for incoming frames. These come in at 10-30Hz
 bool AP_RangeFinder_TOFSenseP_CAN::handle_frame(AP_HAL::CANFrame &frame)
 {
-    WITH_SEMAPHORE(_sem);
     const uint32_t id = frame.id - 0x200U;
 
     if (!is_correct_id(id)) {
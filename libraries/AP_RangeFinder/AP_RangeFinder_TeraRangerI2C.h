@@ -40,10 +40,7 @@ private:
     void timer(void);
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> dev;
 
-    struct {
-        uint32_t sum;
-        uint32_t count;
-    } accum;
+    ReadingQueue readings;
 };
 
 #endif  // AP_RANGEFINDER_TRI2C_ENABLED
@@ -7,7 +7,6 @@
 // handler for incoming frames. These come in at 100Hz
 bool AP_RangeFinder_USD1_CAN::handle_frame(AP_HAL::CANFrame &frame)
 {
-    WITH_SEMAPHORE(_sem);
     const uint16_t id = frame.id & AP_HAL::CANFrame::MaskStdID;
 
     if (!is_correct_id(id)) {
@@ -763,11 +763,7 @@ uint16_t AP_RangeFinder_VL53L0X::read_register16(uint8_t reg)
 */
 void AP_RangeFinder_VL53L0X::update(void)
 {
-    if (counter > 0) {
-        state.distance_m = (sum_mm * 0.001f) / counter;
-        state.last_reading_ms = AP_HAL::millis();
-        sum_mm = 0;
-        counter = 0;
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         update_status();
     } else {
         set_status(RangeFinder::Status::NoData);
@@ -778,8 +774,7 @@ void AP_RangeFinder_VL53L0X::timer(void)
 {
     uint16_t range_mm;
     if (get_reading(range_mm) && range_mm < 8000) {
-        sum_mm += range_mm;
-        counter++;
+        queue_reading(readings, range_mm * 0.001f);
     }
 }
 
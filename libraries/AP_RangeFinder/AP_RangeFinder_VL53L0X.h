@@ -81,8 +81,7 @@ private:
     uint32_t measurement_timing_budget_us;
     uint32_t start_ms;
 
-    uint32_t sum_mm;
-    uint32_t counter;
+    ReadingQueue readings;
 };
 
 #endif  // AP_RANGEFINDER_VL53L0X_ENABLED
@@ -557,9 +557,7 @@ void AP_RangeFinder_VL53L1X::timer(void)
 {
     uint16_t range_mm;
     if ((get_reading(range_mm)) && (range_mm <= 4000)) {
-        WITH_SEMAPHORE(_sem);
-        sum_mm += range_mm;
-        counter++;
+        queue_reading(readings, range_mm * 0.001f);
     }
 }
 
@@ -568,13 +566,8 @@ void AP_RangeFinder_VL53L1X::timer(void)
 */
 void AP_RangeFinder_VL53L1X::update(void)
 {
-    WITH_SEMAPHORE(_sem);
-    if (counter > 0) {
-        state.distance_m = (sum_mm * 0.001f) / counter;
-        state.last_reading_ms = AP_HAL::millis();
+    if (get_queued_reading(readings, state.distance_m, state.last_reading_ms)) {
         update_status();
-        sum_mm = 0;
-        counter = 0;
     } else if (AP_HAL::millis() - state.last_reading_ms > 200) {
         // if no updates for 0.2s set no-data
         set_status(RangeFinder::Status::NoData);
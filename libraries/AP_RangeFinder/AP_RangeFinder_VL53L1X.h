@@ -1276,8 +1276,7 @@ private:
 
     uint16_t fast_osc_frequency;
     uint16_t osc_calibrate_val;
-    uint32_t sum_mm;
-    uint32_t counter;
+    ReadingQueue readings;
     bool calibrated;
 
     bool read_register(uint16_t reg, uint8_t &value) WARN_IF_UNUSED;
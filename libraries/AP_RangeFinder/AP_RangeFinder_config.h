@@ -65,6 +65,14 @@
 #define AP_RANGEFINDER_DRONECAN_ENABLED (HAL_ENABLE_DRONECAN_DRIVERS && AP_RANGEFINDER_BACKEND_DEFAULT_ENABLED)
 #endif
 
+#ifndef AP_RANGEFINDER_FUSION_ENABLED
+#define AP_RANGEFINDER_FUSION_ENABLED AP_RANGEFINDER_ENABLED
+#endif
+
+#ifndef AP_RANGEFINDER_GROUND_CONTACT_ENABLED
+#define AP_RANGEFINDER_GROUND_CONTACT_ENABLED AP_RANGEFINDER_ENABLED
+#endif
+
 #ifndef AP_RANGEFINDER_GYUS42V2_ENABLED
 #define AP_RANGEFINDER_GYUS42V2_ENABLED AP_RANGEFINDER_BACKEND_DEFAULT_ENABLED
 #endif
@@ -113,6 +121,10 @@
 #define HAL_MSP_RANGEFINDER_ENABLED HAL_MSP_ENABLED
 #endif
 
+#ifndef AP_RANGEFINDER_MEDIAN_FILTER_ENABLED
+#define AP_RANGEFINDER_MEDIAN_FILTER_ENABLED AP_RANGEFINDER_ENABLED
+#endif
+
 #ifndef AP_RANGEFINDER_NMEA_ENABLED
 #define AP_RANGEFINDER_NMEA_ENABLED AP_RANGEFINDER_BACKEND_DEFAULT_ENABLED
 #endif
@@ -137,6 +149,10 @@
 #define AP_RANGEFINDER_RDS02UF_ENABLED AP_RANGEFINDER_BACKEND_DEFAULT_ENABLED && BOARD_FLASH_SIZE > 1024
 #endif
 
+#ifndef AP_RANGEFINDER_SAMPLE_BATCH_ENABLED
+#define AP_RANGEFINDER_SAMPLE_BATCH_ENABLED (AP_RANGEFINDER_ENABLED && BOARD_FLASH_SIZE > 1024)
+#endif
+
 #ifndef AP_RANGEFINDER_SIM_ENABLED
 #define AP_RANGEFINDER_SIM_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL && AP_RANGEFINDER_BACKEND_DEFAULT_ENABLED)
 #endif
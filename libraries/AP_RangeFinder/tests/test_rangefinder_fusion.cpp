@@ -0,0 +1,125 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AP_RangeFinder/AP_RangeFinder.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_RANGEFINDER_FUSION_ENABLED
+
+TEST(RangeFinderFusion, no_readings)
+{
+    RangeFinder::Fused fused {};
+    fused.distance_m = 2.0f;
+    EXPECT_FALSE(RangeFinder::fuse(nullptr, 0, 1000, fused));
+    EXPECT_FLOAT_EQ(fused.distance_m, 2.0f);
+}
+
+TEST(RangeFinderFusion, noise_weights)
+{
+    // weighted by inverse variance: 100 and 25
+    const RangeFinder::FusionInput inputs[] {
+        { 1.0f, 0.01f, 990, 10 },
+        { 1.2f, 0.04f, 995, 10 },
+    };
+    RangeFinder::Fused fused {};
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000, fused));
+    EXPECT_NEAR(fused.distance_m, 1.04f, 1e-5f);
+    EXPECT_EQ(fused.num_used, 2U);
+    EXPECT_EQ(fused.num_rejected, 0U);
+    EXPECT_EQ(fused.last_reading_ms, 995U);
+    EXPECT_EQ(fused.range_valid_count, 10U);
+}
+
+TEST(RangeFinderFusion, valid_count_weights)
+{
+    // an instance which has only just become healthy counts for less
+    const RangeFinder::FusionInput inputs[] {
+        { 1.0f, 0.01f, 1000, 10 },
+        { 1.3f, 0.01f, 1000, 5 },
+    };
+    RangeFinder::Fused fused {};
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000, fused));
+    EXPECT_NEAR(fused.distance_m, 1.1f, 1e-5f);
+}
+
+TEST(RangeFinderFusion, median_rejects_outlier)
+{
+    const RangeFinder::FusionInput inputs[] {
+        { 1.0f, 0.01f, 1000, 10 },
+        { 3.0f, 0.01f, 1000, 10 },
+        { 1.1f, 0.01f, 1000, 10 },
+    };
+    RangeFinder::Fused fused {};
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000, fused));
+    EXPECT_NEAR(fused.distance_m, 1.05f, 1e-5f);
+    EXPECT_EQ(fused.num_used, 2U);
+    EXPECT_EQ(fused.num_rejected, 1U);
+}
+
+TEST(RangeFinderFusion, timeout_fallback)
+{
+    // the quieter instance jumps away from the previous result
+    const RangeFinder::FusionInput inputs[] {
+        { 1.1f, 0.04f, 1000, 10 },
+        { 2.0f, 0.01f, 1000, 10 },
+    };
+    RangeFinder::Fused previous {};
+    previous.distance_m = 1.0f;
+    previous.last_reading_ms = 1000;
+
+    // a recent result is the reference so the jump is rejected
+    RangeFinder::Fused fused = previous;
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000 + RANGEFINDER_FUSION_TIMEOUT_MS - 1, fused));
+    EXPECT_NEAR(fused.distance_m, 1.1f, 1e-5f);
+    EXPECT_EQ(fused.num_rejected, 1U);
+
+    // once it has timed out the quietest instance is the reference
+    fused = previous;
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000 + RANGEFINDER_FUSION_TIMEOUT_MS, fused));
+    EXPECT_NEAR(fused.distance_m, 2.0f, 1e-5f);
+    EXPECT_EQ(fused.num_rejected, 1U);
+
+    // if every reading is rejected the quietest becomes the reference
+    fused = previous;
+    fused.distance_m = 5.0f;
+    ASSERT_TRUE(RangeFinder::fuse(inputs, ARRAY_SIZE(inputs), 1000, fused));
+    EXPECT_NEAR(fused.distance_m, 2.0f, 1e-5f);
+}
+
+TEST(RangeFinderFusion, position_offset)
+{
+    Matrix3f body_to_ned;
+    body_to_ned.identity();
+
+    // a downward sensor 0.1m below the origin reads 0.1m short
+    EXPECT_NEAR(RangeFinder::distance_from_origin(1.0f, ROTATION_PITCH_270, Vector3f(0.2f, 0, 0.1f), body_to_ned), 1.1f, 1e-5f);
+    // an upward sensor 0.1m below the origin reads 0.1m long
+    EXPECT_NEAR(RangeFinder::distance_from_origin(1.0f, ROTATION_PITCH_90, Vector3f(0, 0, 0.1f), body_to_ned), 0.9f, 1e-5f);
+
+    // rolled 30 degrees a sensor out on the right is lower than the origin
+    body_to_ned.from_euler(radians(30), 0, 0);
+    const Vector3f offset {0, 0.2f, 0};
+    const float expected = 1.0f + 0.2f * sinf(radians(30)) / cosf(radians(30));
+    EXPECT_NEAR(RangeFinder::distance_from_origin(1.0f, ROTATION_PITCH_270, offset, body_to_ned), expected, 1e-5f);
+
+    // sideways sensors are not corrected
+    EXPECT_NEAR(RangeFinder::distance_from_origin(1.0f, ROTATION_NONE, Vector3f(0, 0, 0.1f), body_to_ned), 1.0f, 1e-5f);
+}
+
+TEST(RangeFinderFusion, relative_offset)
+{
+    Matrix3f body_to_ned;
+    body_to_ned.identity();
+
+    // a primary 0.05m below the origin and a second sensor 0.15m below
+    // it see the same ground, 1m below the primary
+    const Vector3f primary {0, 0, 0.05f};
+    const Vector3f second {0.3f, 0, 0.15f};
+    EXPECT_NEAR(RangeFinder::distance_from_origin(1.0f, ROTATION_PITCH_270, primary - primary, body_to_ned), 1.0f, 1e-5f);
+    EXPECT_NEAR(RangeFinder::distance_from_origin(0.9f, ROTATION_PITCH_270, second - primary, body_to_ned), 1.0f, 1e-5f);
+}
+
+#endif // AP_RANGEFINDER_FUSION_ENABLED
+
+AP_GTEST_MAIN()
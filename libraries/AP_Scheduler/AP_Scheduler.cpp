@@ -431,6 +431,9 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+        Log_Write_Task_Histograms();
+#endif
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -465,13 +468,57 @@ void AP_Scheduler::Log_Write_Performance()
     };
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
+
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+// write a latency histogram summary for each task that has run since the last
+// reset, if per-task perf info is being recorded, followed by one for the loop
+void AP_Scheduler::Log_Write_Task_Histograms()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    uint8_t vehicle_tasks_offset = 0;
+    uint8_t common_tasks_offset = 0;
+    for (uint8_t i = 0; i < _num_tasks; i++) {
+        const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
+        const char *task_name = next_task_name(vehicle_tasks_offset, common_tasks_offset);
+        if (ti == nullptr || task_name == nullptr) {
+            break;
+        }
+        if (ti->tick_count > 0) {
+            Log_Write_Task_Histogram(now_us, i, task_name, ti->histogram, ti->tick_count, ti->max_time_us);
+        }
+    }
+    Log_Write_Task_Histogram(now_us, UINT8_MAX, "loop", perf_info.get_loop_histogram(),
+                             perf_info.get_num_loops(), MIN(perf_info.get_max_time(), uint32_t(UINT16_MAX)));
+}
+
+void AP_Scheduler::Log_Write_Task_Histogram(uint64_t time_us, uint8_t task_id, const char *name, const AP::PerfInfo::Histogram &histogram, uint32_t count, uint16_t max_us)
+{
+    struct log_TaskHistogram pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_TASK_HISTOGRAM_MSG),
+        time_us : time_us,
+        task_id : task_id,
+        count   : count,
+        // percentiles are bucket upper bounds so are limited to the largest time seen
+        p50_us  : MIN(histogram.percentile(50), max_us),
+        p95_us  : MIN(histogram.percentile(95), max_us),
+        p99_us  : MIN(histogram.percentile(99), max_us),
+        max_us  : max_us,
+    };
+    strncpy_noterm(pkt.name, name, sizeof(pkt.name));
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+#endif  // AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
 #endif  // HAL_LOGGING_ENABLED
 
 // display task statistics as text buffer for @SYS/tasks.txt
 void AP_Scheduler::task_info(ExpandingString &str)
 {
     // a header to allow for machine parsers to determine format
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    str.printf("TasksV3\n");
+#else
     str.printf("TasksV2\n");
+#endif
 
     // dynamically enable statistics collection
     if (!(_options & uint8_t(Options::RECORD_TASK_INFO))) {
@@ -497,40 +544,59 @@ void AP_Scheduler::task_info(ExpandingString &str)
 
     for (uint8_t i = 0; i < _num_tasks; i++) {
         const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
-        const char *task_name;
-
-        // determine which of the common task / vehicle task to run
-        bool run_vehicle_task = false;
-        if (vehicle_tasks_offset < _num_vehicle_tasks &&
-            common_tasks_offset < _num_common_tasks) {
-            // still have entries on both lists; compare the
-            // priorities.  In case of a tie the vehicle-specific
-            // entry wins.
-            const Task &vehicle_task = _vehicle_tasks[vehicle_tasks_offset];
-            const Task &common_task = _common_tasks[common_tasks_offset];
-            if (vehicle_task.priority <= common_task.priority) {
-                run_vehicle_task = true;
-            }
-        } else if (vehicle_tasks_offset < _num_vehicle_tasks) {
-            // out of common tasks to run
-            run_vehicle_task = true;
-        } else if (common_tasks_offset < _num_common_tasks) {
-            // out of vehicle tasks to run
-            run_vehicle_task = false;
-        } else {
-            // this is an error; the outside loop should have terminated
-            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
+        const char *task_name = next_task_name(vehicle_tasks_offset, common_tasks_offset);
+        if (task_name == nullptr) {
             return;
         }
 
-        if (run_vehicle_task) {
-            task_name = _vehicle_tasks[vehicle_tasks_offset++].name;
-        } else {
-            task_name = _common_tasks[common_tasks_offset++].name;
+        ti->print(task_name, total_time, str);
+    }
+
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // the whole loop, including the wait for the INS sample
+    const AP::PerfInfo::Histogram &loop_histogram = perf_info.get_loop_histogram();
+    const uint32_t max_loop_us = perf_info.get_max_time();
+    str.printf("%-32.32s MIN=%4u MAX=%4u P50=%4u P95=%4u P99=%4u LONG=%u/%u\n", "loop",
+               unsigned(perf_info.get_min_time()), unsigned(max_loop_us),
+               unsigned(MIN(loop_histogram.percentile(50), max_loop_us)),
+               unsigned(MIN(loop_histogram.percentile(95), max_loop_us)),
+               unsigned(MIN(loop_histogram.percentile(99), max_loop_us)),
+               unsigned(perf_info.get_num_long_running()), unsigned(perf_info.get_num_loops()));
+#endif
+}
+
+// return the name of the next task in the order they are run, advancing the
+// offsets into the vehicle and common task lists. Returns nullptr on error
+const char *AP_Scheduler::next_task_name(uint8_t &vehicle_tasks_offset, uint8_t &common_tasks_offset) const
+{
+    // determine which of the common task / vehicle task to run
+    bool run_vehicle_task = false;
+    if (vehicle_tasks_offset < _num_vehicle_tasks &&
+        common_tasks_offset < _num_common_tasks) {
+        // still have entries on both lists; compare the
+        // priorities.  In case of a tie the vehicle-specific
+        // entry wins.
+        const Task &vehicle_task = _vehicle_tasks[vehicle_tasks_offset];
+        const Task &common_task = _common_tasks[common_tasks_offset];
+        if (vehicle_task.priority <= common_task.priority) {
+            run_vehicle_task = true;
         }
+    } else if (vehicle_tasks_offset < _num_vehicle_tasks) {
+        // out of common tasks to run
+        run_vehicle_task = true;
+    } else if (common_tasks_offset < _num_common_tasks) {
+        // out of vehicle tasks to run
+        run_vehicle_task = false;
+    } else {
+        // this is an error; the outside loop should have terminated
+        INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
+        return nullptr;
+    }
 
-        ti->print(task_name, total_time, str);
+    if (run_vehicle_task) {
+        return _vehicle_tasks[vehicle_tasks_offset++].name;
     }
+    return _common_tasks[common_tasks_offset++].name;
 }
 
 namespace AP {
@@ -116,6 +116,11 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // write out per-task and loop time histogram summaries to logger
+    void Log_Write_Task_Histograms();
+#endif
+
     // call when one tick has passed
     void tick(void);
 
@@ -191,6 +196,13 @@ public:
     AP::PerfInfo perf_info;
 
 private:
+#if HAL_LOGGING_ENABLED && AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    void Log_Write_Task_Histogram(uint64_t time_us, uint8_t task_id, const char *name, const AP::PerfInfo::Histogram &histogram, uint32_t count, uint16_t max_us);
+#endif
+
+    // return the name of the next task in the order they are run
+    const char *next_task_name(uint8_t &vehicle_tasks_offset, uint8_t &common_tasks_offset) const;
+
     // used to enable scheduler debugging
     AP_Int8 _debug;
 
@@ -26,6 +26,9 @@ void AP::PerfInfo::reset()
     long_running = 0;
     sigma_time = 0;
     sigmasquared_time = 0;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    loop_histogram = Histogram{};
+#endif
     if (_task_info != nullptr) {
         memset(_task_info, 0, (_num_tasks) * sizeof(TaskInfo));
     }
@@ -84,6 +87,9 @@ void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, bool overrun)
     if (overrun) {
         overrun_count++;
     }
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    histogram.update(task_time_us);
+#endif
 }
 
 void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, ExpandingString& str) const
@@ -94,6 +100,15 @@ void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, E
         pct = elapsed_time_us * 100.0f / total_time;
         avg = MIN(uint16_t(elapsed_time_us / tick_count), 9999);
     }
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // percentiles are bucket upper bounds so can not exceed the largest time seen
+    str.printf("%-32.32s MIN=%4u MAX=%4u AVG=%4u P50=%4u P95=%4u P99=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%\n", task_name,
+                unsigned(MIN(min_time_us, 9999)), unsigned(MIN(max_time_us, 9999)), unsigned(avg),
+                unsigned(MIN(MIN(histogram.percentile(50), max_time_us), 9999)),
+                unsigned(MIN(MIN(histogram.percentile(95), max_time_us), 9999)),
+                unsigned(MIN(MIN(histogram.percentile(99), max_time_us), 9999)),
+                unsigned(MIN(overrun_count, 999)), unsigned(MIN(slip_count, 999)), pct);
+#else
 #if AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
     const char* fmt = "%-32.32s MIN=%4u MAX=%4u AVG=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%\n";
 #else
@@ -102,8 +117,68 @@ void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, E
     str.printf(fmt, task_name,
                 unsigned(MIN(min_time_us, 9999)), unsigned(MIN(max_time_us, 9999)), unsigned(avg),
                 unsigned(MIN(overrun_count, 999)), unsigned(MIN(slip_count, 999)), pct);
+#endif
+}
+
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+// return the bucket holding time_us. Times below 4us have a bucket each, above
+// that each octave is split into four buckets using the two bits below the top bit
+uint8_t AP::PerfInfo::Histogram::bucket(uint16_t time_us)
+{
+    if (time_us < 4) {
+        return time_us;
+    }
+    uint8_t msb = 2;
+    while ((time_us >> (msb + 1)) != 0) {
+        msb++;
+    }
+    return 4 * (msb - 1) + ((time_us >> (msb - 2)) & 3);
+}
+
+// return the largest time in microseconds that falls in a bucket
+uint16_t AP::PerfInfo::Histogram::bucket_max_us(uint8_t b)
+{
+    if (b < 4) {
+        return b;
+    }
+    const uint8_t msb = b / 4 + 1;
+    return ((uint32_t(5 + b % 4) << (msb - 2)) - 1);
 }
 
+void AP::PerfInfo::Histogram::update(uint16_t time_us)
+{
+    uint16_t &count = counts[bucket(time_us)];
+    if (count == UINT16_MAX) {
+        // halve all the counts rather than saturate so the shape of the distribution is kept
+        for (uint16_t &c : counts) {
+            c /= 2;
+        }
+    }
+    count++;
+}
+
+// return the smallest bucket upper bound in microseconds below which at least pct percent of the samples fall
+uint16_t AP::PerfInfo::Histogram::percentile(uint8_t pct) const
+{
+    uint32_t total = 0;
+    for (const uint16_t c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const uint32_t threshold = (total * pct + 99) / 100;
+    uint32_t sum = 0;
+    for (uint8_t b = 0; b < AP_SCHEDULER_HISTOGRAM_BUCKETS; b++) {
+        sum += counts[b];
+        if (sum >= threshold) {
+            return bucket_max_us(b);
+        }
+    }
+    return bucket_max_us(AP_SCHEDULER_HISTOGRAM_BUCKETS - 1);
+}
+#endif  // AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+
 // check_loop_time - check latest loop time vs min, max and overtime threshold
 void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
 {
@@ -125,6 +200,9 @@ void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
         long_running++;
     }
     sigma_time += time_in_micros;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    loop_histogram.update(MIN(time_in_micros, uint32_t(UINT16_MAX)));
+#endif
     sigmasquared_time += time_in_micros * time_in_micros;
 
     /* we keep a filtered loop time for use as G_Dt which is the
@@ -7,12 +7,31 @@
 #include <stdint.h>
 #include <AP_Common/ExpandingString.h>
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+// four buckets per octave covering 0 to 65535us, each bucket is at most 25% wide
+#define AP_SCHEDULER_HISTOGRAM_BUCKETS 60
+#endif
+
 namespace AP {
 
 class PerfInfo {
 public:
     PerfInfo() {}
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // fixed size log-scale histogram of task or loop times
+    class Histogram {
+    public:
+        void update(uint16_t time_us);
+        // return the smallest bucket upper bound in microseconds below which at least pct percent of the samples fall
+        uint16_t percentile(uint8_t pct) const;
+    private:
+        static uint8_t bucket(uint16_t time_us);
+        static uint16_t bucket_max_us(uint8_t bucket);
+        uint16_t counts[AP_SCHEDULER_HISTOGRAM_BUCKETS];
+    };
+#endif
+
     // per-task timing information
     struct TaskInfo {
         uint16_t min_time_us;
@@ -21,6 +40,9 @@ public:
         uint32_t tick_count;
         uint16_t slip_count;
         uint16_t overrun_count;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+        Histogram histogram;
+#endif
 
         void update(uint16_t task_time_us, bool overrun);
         void print(const char* task_name, uint32_t total_time, ExpandingString& str) const;
@@ -44,6 +66,11 @@ public:
 
     void update_logging() const;
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // histogram of loop times since the last reset
+    const Histogram &get_loop_histogram() const { return loop_histogram; }
+#endif
+
     // allocate the array of task statistics for use by @SYS/tasks.txt
     void allocate_task_info(uint8_t num_tasks);
     void free_task_info();
@@ -74,6 +101,9 @@ private:
     uint32_t last_check_us;
     float filtered_loop_time;
     bool ignore_loop;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    Histogram loop_histogram;
+#endif
     // performance monitoring
     uint8_t _num_tasks;
     TaskInfo* _task_info;
@@ -28,6 +28,10 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_Rally/AP_Rally.h>
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <unistd.h>
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 AP_Terrain *AP_Terrain::singleton;
@@ -49,7 +53,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in each grid square having a size of 2.7 kilometers by 3.2 kilometers, and TERRAIN_CACHE_SZ sets how many grid squares are kept in memory. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
@@ -58,7 +62,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Terrain options
     // @Description: Options to change behaviour of terrain system
-    // @Bitmask: 0:Disable Download
+    // @Bitmask: 0:Disable Download, 1:Memory map terrain files (Linux and SITL only)
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",   2, AP_Terrain, options, 0),
 
@@ -77,7 +81,15 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Range: 0 50
     // @User: Advanced
     AP_GROUPINFO("OFS_MAX",  4, AP_Terrain, offset_max, 30),
-    
+
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: Number of terrain grid squares kept in memory. Each grid square uses about 2 kilobytes. A value of zero sizes the cache from the free memory of the board, which is only possible on Linux and SITL. A larger cache allows a vehicle flying long distances to keep the terrain data it has passed over and will pass over without reloading it from the SD card.
+    // @Range: 0 4096
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ",  5, AP_Terrain, cache_size_param, TERRAIN_CACHE_SIZE_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -107,15 +119,20 @@ AP_Terrain::AP_Terrain() :
  */
 bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
 {
+    WITH_SEMAPHORE(sem);
+
     if (!allocate()) {
         return false;
     }
 
     const AP_AHRS &ahrs = AP::ahrs();
 
+    lookup_count++;
+
     // quick access for home altitude
     if (loc.lat == home_loc.lat &&
         loc.lng == home_loc.lng) {
+        lookup_hits++;
         height = home_height;
         if (corrected && have_reference_offset) {
             height += reference_offset;
@@ -127,9 +144,133 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
 
     calculate_grid_info(loc, info);
 
-    // find the grid
-    const struct grid_block &grid = find_grid_cache(info).grid;
+    struct height_block block {};
+    if (!height_from_block(info, block, height)) {
+        return false;
+    }
+    lookup_hits++;
+
+    if (loc.lat == ahrs.get_home().lat &&
+        loc.lng == ahrs.get_home().lng) {
+        // remember home altitude as a special case
+        home_height = height;
+        home_loc = loc;
+        have_home_height = true;
+    }
+
+    if (corrected && have_reference_offset) {
+        height += reference_offset;
+    }
+    
+    return true;
+}
+
+
+/*
+  find the terrain heights in meters above sea level for an array of
+  locations. Consecutive locations in the same grid block share the
+  block lookup, so this is much cheaper than calling height_amsl() for
+  each location when the locations are close together, such as points
+  along a path
+
+  returns false if any height is not available. Blocks for missing
+  heights are requested in the same way as height_amsl()
+ */
+bool AP_Terrain::heights_amsl(const Location *locs, uint16_t num_locs, float *heights, bool corrected)
+{
+    WITH_SEMAPHORE(sem);
+
+    if (!allocate()) {
+        return false;
+    }
+
+    struct height_block block {};
+    bool all_valid = true;
+    for (uint16_t i=0; i<num_locs; i++) {
+        struct grid_info info;
+        calculate_grid_info(locs[i], info);
+        if (!height_from_block(info, block, heights[i])) {
+            all_valid = false;
+            continue;
+        }
+        if (corrected && have_reference_offset) {
+            heights[i] += reference_offset;
+        }
+    }
+    return all_valid;
+}
+
+/*
+  find the terrain heights in meters above sea level along a path of
+  num_points locations. If heights is not nullptr it is filled with
+  the height at each point. If max_heights is not nullptr it is filled
+  with the highest terrain along each of the num_points-1 segments,
+  sampled at half the grid spacing and including both ends
+
+  returns false if any height is not available. Blocks for missing
+  heights are requested in the same way as height_amsl()
+ */
+bool AP_Terrain::path_heights_amsl(const Location *path, uint16_t num_points,
+                                   float *heights, float *max_heights, bool corrected)
+{
+    WITH_SEMAPHORE(sem);
+
+    if (!allocate() || grid_spacing <= 0) {
+        return false;
+    }
+
+    const float step = 0.5f * grid_spacing;
+    const float offset = (corrected && have_reference_offset) ? reference_offset : 0;
+    struct height_block block {};
+    bool all_valid = true;
+
+    for (uint16_t i=0; i<num_points; i++) {
+        struct grid_info info;
+        calculate_grid_info(path[i], info);
+        float start_height = 0;
+        const bool start_valid = height_from_block(info, block, start_height);
+        if (!start_valid) {
+            all_valid = false;
+        }
+        if (heights != nullptr) {
+            heights[i] = start_height + offset;
+        }
+        if (max_heights == nullptr || i+1 >= num_points) {
+            continue;
+        }
+
+        // sample the segment to the next point. The samples use the
+        // same block as long as they stay within it
+        const Vector2f leg = path[i].get_distance_NE(path[i+1]);
+        const float length = leg.length();
+        float max_height = start_valid ? start_height : -FLT_MAX;
+        for (float dist = step; dist < length + step; dist += step) {
+            const float d = MIN(dist, length);
+            Location loc = path[i];
+            loc.offset(leg.x * d / length, leg.y * d / length);
+            calculate_grid_info(loc, info);
+            float height;
+            if (!height_from_block(info, block, height)) {
+                all_valid = false;
+                continue;
+            }
+            max_height = MAX(max_height, height);
+        }
+        max_heights[i] = max_height + offset;
+    }
+    return all_valid;
+}
+
+/*
+  find the height at a grid_info from the grid block it lies in. If
+  block already holds that grid block then it is used without a
+  lookup, otherwise block is updated to it. This allows lookups of
+  nearby locations to share one block lookup
 
+  returns false if the heights around the grid_info are not available
+ */
+bool AP_Terrain::height_from_block(const struct grid_info &info, struct height_block &block, float &height)
+{
     /*
       note that we rely on the one square overlap to ensure these
       calculations don't go past the end of the arrays
@@ -137,15 +278,39 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     ASSERT_RANGE(info.idx_x, 0, TERRAIN_GRID_BLOCK_SIZE_X-2);
     ASSERT_RANGE(info.idx_y, 0, TERRAIN_GRID_BLOCK_SIZE_Y-2);
 
+    if (block.grid == nullptr ||
+        block.grid_idx_x != info.grid_idx_x ||
+        block.grid_idx_y != info.grid_idx_y ||
+        block.lat_degrees != info.lat_degrees ||
+        block.lon_degrees != info.lon_degrees ||
+        !have_heights(block.bitmap, info)) {
+        // find the grid
+        block.grid = nullptr;
+        block.bitmap = 0;
+#if AP_TERRAIN_MMAP_ENABLED
+        // use heights already in a mapped file directly
+        if (!find_mapped_block(info, block.grid, block.bitmap) || block.grid == nullptr ||
+            !have_heights(block.bitmap, info)) {
+            block.grid = nullptr;
+        }
+#endif
+        if (block.grid == nullptr) {
+            block.grid = &find_grid_cache(info).grid;
+            block.bitmap = block.grid->bitmap;
+        }
+        block.grid_idx_x = info.grid_idx_x;
+        block.grid_idx_y = info.grid_idx_y;
+        block.lat_degrees = info.lat_degrees;
+        block.lon_degrees = info.lon_degrees;
 
-    // check we have all 4 required heights
-    if (!check_bitmap(grid, info.idx_x,   info.idx_y) ||
-        !check_bitmap(grid, info.idx_x,   info.idx_y+1) ||
-        !check_bitmap(grid, info.idx_x+1, info.idx_y) ||
-        !check_bitmap(grid, info.idx_x+1, info.idx_y+1)) {
-        return false;
+        // check we have all 4 required heights
+        if (!have_heights(block.bitmap, info)) {
+            return false;
+        }
     }
 
+    const struct grid_block &grid = *block.grid;
+
     // hXY are the heights of the 4 surrounding grid points
     int16_t h00, h01, h10, h11;
 
@@ -162,23 +327,9 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
     float avg  = (1.0f-info.frac_y) * avg1 + info.frac_y * avg2;
 
     height = avg;
-
-    if (loc.lat == ahrs.get_home().lat &&
-        loc.lng == ahrs.get_home().lng) {
-        // remember home altitude as a special case
-        home_height = height;
-        home_loc = loc;
-        have_home_height = true;
-    }
-
-    if (corrected && have_reference_offset) {
-        height += reference_offset;
-    }
-    
     return true;
 }
 
-
 /* 
    find difference between home terrain height and the terrain
    height at the current location in meters. A positive result
@@ -312,6 +463,8 @@ bool AP_Terrain::height_relative_home_equivalent(float terrain_altitude,
 */
 float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
 {
+    WITH_SEMAPHORE(sem);
+
     if (!allocate() || grid_spacing <= 0) {
         return 0;
     }
@@ -330,13 +483,21 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
     float climb = 0;
     float lookahead_estimate = 0;
 
-    // check for terrain at grid spacing intervals
+    // check for terrain at grid spacing intervals, sharing block
+    // lookups between samples. The heights include the reference
+    // offset, as base_height does
+    struct height_block block {};
     while (distance > 0) {
         loc.offset_bearing(bearing, grid_spacing);
         climb += climb_ratio * grid_spacing;
         distance -= grid_spacing;
+        struct grid_info info;
+        calculate_grid_info(loc, info);
         float height;
-        if (height_amsl(loc, height)) {
+        if (height_from_block(info, block, height)) {
+            if (have_reference_offset) {
+                height += reference_offset;
+            }
             float rise = (height - base_height) - climb;
             if (rise > lookahead_estimate) {
                 lookahead_estimate = rise;
@@ -356,9 +517,16 @@ float AP_Terrain::lookahead(float bearing, float distance, float climb_ratio)
 void AP_Terrain::update(void)
 {
     if (!enable) { return; }
+
+    WITH_SEMAPHORE(sem);
+
     // just schedule any needed disk IO
     schedule_disk_io();
 
+    // looking up the reference height can change the cache, which the
+    // IO timer doesn't lock, so the offset is updated here
+    update_reference_offset();
+
     const AP_AHRS &ahrs = AP::ahrs();
 
     // try to ensure the home location is populated
@@ -373,6 +541,9 @@ void AP_Terrain::update(void)
         last_current_loc_height = height;
         have_current_loc_height = true;
     }
+    if (pos_valid) {
+        update_late_blocks(loc, terrain_valid);
+    }
 
     // check for pending mission data
     update_mission_data();
@@ -385,6 +556,8 @@ void AP_Terrain::update(void)
     // update tiles surrounding our current location:
     if (pos_valid) {
         have_surrounding_tiles = update_surrounding_tiles(loc);
+        // and the tiles the vehicle is heading for
+        update_prefetch(loc);
     } else {
         have_surrounding_tiles = false;
     }
@@ -471,6 +644,8 @@ void AP_Terrain::log_terrain_data()
         pending        : pending,
         loaded         : loaded,
         reference_offset : have_reference_offset?reference_offset:0,
+        hit_ratio      : (uint8_t)(lookup_count > 0 ? (100ULL * lookup_hits) / lookup_count : 0),
+        late           : late_blocks,
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
@@ -488,13 +663,57 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
-    if (cache == nullptr) {
-        GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
-        memory_alloc_failed = true;
-        return false;
+
+    uint32_t size = cache_size_param.get();
+    if (size == 0) {
+        // use a quarter of the free memory
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        // available_memory() is a fixed guess on these boards, ask the OS
+        const long pages = sysconf(_SC_AVPHYS_PAGES);
+        const long page_size = sysconf(_SC_PAGESIZE);
+        uint64_t free_memory = hal.util->available_memory();
+        if (pages > 0 && page_size > 0) {
+            free_memory = uint64_t(pages) * uint64_t(page_size);
+        }
+#else
+        const uint64_t free_memory = hal.util->available_memory();
+#endif
+        size = MIN(free_memory / (4 * sizeof(struct grid_cache)), uint64_t(TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX));
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    size = constrain_int32(size, TERRAIN_GRID_BLOCK_CACHE_SIZE, TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX);
+
+    // try the requested size, then fall back to the minimum
+    while (true) {
+        uint16_t hash_size = 1;
+        while (hash_size < 2 * size) {
+            hash_size <<= 1;
+        }
+        cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+        cache_hash = (uint16_t *)calloc(hash_size, sizeof(cache_hash[0]));
+        if (cache != nullptr && cache_hash != nullptr) {
+            cache_size = size;
+            cache_hash_size = hash_size;
+            break;
+        }
+        free(cache);
+        free(cache_hash);
+        cache = nullptr;
+        cache_hash = nullptr;
+        if (size == TERRAIN_GRID_BLOCK_CACHE_SIZE) {
+            GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
+            memory_alloc_failed = true;
+            return false;
+        }
+        size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    }
+
+    // all blocks start out unused, in index order in the LRU list
+    for (uint16_t i=0; i<cache_size; i++) {
+        cache[i].lru_prev = i > 0 ? i-1 : 0;
+        cache[i].lru_next = i+1 < cache_size ? i+1 : 0;
+    }
+    lru_head = 0;
+    lru_tail = cache_size - 1;
     return true;
 }
 
@@ -504,6 +723,8 @@ bool AP_Terrain::allocate(void)
 */
 void AP_Terrain::set_reference_location(void)
 {
+    WITH_SEMAPHORE(sem);
+
     const auto &ahrs = AP::ahrs();
 
     // check we have absolute position
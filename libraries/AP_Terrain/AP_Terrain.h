@@ -25,12 +25,26 @@
 
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/Location.h>
+#include <AP_HAL/Semaphores.h>
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Logger/AP_Logger_config.h>
 
 #define TERRAIN_DEBUG 0
 
+// degree files can be memory mapped, removing the disk read wait on a cache miss
+#ifndef AP_TERRAIN_MMAP_ENABLED
+#define AP_TERRAIN_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if AP_TERRAIN_MMAP_ENABLED
+// number of degree files kept mapped at once
+#define TERRAIN_MMAP_MAX_FILES 4
+
+// value in the mapped block index for a block that has not been validated yet
+#define TERRAIN_MMAP_BLOCK_UNCHECKED UINT64_MAX
+#endif
+
 
 // MAVLink sends 4x4 grids
 #define TERRAIN_GRID_MAVLINK_SIZE 4
@@ -50,12 +64,37 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// number of grid_blocks in the LRU memory cache. Boards with plenty
+// of memory can hold more with TERRAIN_CACHE_SZ
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 4096
+
+// on Linux and SITL the cache is sized from free memory by default
+#ifndef TERRAIN_CACHE_SIZE_DEFAULT
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define TERRAIN_CACHE_SIZE_DEFAULT 0
+#else
+#define TERRAIN_CACHE_SIZE_DEFAULT TERRAIN_GRID_BLOCK_CACHE_SIZE
+#endif
+#endif
 
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
+// blocks are prefetched along the predicted path of the vehicle for
+// this many seconds ahead
+#define TERRAIN_PREFETCH_TIME_S 60
+#define TERRAIN_PREFETCH_INTERVAL_MS 1000
+// maximum number of points on the predicted path checked each prefetch
+#define TERRAIN_PREFETCH_MAX_POINTS 16
+// maximum number of upcoming mission legs followed
+#define TERRAIN_PREFETCH_MAX_LEGS 3
+// prefetch stops when this many blocks are waiting for disk reads
+#define TERRAIN_PREFETCH_MAX_DISKWAIT 2
+// below this ground speed in m/s the velocity is not projected, and
+// mission legs are timed as if flown at this speed
+#define TERRAIN_PREFETCH_MIN_SPEED 5
+
 // we allow for a 2cm discrepancy in the grid corners. This is to
 // account for different rounding in terrain DAT file generators using
 // different programming languages
@@ -123,6 +162,25 @@ public:
      */
     bool height_amsl(const Location &loc, float &height, bool corrected = true);
 
+    /*
+      find the terrain heights in meters above sea level for an array
+      of locations, sharing block lookups between consecutive
+      locations
+
+      return false if any height is not available
+     */
+    bool heights_amsl(const Location *locs, uint16_t num_locs, float *heights, bool corrected = true);
+
+    /*
+      find the terrain heights in meters above sea level at each point
+      of a path, and the highest terrain along each of the
+      num_points-1 segments. Either output may be nullptr
+
+      return false if any height is not available
+     */
+    bool path_heights_amsl(const Location *path, uint16_t num_points,
+                           float *heights, float *max_heights, bool corrected = true);
+
     /* 
        find difference between home terrain height and the terrain
        height at the current location in meters. A positive result
@@ -263,8 +321,9 @@ private:
 
         volatile enum GridCacheState state;
 
-        // the last time access was requested to this block, used for LRU
-        uint32_t last_access_ms;
+        // neighbours in the LRU list, most recently used first
+        uint16_t lru_prev;
+        uint16_t lru_next;
     };
 
     /*
@@ -304,6 +363,46 @@ private:
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
 
+    /*
+      the grid block used for the last height lookup, so lookups of
+      nearby locations can share it
+    */
+    struct height_block {
+        const struct grid_block *grid;
+        uint64_t bitmap;
+        int8_t lat_degrees;
+        int16_t lon_degrees;
+        uint16_t grid_idx_x;
+        uint16_t grid_idx_y;
+    };
+
+    /*
+      find the uncorrected height at a grid_info, reusing block if it
+      holds the right grid block
+    */
+    bool height_from_block(const struct grid_info &info, struct height_block &block, float &height);
+
+    /*
+      hashed index of the cache. Every block that is not
+      GRID_CACHE_INVALID is in the hash, keyed on its position within
+      its degree file and its grid spacing
+    */
+    uint16_t cache_hash_slot(int8_t lat_degrees, int16_t lon_degrees,
+                             uint16_t grid_idx_x, uint16_t grid_idx_y, uint16_t spacing) const;
+    int16_t cache_hash_find(const struct grid_info &info) const;
+    void cache_hash_insert(uint16_t idx);
+    void cache_hash_remove(uint16_t idx);
+
+    /*
+      move a cache block to the front of the LRU list
+    */
+    void lru_touch(uint16_t idx);
+
+    /*
+      copy a block into the cache, keeping the key of the cache block
+    */
+    void set_cache_grid(struct grid_cache &gcache, const struct grid_block &block);
+
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
       bit representing a 4x4 mavlink transmitted block
@@ -311,10 +410,14 @@ private:
     uint8_t grid_bitnum(uint8_t idx_x, uint8_t idx_y);
 
     /*
-      given a grid_info check that a given idx_x/idx_y is available (set
-      in the bitmap)
+      check that a given idx_x/idx_y is available (set in the bitmap)
     */
-    bool check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint8_t idx_y);
+    bool check_bitmap(uint64_t bitmap, uint8_t idx_x, uint8_t idx_y);
+
+    /*
+      check that all 4 heights surrounding a grid_info are available
+    */
+    bool have_heights(uint64_t bitmap, const struct grid_info &info);
 
     /*
       request any missing 4x4 grids from a block
@@ -336,19 +439,108 @@ private:
       disk IO functions
      */
     int16_t find_io_idx(enum GridCacheState state);
-    uint16_t get_block_crc(struct grid_block &block);
+    uint16_t get_block_crc(const struct grid_block &block) const;
     void check_disk_read(void);
     void check_disk_write(void);
     void io_timer(void);
+    bool set_file_path(int8_t lat_degrees, int16_t lon_degrees);
     void open_file(void);
     void seek_offset(void);
-    uint32_t east_blocks(struct grid_block &block) const;
+    uint32_t east_blocks(int8_t lat_degrees, int16_t lon_degrees) const;
     void write_block(void);
     void read_block(void);
 
+#if AP_TERRAIN_MMAP_ENABLED
+    /*
+      a degree file mapped read-only into memory. Blocks are found by
+      their offset in the file, and each is validated the first time
+      it is used
+     */
+    enum MappedFileState {
+        MAPPED_FILE_FREE=0,         // slot not in use
+        MAPPED_FILE_WANT_MAP=1,     // waiting for the IO timer to map the file
+        MAPPED_FILE_WANT_REMAP=2,   // the file has grown, waiting for the IO timer to map it again
+        MAPPED_FILE_READY=3,        // mapped, usable by the main thread
+        MAPPED_FILE_FAILED=4        // could not be mapped, will be retried
+    };
+
+    struct mapped_file {
+        volatile enum MappedFileState state;
+
+        // degree file and grid spacing this slot is for
+        int8_t lat_degrees;
+        int16_t lon_degrees;
+        uint16_t spacing;
+
+        // number of blocks in a stride of the file
+        uint32_t east_blocks;
+
+        // mapping of the whole file
+        const uint8_t *base;
+        uint32_t num_blocks;
+
+        // validated bitmap of each block in the file, zero for a
+        // missing or invalid block, TERRAIN_MMAP_BLOCK_UNCHECKED if
+        // the block has not been validated since it was last written
+        uint64_t *block_bitmaps;
+
+        // last time this file was used, used for LRU
+        uint32_t last_access_ms;
+
+        // time of last failed attempt to map the file
+        uint32_t failed_ms;
+    };
+
+    bool use_mapped_files() const {
+        return (options.get() & uint16_t(Options::MemoryMapFiles)) != 0;
+    }
+
+    /*
+      find a block in a mapped file given a grid_info. Returns false
+      if the file is not mapped yet, otherwise block is the block or
+      nullptr if the file has no valid copy of it
+     */
+    bool find_mapped_block(const struct grid_info &info, const struct grid_block *&block, uint64_t &bitmap);
+
+    // called from the main thread when a block has been written to disk
+    void mapped_block_written(const struct grid_block &block);
+
+    // IO timer functions to map and unmap degree files
+    void update_mapped_files(void);
+    void map_file(struct mapped_file &mfile);
+    void unmap_file(struct mapped_file &mfile);
+#endif
+
     // check for missing data in squares surrounding loc:
     bool update_surrounding_tiles(const Location &loc);
 
+    /*
+      a point on the predicted path of the vehicle and the time in
+      seconds until the vehicle gets there
+     */
+    struct prefetch_point {
+        Location loc;
+        float time_s;
+    };
+
+    /*
+      load blocks on the predicted path of the vehicle into the cache
+      ahead of time, most urgent first
+     */
+    void update_prefetch(const Location &loc);
+
+    /*
+      add points along a straight path to a prefetch list, returns
+      false once the time horizon or the list is full
+     */
+    bool add_prefetch_path(const Location &start, const Location &end, float speed, float &time_s,
+                           struct prefetch_point *points, uint8_t &num_points) const;
+
+    /*
+      count blocks that were not loaded when the vehicle reached them
+     */
+    void update_late_blocks(const Location &loc, bool terrain_valid);
+
     /*
       check for missing mission terrain data
      */
@@ -371,15 +563,35 @@ private:
     AP_Int16 grid_spacing; // meters between grid points
     AP_Int16 options; // option bits
     AP_Float offset_max;
+    AP_Int16 cache_size_param; // number of blocks in the cache, 0 for automatic
 
     enum class Options {
         DisableDownload = (1U<<0),
+        MemoryMapFiles  = (1U<<1),
     };
 
+    // protects the cache, its hash and LRU list and the mapped files,
+    // as heights are looked up from scripting as well as the main thread
+    HAL_Semaphore sem;
+
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // open addressing hash of cache indices plus one, zero for an
+    // empty slot. The size is a power of two at least twice cache_size
+    uint16_t *cache_hash = nullptr;
+    uint16_t cache_hash_size = 0;
+
+    // most and least recently used cache blocks
+    uint16_t lru_head;
+    uint16_t lru_tail;
+
+#if AP_TERRAIN_MMAP_ENABLED
+    // degree files mapped into memory, LRU
+    struct mapped_file mapped_files[TERRAIN_MMAP_MAX_FILES];
+#endif
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -437,6 +649,19 @@ private:
     // current location:
     bool have_surrounding_tiles;
 
+    // last time blocks were prefetched
+    uint32_t last_prefetch_ms;
+
+    // height_amsl() calls, and how many of them found data
+    uint32_t lookup_count;
+    uint32_t lookup_hits;
+
+    // number of blocks not loaded when the vehicle reached them, and
+    // SW corner of the block the vehicle was last in
+    uint16_t late_blocks;
+    int32_t last_block_lat;
+    int32_t last_block_lon;
+
     // next mission command to check
     uint16_t next_mission_index;
 
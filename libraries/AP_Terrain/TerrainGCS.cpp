@@ -108,6 +108,8 @@ bool AP_Terrain::send_cache_request(mavlink_channel_t chan)
  */
 void AP_Terrain::send_request(mavlink_channel_t chan)
 {
+    WITH_SEMAPHORE(sem);
+
     if (!allocate()) {
         // not enabled
         return;
@@ -171,8 +173,9 @@ uint8_t AP_Terrain::bitcount64(uint64_t b) const
 */
 void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
 {
-    pending = 0;
-    loaded = 0;
+    // a large cache can hold more grids than fit in the report
+    uint32_t num_pending = 0;
+    uint32_t num_loaded = 0;
     for (uint16_t i=0; i<cache_size; i++) {
         if (cache[i].grid.spacing != grid_spacing) {
             continue;
@@ -182,18 +185,20 @@ void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
         }
         uint8_t maskbits = TERRAIN_GRID_BLOCK_MUL_X*TERRAIN_GRID_BLOCK_MUL_Y;
         if (cache[i].state == GRID_CACHE_DISKWAIT) {
-            pending += maskbits;
+            num_pending += maskbits;
             continue;
         }
         if (cache[i].state == GRID_CACHE_DIRTY) {
             // count dirty grids as a pending, so we know where there 
             // are disk writes pending
-            pending++;
+            num_pending++;
         }
         uint8_t bitcount = bitcount64(cache[i].grid.bitmap);
-        pending += maskbits - bitcount;
-        loaded += bitcount;
+        num_pending += maskbits - bitcount;
+        num_loaded += bitcount;
     }
+    pending = MIN(num_pending, uint32_t(UINT16_MAX));
+    loaded = MIN(num_loaded, uint32_t(UINT16_MAX));
 }
 
 /* 
@@ -201,6 +206,8 @@ void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
  */
 void AP_Terrain::handle_data(mavlink_channel_t chan, const mavlink_message_t &msg)
 {
+    WITH_SEMAPHORE(sem);
+
     if (msg.msgid == MAVLINK_MSG_ID_TERRAIN_DATA) {
         handle_terrain_data(msg);
     } else if (msg.msgid == MAVLINK_MSG_ID_TERRAIN_CHECK) {
@@ -86,10 +86,10 @@ void AP_Terrain::schedule_disk_io(void)
         if (cache_idx != -1) {
             if (disk_block.block.bitmap != 0) {
                 // when bitmap is zero we read an empty block
-                cache[cache_idx].grid = disk_block.block;
+                set_cache_grid(cache[cache_idx], disk_block.block);
             }
             cache[cache_idx].state = GRID_CACHE_VALID;
-            cache[cache_idx].last_access_ms = AP_HAL::millis();
+            lru_touch(cache_idx);
         }
         disk_io_state = DiskIoIdle;
         break;
@@ -104,6 +104,9 @@ void AP_Terrain::schedule_disk_io(void)
                 cache[cache_idx].state = GRID_CACHE_VALID;
             }
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        mapped_block_written(disk_block.block);
+#endif
         disk_io_state = DiskIoIdle;
         break;
     }
@@ -131,53 +134,64 @@ All file operations are done by the IO thread.
 
 
 /*
-  open the current degree file
+  set file_path to the degree file for a given lat/lon. Returns false
+  if the path could not be formed
  */
-void AP_Terrain::open_file(void)
+bool AP_Terrain::set_file_path(int8_t lat_degrees, int16_t lon_degrees)
 {
-    struct grid_block &block = disk_block.block;
-    if (fd != -1 && 
-        block.lat_degrees == file_lat_degrees &&
-        block.lon_degrees == file_lon_degrees) {
-        // already open on right file
-        return;
-    }
     if (file_path == nullptr) {
         const char* terrain_dir = hal.util->get_custom_terrain_directory();
         if (terrain_dir == nullptr) {
             terrain_dir = HAL_BOARD_TERRAIN_DIRECTORY;
         }
         if (asprintf(&file_path, "%s/NxxExxx.DAT", terrain_dir) <= 0) {
-            io_failure = true;
             file_path = nullptr;
-            return;
+            return false;
         }
     }
     if (file_path == nullptr) {
-        io_failure = true;
-        return;
+        return false;
     }
     char *p = &file_path[strlen(file_path)-12];
     if (*p != '/') {
-        io_failure = true;
-        return;        
+        return false;
     }
     // our fancy templatified MIN macro get gcc 9.3.0 all confused; it
     // thinks there are more digits than there can be so says there's
     // a buffer overflow in the snprintf.  Constrain it long-form:
-    uint32_t lat_tmp = abs((int32_t)block.lat_degrees);
+    uint32_t lat_tmp = abs((int32_t)lat_degrees);
     if (lat_tmp > 99U) {
         lat_tmp = 99U;
     }
-    uint32_t lon_tmp = abs((int32_t)block.lon_degrees);
+    uint32_t lon_tmp = abs((int32_t)lon_degrees);
     if (lon_tmp > 999U) {
         lon_tmp = 999;
     }
     hal.util->snprintf(p, 13, "/%c%02u%c%03u.DAT",
-             block.lat_degrees<0?'S':'N',
+             lat_degrees<0?'S':'N',
              (unsigned)lat_tmp,
-             block.lon_degrees<0?'W':'E',
+             lon_degrees<0?'W':'E',
              (unsigned)lon_tmp);
+    return true;
+}
+
+/*
+  open the current degree file
+ */
+void AP_Terrain::open_file(void)
+{
+    struct grid_block &block = disk_block.block;
+    if (fd != -1 && 
+        block.lat_degrees == file_lat_degrees &&
+        block.lon_degrees == file_lon_degrees) {
+        // already open on right file
+        return;
+    }
+    if (!set_file_path(block.lat_degrees, block.lon_degrees)) {
+        io_failure = true;
+        return;
+    }
+    char *p = &file_path[strlen(file_path)-12];
 
     // create directory if need be
     if (!directory_created) {
@@ -217,13 +231,13 @@ void AP_Terrain::open_file(void)
 /*
   work out how many blocks needed in a stride for a given location
  */
-uint32_t AP_Terrain::east_blocks(struct grid_block &block) const
+uint32_t AP_Terrain::east_blocks(int8_t lat_degrees, int16_t lon_degrees) const
 {
     Location loc1, loc2;
-    loc1.lat = block.lat_degrees*10*1000*1000L;
-    loc1.lng = block.lon_degrees*10*1000*1000L;
+    loc1.lat = lat_degrees*10*1000*1000L;
+    loc1.lng = lon_degrees*10*1000*1000L;
     loc2.lat = loc1.lat;
-    loc2.lng = (block.lon_degrees+1)*10*1000*1000L;
+    loc2.lng = (lon_degrees+1)*10*1000*1000L;
 
     // shift another two blocks east to ensure room is available
     loc2.offset(0, 2*grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
@@ -238,7 +252,7 @@ void AP_Terrain::seek_offset(void)
 {
     struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
-    uint32_t blocknum = east_blocks(block) * block.grid_idx_x + block.grid_idx_y;
+    uint32_t blocknum = east_blocks(block.lat_degrees, block.lon_degrees) * block.grid_idx_x + block.grid_idx_y;
     uint32_t file_offset = blocknum * sizeof(union grid_io_block);
     if (AP::FS().lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
@@ -349,7 +363,9 @@ void AP_Terrain::io_timer(void)
         return;
     }
 
-    update_reference_offset();
+#if AP_TERRAIN_MMAP_ENABLED
+    update_mapped_files();
+#endif
 
     switch (disk_io_state) {
     case DiskIoIdle:
@@ -0,0 +1,247 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  memory mapped access to terrain degree files
+
+  On boards with an OS and plenty of memory the degree files can be
+  mapped read-only, so a block is found directly from its offset in
+  the file instead of being read into the cache by the IO timer. Writes
+  of new data from the GCS still go through the normal disk IO path.
+ */
+
+#include "AP_Terrain.h"
+
+#if AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  find a block in a mapped file given a grid_info. Returns false if
+  the file is not mapped yet, otherwise block is the block or nullptr
+  if the file has no valid copy of it
+
+  If the file is not mapped the IO timer is asked to map it, replacing
+  the least recently used file
+ */
+bool AP_Terrain::find_mapped_block(const struct grid_info &info, const struct grid_block *&block, uint64_t &bitmap)
+{
+    if (!use_mapped_files()) {
+        return false;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    struct mapped_file *mfile = nullptr;
+    struct mapped_file *oldest = nullptr;
+    for (struct mapped_file &f : mapped_files) {
+        if (f.state != MAPPED_FILE_FREE &&
+            f.lat_degrees == info.lat_degrees &&
+            f.lon_degrees == info.lon_degrees &&
+            f.spacing == grid_spacing) {
+            mfile = &f;
+            break;
+        }
+        if (f.state == MAPPED_FILE_WANT_MAP || f.state == MAPPED_FILE_WANT_REMAP) {
+            // owned by the IO timer
+            continue;
+        }
+        if (oldest == nullptr ||
+            (oldest->state != MAPPED_FILE_FREE &&
+             (f.state == MAPPED_FILE_FREE || f.last_access_ms < oldest->last_access_ms))) {
+            oldest = &f;
+        }
+    }
+
+    if (mfile == nullptr) {
+        if (oldest != nullptr) {
+            oldest->lat_degrees = info.lat_degrees;
+            oldest->lon_degrees = info.lon_degrees;
+            oldest->spacing = grid_spacing;
+            oldest->east_blocks = east_blocks(info.lat_degrees, info.lon_degrees);
+            oldest->last_access_ms = now_ms;
+            oldest->state = MAPPED_FILE_WANT_MAP;
+        }
+        return false;
+    }
+
+    mfile->last_access_ms = now_ms;
+    if (mfile->state == MAPPED_FILE_FAILED && now_ms - mfile->failed_ms > 5000) {
+        // retry every 5s as the file may have been created since
+        mfile->state = MAPPED_FILE_WANT_MAP;
+        return false;
+    }
+    if (mfile->state != MAPPED_FILE_READY) {
+        return false;
+    }
+
+    block = nullptr;
+    const uint32_t blocknum = mfile->east_blocks * info.grid_idx_x + info.grid_idx_y;
+    if (blocknum >= mfile->num_blocks) {
+        // beyond the end of the file so not on disk yet
+        return true;
+    }
+    const struct grid_block &mblock = *(const struct grid_block *)&mfile->base[blocknum * sizeof(union grid_io_block)];
+
+    // validate each block once, with the same checks as read_block()
+    uint64_t &block_bitmap = mfile->block_bitmaps[blocknum];
+    if (block_bitmap == TERRAIN_MMAP_BLOCK_UNCHECKED) {
+        if (TERRAIN_LATLON_EQUAL(mblock.lat, info.grid_lat) &&
+            TERRAIN_LATLON_EQUAL(mblock.lon, info.grid_lon) &&
+            mblock.spacing == grid_spacing &&
+            mblock.version == TERRAIN_GRID_FORMAT_VERSION &&
+            mblock.crc == get_block_crc(mblock)) {
+            block_bitmap = mblock.bitmap & bitmap_mask;
+        } else {
+            block_bitmap = 0;
+        }
+    }
+    if (block_bitmap != 0) {
+        block = &mblock;
+        bitmap = block_bitmap;
+    }
+    return true;
+}
+
+/*
+  called from the main thread when a block has been written to
+  disk. The block needs validating again, and if it was appended to
+  the file the file needs mapping again to include it
+ */
+void AP_Terrain::mapped_block_written(const struct grid_block &block)
+{
+    for (struct mapped_file &mfile : mapped_files) {
+        if (mfile.lat_degrees != block.lat_degrees ||
+            mfile.lon_degrees != block.lon_degrees ||
+            mfile.spacing != block.spacing) {
+            continue;
+        }
+        if (mfile.state == MAPPED_FILE_READY) {
+            const uint32_t blocknum = mfile.east_blocks * block.grid_idx_x + block.grid_idx_y;
+            if (blocknum < mfile.num_blocks) {
+                mfile.block_bitmaps[blocknum] = TERRAIN_MMAP_BLOCK_UNCHECKED;
+            } else {
+                mfile.state = MAPPED_FILE_WANT_REMAP;
+            }
+        } else if (mfile.state == MAPPED_FILE_FAILED) {
+            // the write may have created the file
+            mfile.state = MAPPED_FILE_WANT_MAP;
+        }
+    }
+}
+
+/********************************************************
+The functions below run in the IO timer context. The IO timer owns a
+mapped_file when its state is MAPPED_FILE_WANT_MAP or
+MAPPED_FILE_WANT_REMAP, otherwise the main thread owns it.
+*********************************************************/
+
+/*
+  map any degree files requested by the main thread
+ */
+void AP_Terrain::update_mapped_files(void)
+{
+    for (struct mapped_file &mfile : mapped_files) {
+        if (mfile.state == MAPPED_FILE_WANT_MAP ||
+            mfile.state == MAPPED_FILE_WANT_REMAP) {
+            map_file(mfile);
+        }
+    }
+}
+
+/*
+  map the whole of a degree file and set up its block index
+ */
+void AP_Terrain::map_file(struct mapped_file &mfile)
+{
+    unmap_file(mfile);
+
+    if (!set_file_path(mfile.lat_degrees, mfile.lon_degrees)) {
+        mfile.failed_ms = AP_HAL::millis();
+        mfile.state = MAPPED_FILE_FAILED;
+        return;
+    }
+
+    // the mapping remains valid after the file is closed
+    const int mfd = ::open(file_path, O_RDONLY|O_CLOEXEC);
+    if (mfd == -1) {
+        mfile.failed_ms = AP_HAL::millis();
+        mfile.state = MAPPED_FILE_FAILED;
+        return;
+    }
+    struct stat st;
+    uint32_t num_blocks = 0;
+    if (::fstat(mfd, &st) == 0) {
+        num_blocks = st.st_size / sizeof(union grid_io_block);
+    }
+    void *base = nullptr;
+    if (num_blocks > 0) {
+        base = ::mmap(nullptr, num_blocks * sizeof(union grid_io_block), PROT_READ, MAP_SHARED, mfd, 0);
+    }
+    ::close(mfd);
+    if (base == MAP_FAILED) {
+#if TERRAIN_DEBUG
+        hal.console->printf("mmap %s failed - %s\n", file_path, strerror(errno));
+#endif
+        mfile.failed_ms = AP_HAL::millis();
+        mfile.state = MAPPED_FILE_FAILED;
+        return;
+    }
+
+    uint64_t *block_bitmaps = nullptr;
+    if (num_blocks > 0) {
+        block_bitmaps = (uint64_t *)malloc(num_blocks * sizeof(block_bitmaps[0]));
+        if (block_bitmaps == nullptr) {
+            ::munmap(base, num_blocks * sizeof(union grid_io_block));
+            mfile.failed_ms = AP_HAL::millis();
+            mfile.state = MAPPED_FILE_FAILED;
+            return;
+        }
+        memset(block_bitmaps, 0xFF, num_blocks * sizeof(block_bitmaps[0]));
+
+        // start reading the file into the page cache so lookups from
+        // the main thread rarely fault on the disk
+        ::madvise(base, num_blocks * sizeof(union grid_io_block), MADV_WILLNEED);
+    }
+
+    mfile.base = (const uint8_t *)base;
+    mfile.num_blocks = num_blocks;
+    mfile.block_bitmaps = block_bitmaps;
+    mfile.state = MAPPED_FILE_READY;
+}
+
+/*
+  release the mapping and block index of a degree file
+ */
+void AP_Terrain::unmap_file(struct mapped_file &mfile)
+{
+    if (mfile.base != nullptr) {
+        ::munmap((void *)mfile.base, mfile.num_blocks * sizeof(union grid_io_block));
+        mfile.base = nullptr;
+    }
+    free(mfile.block_bitmaps);
+    mfile.block_bitmaps = nullptr;
+    mfile.num_blocks = 0;
+}
+
+#endif // AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
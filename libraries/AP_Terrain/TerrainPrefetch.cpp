@@ -0,0 +1,191 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  prefetch terrain blocks along the predicted path of the vehicle
+ */
+
+#include "AP_Terrain.h"
+
+#if AP_TERRAIN_AVAILABLE
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Mission/AP_Mission.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  load blocks on the predicted path of the vehicle into the cache
+  ahead of time. The path is the current velocity projected forward
+  plus the next few legs of a running mission. Blocks are loaded in
+  order of the time until they are needed, using at most a quarter of
+  the cache and stopping while disk reads are outstanding. Blocks
+  loaded into the cache are also requested from the GCS if they are
+  not on disk
+ */
+void AP_Terrain::update_prefetch(const Location &loc)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_prefetch_ms < TERRAIN_PREFETCH_INTERVAL_MS) {
+        return;
+    }
+    last_prefetch_ms = now_ms;
+
+    struct prefetch_point points[TERRAIN_PREFETCH_MAX_POINTS];
+    uint8_t num_points = 0;
+
+    Vector3f vel;
+    if (!AP::ahrs().get_velocity_NED(vel)) {
+        vel.zero();
+    }
+    const float speed = vel.xy().length();
+
+    // project the current velocity
+    if (speed >= TERRAIN_PREFETCH_MIN_SPEED) {
+        Location end = loc;
+        end.offset(vel.x * TERRAIN_PREFETCH_TIME_S, vel.y * TERRAIN_PREFETCH_TIME_S);
+        float time_s = 0;
+        add_prefetch_path(loc, end, speed, time_s, points, num_points);
+    }
+
+#if AP_MISSION_ENABLED
+    // follow the upcoming mission legs
+    const AP_Mission *mission = AP::mission();
+    if (mission != nullptr && mission->state() == AP_Mission::MISSION_RUNNING) {
+        const float leg_speed = MAX(speed, TERRAIN_PREFETCH_MIN_SPEED);
+        Location leg_start = loc;
+        float time_s = 0;
+        uint8_t legs = 0;
+        uint16_t index = mission->get_current_nav_index();
+        // don't read more than 20 commands, to prevent too much CPU usage
+        for (uint8_t i=0; i<20 && legs < TERRAIN_PREFETCH_MAX_LEGS; i++, index++) {
+            AP_Mission::Mission_Command cmd;
+            if (!mission->read_cmd_from_storage(index, cmd)) {
+                break;
+            }
+            if ((cmd.id != MAV_CMD_NAV_WAYPOINT &&
+                 cmd.id != MAV_CMD_NAV_SPLINE_WAYPOINT) ||
+                (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+                continue;
+            }
+            if (!add_prefetch_path(leg_start, cmd.content.location, leg_speed, time_s, points, num_points)) {
+                break;
+            }
+            leg_start = cmd.content.location;
+            legs++;
+        }
+    }
+#endif
+
+    // most urgent first
+    for (uint8_t i=1; i<num_points; i++) {
+        const struct prefetch_point p = points[i];
+        uint8_t j = i;
+        while (j > 0 && points[j-1].time_s > p.time_s) {
+            points[j] = points[j-1];
+            j--;
+        }
+        points[j] = p;
+    }
+
+    uint16_t diskwait = 0;
+    for (uint16_t i=0; i<cache_size; i++) {
+        if (cache[i].state == GRID_CACHE_DISKWAIT) {
+            diskwait++;
+        }
+    }
+
+    // load each block once, leaving most of the cache for the blocks
+    // around the vehicle
+    int32_t loaded_lat[TERRAIN_PREFETCH_MAX_POINTS];
+    int32_t loaded_lon[TERRAIN_PREFETCH_MAX_POINTS];
+    uint8_t num_loaded = 0;
+    const uint8_t max_loaded = MIN(cache_size / 4, TERRAIN_PREFETCH_MAX_POINTS);
+    for (uint8_t i=0; i<num_points && num_loaded < max_loaded && diskwait < TERRAIN_PREFETCH_MAX_DISKWAIT; i++) {
+        struct grid_info info;
+        calculate_grid_info(points[i].loc, info);
+        bool already_loaded = false;
+        for (uint8_t j=0; j<num_loaded; j++) {
+            if (loaded_lat[j] == info.grid_lat && loaded_lon[j] == info.grid_lon) {
+                already_loaded = true;
+                break;
+            }
+        }
+        if (already_loaded) {
+            continue;
+        }
+        loaded_lat[num_loaded] = info.grid_lat;
+        loaded_lon[num_loaded] = info.grid_lon;
+        num_loaded++;
+        if (find_grid_cache(info).state == GRID_CACHE_DISKWAIT) {
+            diskwait++;
+        }
+    }
+}
+
+/*
+  add points along a straight path to a prefetch list, at intervals of
+  half a block. time_s is the time the vehicle reaches start, and is
+  updated to the time it reaches end. Returns false once the time
+  horizon or the list is full
+ */
+bool AP_Terrain::add_prefetch_path(const Location &start, const Location &end, float speed, float &time_s,
+                                   struct prefetch_point *points, uint8_t &num_points) const
+{
+    const Vector2f leg = start.get_distance_NE(end);
+    const float length = leg.length();
+    const float step = 0.5f * TERRAIN_GRID_BLOCK_SPACING_X * grid_spacing;
+    if (!is_positive(speed) || !is_positive(step)) {
+        return false;
+    }
+    for (float dist = step; dist < length + step; dist += step) {
+        const float d = MIN(dist, length);
+        const float t = time_s + d / speed;
+        if (t > TERRAIN_PREFETCH_TIME_S || num_points >= TERRAIN_PREFETCH_MAX_POINTS) {
+            return false;
+        }
+        struct prefetch_point &p = points[num_points++];
+        p.loc = start;
+        if (is_positive(length)) {
+            p.loc.offset(leg.x * d / length, leg.y * d / length);
+        }
+        p.time_s = t;
+    }
+    time_s += length / speed;
+    return true;
+}
+
+/*
+  count blocks that were not loaded when the vehicle reached them
+  while armed. Each block is counted at most once each time it is
+  entered
+ */
+void AP_Terrain::update_late_blocks(const Location &loc, bool terrain_valid)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+    if (info.grid_lat == last_block_lat && info.grid_lon == last_block_lon) {
+        return;
+    }
+    if (!terrain_valid && hal.util->get_soft_armed()) {
+        late_blocks++;
+    }
+    last_block_lat = info.grid_lat;
+    last_block_lon = info.grid_lon;
+}
+
+#endif // AP_TERRAIN_AVAILABLE
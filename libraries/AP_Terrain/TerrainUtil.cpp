@@ -42,13 +42,23 @@ uint8_t AP_Terrain::grid_bitnum(uint8_t idx_x, uint8_t idx_y)
 }
 
 /*
-  given a grid_info check that a given idx_x/idx_y is available (set
-  in the bitmap)
+  check that a given idx_x/idx_y is available (set in the bitmap)
  */
-bool AP_Terrain::check_bitmap(const struct grid_block &grid, uint8_t idx_x, uint8_t idx_y)
+bool AP_Terrain::check_bitmap(uint64_t bitmap, uint8_t idx_x, uint8_t idx_y)
 {
     uint8_t bitnum = grid_bitnum(idx_x, idx_y);
-    return (grid.bitmap & (((uint64_t)1U)<<bitnum)) != 0;
+    return (bitmap & (((uint64_t)1U)<<bitnum)) != 0;
+}
+
+/*
+  check that all 4 heights surrounding a grid_info are available
+ */
+bool AP_Terrain::have_heights(uint64_t bitmap, const struct grid_info &info)
+{
+    return check_bitmap(bitmap, info.idx_x,   info.idx_y) &&
+           check_bitmap(bitmap, info.idx_x,   info.idx_y+1) &&
+           check_bitmap(bitmap, info.idx_x+1, info.idx_y) &&
+           check_bitmap(bitmap, info.idx_x+1, info.idx_y+1);
 }
 
 /*
@@ -106,25 +116,21 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
  */
 AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
     // see if we have that grid
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
-            TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
-            cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = AP_HAL::millis();
-            return cache[i];
-        }
-        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
-            oldest_i = i;
-        }
+    const int16_t found = cache_hash_find(info);
+    if (found != -1) {
+        lru_touch(found);
+        return cache[found];
     }
 
-    // Not found. Use the oldest grid and make it this grid,
-    // initially unpopulated
-    struct grid_cache &grid = cache[oldest_i];
-    memset(&grid, 0, sizeof(grid));
+    // Not found. Use the least recently used grid and make it this
+    // grid, initially unpopulated
+    const uint16_t idx = lru_tail;
+    struct grid_cache &grid = cache[idx];
+    if (grid.state != GRID_CACHE_INVALID) {
+        cache_hash_remove(idx);
+    }
+    memset(&grid.grid, 0, sizeof(grid.grid));
 
     grid.grid.lat = info.grid_lat;
     grid.grid.lon = info.grid_lon;
@@ -134,7 +140,23 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     grid.grid.lat_degrees = info.lat_degrees;
     grid.grid.lon_degrees = info.lon_degrees;
     grid.grid.version = TERRAIN_GRID_FORMAT_VERSION;
-    grid.last_access_ms = AP_HAL::millis();
+    cache_hash_insert(idx);
+    lru_touch(idx);
+
+#if AP_TERRAIN_MMAP_ENABLED
+    // if the degree file is mapped then the block can be filled in
+    // now rather than waiting for a disk read
+    const struct grid_block *mapped;
+    uint64_t bitmap;
+    if (find_mapped_block(info, mapped, bitmap)) {
+        if (mapped != nullptr) {
+            set_cache_grid(grid, *mapped);
+            grid.grid.bitmap = bitmap;
+        }
+        grid.state = GRID_CACHE_VALID;
+        return grid;
+    }
+#endif
 
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
@@ -142,6 +164,144 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     return grid;
 }
 
+/*
+  first slot to probe in the cache hash for a block
+ */
+uint16_t AP_Terrain::cache_hash_slot(int8_t lat_degrees, int16_t lon_degrees,
+                                     uint16_t grid_idx_x, uint16_t grid_idx_y, uint16_t spacing) const
+{
+    // blocks next to each other differ in the low bits of their
+    // indices, so mix those well
+    uint32_t h = uint8_t(lat_degrees);
+    h = h*31 + uint16_t(lon_degrees);
+    h = h*31 + spacing;
+    h = h*73856093U ^ grid_idx_x*19349663U ^ grid_idx_y*83492791U;
+    h ^= h >> 16;
+    return h & (cache_hash_size - 1);
+}
+
+/*
+  find the cache index of a block, or -1 if it is not in the cache
+ */
+int16_t AP_Terrain::cache_hash_find(const struct grid_info &info) const
+{
+    const uint16_t mask = cache_hash_size - 1;
+    uint16_t slot = cache_hash_slot(info.lat_degrees, info.lon_degrees,
+                                    info.grid_idx_x, info.grid_idx_y, grid_spacing);
+    // the hash is at most half full, so there is always an empty slot
+    while (cache_hash[slot] != 0) {
+        const uint16_t idx = cache_hash[slot] - 1;
+        const struct grid_block &grid = cache[idx].grid;
+        if (grid.grid_idx_x == info.grid_idx_x &&
+            grid.grid_idx_y == info.grid_idx_y &&
+            grid.lat_degrees == info.lat_degrees &&
+            grid.lon_degrees == info.lon_degrees &&
+            grid.spacing == grid_spacing) {
+            return idx;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+/*
+  add a cache block to the hash
+ */
+void AP_Terrain::cache_hash_insert(uint16_t idx)
+{
+    const uint16_t mask = cache_hash_size - 1;
+    const struct grid_block &grid = cache[idx].grid;
+    uint16_t slot = cache_hash_slot(grid.lat_degrees, grid.lon_degrees,
+                                    grid.grid_idx_x, grid.grid_idx_y, grid.spacing);
+    while (cache_hash[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    cache_hash[slot] = idx + 1;
+}
+
+/*
+  remove a cache block from the hash. Later blocks in the same run
+  of slots are shifted back so that lookups never stop early at the
+  emptied slot
+ */
+void AP_Terrain::cache_hash_remove(uint16_t idx)
+{
+    const uint16_t mask = cache_hash_size - 1;
+    const struct grid_block &grid = cache[idx].grid;
+    uint16_t slot = cache_hash_slot(grid.lat_degrees, grid.lon_degrees,
+                                    grid.grid_idx_x, grid.grid_idx_y, grid.spacing);
+    while (cache_hash[slot] != idx + 1) {
+        if (cache_hash[slot] == 0) {
+            // not in the hash
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    uint16_t next = slot;
+    while (true) {
+        next = (next + 1) & mask;
+        if (cache_hash[next] == 0) {
+            break;
+        }
+        const struct grid_block &g = cache[cache_hash[next] - 1].grid;
+        const uint16_t home = cache_hash_slot(g.lat_degrees, g.lon_degrees,
+                                              g.grid_idx_x, g.grid_idx_y, g.spacing);
+        // move the entry back if the emptied slot is no further from
+        // its home slot than where it is now
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            cache_hash[slot] = cache_hash[next];
+            slot = next;
+        }
+    }
+    cache_hash[slot] = 0;
+}
+
+/*
+  move a cache block to the front of the LRU list
+ */
+void AP_Terrain::lru_touch(uint16_t idx)
+{
+    if (idx == lru_head) {
+        return;
+    }
+    struct grid_cache &gcache = cache[idx];
+
+    // unlink
+    cache[gcache.lru_prev].lru_next = gcache.lru_next;
+    if (idx == lru_tail) {
+        lru_tail = gcache.lru_prev;
+    } else {
+        cache[gcache.lru_next].lru_prev = gcache.lru_prev;
+    }
+
+    // and link in at the front
+    gcache.lru_next = lru_head;
+    cache[lru_head].lru_prev = idx;
+    lru_head = idx;
+}
+
+/*
+  copy a block read from disk or a mapped file into the cache. The
+  position fields are kept from the cache block as they are the key
+  in the cache hash and the stored copy may have been made with a
+  slightly different lat/lon scaling
+ */
+void AP_Terrain::set_cache_grid(struct grid_cache &gcache, const struct grid_block &block)
+{
+    const uint16_t spacing = gcache.grid.spacing;
+    const uint16_t grid_idx_x = gcache.grid.grid_idx_x;
+    const uint16_t grid_idx_y = gcache.grid.grid_idx_y;
+    const int8_t lat_degrees = gcache.grid.lat_degrees;
+    const int16_t lon_degrees = gcache.grid.lon_degrees;
+    gcache.grid = block;
+    gcache.grid.spacing = spacing;
+    gcache.grid.grid_idx_x = grid_idx_x;
+    gcache.grid.grid_idx_y = grid_idx_y;
+    gcache.grid.lat_degrees = lat_degrees;
+    gcache.grid.lon_degrees = lon_degrees;
+}
+
 /*
   find cache index of disk_block
  */
@@ -166,15 +326,16 @@ int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
 }
 
 /*
-  get CRC for a block
+  get CRC for a block, taken with crc=0
  */
-uint16_t AP_Terrain::get_block_crc(struct grid_block &block)
+uint16_t AP_Terrain::get_block_crc(const struct grid_block &block) const
 {
-    uint16_t saved_crc = block.crc;
-    block.crc = 0;
-    uint16_t ret = crc16_ccitt((const uint8_t *)&block, sizeof(block), 0);
-    block.crc = saved_crc;
-    return ret;
+    const uint8_t *b = (const uint8_t *)&block;
+    const uint8_t zero_crc[sizeof(block.crc)] {};
+    const size_t crc_ofs = offsetof(struct grid_block, crc);
+    uint16_t ret = crc16_ccitt(b, crc_ofs, 0);
+    ret = crc16_ccitt(zero_crc, sizeof(zero_crc), ret);
+    return crc16_ccitt(&b[crc_ofs+sizeof(block.crc)], sizeof(block)-(crc_ofs+sizeof(block.crc)), ret);
 }
 
 #endif // AP_TERRAIN_AVAILABLE
@@ -0,0 +1,145 @@
+#include "SlidingQuantileFilter.h"
+
+#include <AP_Math/AP_Math.h>
+
+void SlidingQuantileFilter::set_window(uint8_t _window, float _quantile)
+{
+    window = constrain_int16(_window, 1, SLIDING_QUANTILE_FILTER_MAX);
+    quantile = constrain_float(_quantile, 0, 1);
+    reset();
+}
+
+void SlidingQuantileFilter::reset()
+{
+    lo_size = 0;
+    hi_size = 0;
+    oldest = 0;
+    output = 0;
+}
+
+uint8_t SlidingQuantileFilter::lo_target(uint8_t n) const
+{
+    if (n == 0) {
+        return 0;
+    }
+    return MIN(uint8_t(quantile * (n - 1)) + 1, n);
+}
+
+void SlidingQuantileFilter::heap_set(bool lo, uint8_t i, uint8_t slot)
+{
+    if (lo) {
+        lo_heap[i] = slot;
+        where[slot] = HEAP_LO | i;
+    } else {
+        hi_heap[i] = slot;
+        where[slot] = i;
+    }
+}
+
+void SlidingQuantileFilter::sift_up(bool lo, uint8_t i)
+{
+    uint8_t *heap = lo ? lo_heap : hi_heap;
+    const uint8_t slot = heap[i];
+    while (i > 0) {
+        const uint8_t parent = (i - 1) / 2;
+        if (!(lo ? lo_less(slot, heap[parent]) : hi_less(slot, heap[parent]))) {
+            break;
+        }
+        heap_set(lo, i, heap[parent]);
+        i = parent;
+    }
+    heap_set(lo, i, slot);
+}
+
+void SlidingQuantileFilter::sift_down(bool lo, uint8_t i)
+{
+    uint8_t *heap = lo ? lo_heap : hi_heap;
+    const uint8_t size = lo ? lo_size : hi_size;
+    const uint8_t slot = heap[i];
+    while (true) {
+        uint8_t child = 2 * i + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size &&
+            (lo ? lo_less(heap[child+1], heap[child]) : hi_less(heap[child+1], heap[child]))) {
+            child++;
+        }
+        if (!(lo ? lo_less(heap[child], slot) : hi_less(heap[child], slot))) {
+            break;
+        }
+        heap_set(lo, i, heap[child]);
+        i = child;
+    }
+    heap_set(lo, i, slot);
+}
+
+void SlidingQuantileFilter::push(bool lo, uint8_t slot)
+{
+    const uint8_t i = lo ? lo_size++ : hi_size++;
+    heap_set(lo, i, slot);
+    sift_up(lo, i);
+}
+
+uint8_t SlidingQuantileFilter::pop(bool lo)
+{
+    uint8_t *heap = lo ? lo_heap : hi_heap;
+    const uint8_t top = heap[0];
+    const uint8_t last = heap[lo ? --lo_size : --hi_size];
+    if (top != last) {
+        heap_set(lo, 0, last);
+        sift_down(lo, 0);
+    }
+    return top;
+}
+
+// exchange the tops of the two heaps, for when replacing a sample has
+// left the largest of the low samples above the smallest high sample
+void SlidingQuantileFilter::swap_tops()
+{
+    const uint8_t lo_top = lo_heap[0];
+    const uint8_t hi_top = hi_heap[0];
+    heap_set(true, 0, hi_top);
+    heap_set(false, 0, lo_top);
+    sift_down(true, 0);
+    sift_down(false, 0);
+}
+
+float SlidingQuantileFilter::apply(float sample)
+{
+    if (isnan(sample)) {
+        // would break the heap ordering
+        return output;
+    }
+
+    const uint8_t n = count();
+    if (n < window) {
+        // still filling: slots are used in order, so slot 0 is the
+        // oldest once the window is full
+        const uint8_t slot = n;
+        value[slot] = sample;
+        push(lo_size == 0 || sample <= value[lo_heap[0]], slot);
+        const uint8_t k = lo_target(n + 1);
+        while (lo_size > k) {
+            push(false, pop(true));
+        }
+        while (lo_size < k) {
+            push(true, pop(false));
+        }
+    } else {
+        // overwrite the oldest sample in place; only its own heap and
+        // the boundary between the heaps can be out of order
+        const uint8_t slot = oldest;
+        oldest = (oldest + 1) % window;
+        value[slot] = sample;
+        const bool lo = where[slot] & HEAP_LO;
+        sift_up(lo, where[slot] & ~HEAP_LO);
+        sift_down(lo, where[slot] & ~HEAP_LO);
+        if (lo_size > 0 && hi_size > 0 && value[lo_heap[0]] > value[hi_heap[0]]) {
+            swap_tops();
+        }
+    }
+
+    output = value[lo_heap[0]];
+    return output;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+  sliding window quantile (e.g. median) filter.
+
+  The window is split between a max-heap holding the lowest k samples
+  and a min-heap holding the rest, so the quantile is the top of the
+  low heap. Both heaps are indexed by ring slot, which lets the oldest
+  sample be replaced in place by the new one, so each sample costs
+  O(log n) with no sorting and no allocation. Storage is fixed at
+  SLIDING_QUANTILE_FILTER_MAX samples; the window length can be
+  anything up to that and changed at runtime.
+ */
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+
+#define SLIDING_QUANTILE_FILTER_MAX 64
+
+class SlidingQuantileFilter {
+public:
+    SlidingQuantileFilter() {}
+
+    CLASS_NO_COPY(SlidingQuantileFilter);
+
+    // set the window length and the quantile in the range 0 to 1,
+    // where 0.5 is the median. Clears the filter
+    void set_window(uint8_t window, float quantile=0.5f);
+
+    uint8_t get_window() const { return window; }
+
+    // add a sample and return the quantile of the samples in the window
+    float apply(float sample);
+
+    // latest filtered value
+    float get() const { return output; }
+
+    // number of samples currently in the window
+    uint8_t count() const { return lo_size + hi_size; }
+
+    // discard all samples
+    void reset();
+
+private:
+    static constexpr uint8_t HEAP_LO = 0x80;
+
+    // number of samples the low heap holds when there are n in total
+    uint8_t lo_target(uint8_t n) const;
+
+    bool lo_less(uint8_t a, uint8_t b) const { return value[a] > value[b]; }
+    bool hi_less(uint8_t a, uint8_t b) const { return value[a] < value[b]; }
+
+    void heap_set(bool lo, uint8_t i, uint8_t slot);
+    void sift_up(bool lo, uint8_t i);
+    void sift_down(bool lo, uint8_t i);
+    void push(bool lo, uint8_t slot);
+    uint8_t pop(bool lo);
+    void swap_tops();
+
+    float value[SLIDING_QUANTILE_FILTER_MAX] {};
+
+    // heap entries are ring slots; the low heap is a max-heap, the
+    // high heap a min-heap
+    uint8_t lo_heap[SLIDING_QUANTILE_FILTER_MAX] {};
+    uint8_t hi_heap[SLIDING_QUANTILE_FILTER_MAX] {};
+    uint8_t lo_size = 0;
+    uint8_t hi_size = 0;
+
+    // where each slot is: HEAP_LO set for the low heap, plus the index
+    uint8_t where[SLIDING_QUANTILE_FILTER_MAX] {};
+
+    // slot holding the oldest sample once the window is full
+    uint8_t oldest = 0;
+
+    uint8_t window = 1;
+    float quantile = 0.5f;
+    float output = 0;
+};
@@ -0,0 +1,77 @@
+#include <AP_gtest.h>
+
+#include <Filter/SlidingQuantileFilter.h>
+#include <AP_Math/AP_Math.h>
+
+#include <stdlib.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// quantile of the last n samples by sorting, as the filter defines it
+static float brute_force(const float *samples, uint32_t end, uint8_t n, float quantile)
+{
+    float sorted[SLIDING_QUANTILE_FILTER_MAX];
+    for (uint8_t i=0; i<n; i++) {
+        sorted[i] = samples[end - n + i];
+    }
+    for (uint8_t i=1; i<n; i++) {
+        for (uint8_t j=i; j>0 && sorted[j-1] > sorted[j]; j--) {
+            const float t = sorted[j];
+            sorted[j] = sorted[j-1];
+            sorted[j-1] = t;
+        }
+    }
+    return sorted[uint8_t(quantile * (n - 1))];
+}
+
+TEST(SlidingQuantileFilterTest, Median5)
+{
+    SlidingQuantileFilter filt;
+    filt.set_window(5);
+    EXPECT_FLOAT_EQ(1, filt.apply(1));
+    EXPECT_FLOAT_EQ(1, filt.apply(3));
+    EXPECT_FLOAT_EQ(2, filt.apply(2));
+    EXPECT_FLOAT_EQ(2, filt.apply(100));
+    EXPECT_FLOAT_EQ(3, filt.apply(4));
+    // 1 drops out of the window
+    EXPECT_FLOAT_EQ(3, filt.apply(-50));
+    EXPECT_FLOAT_EQ(4, filt.apply(5));
+    EXPECT_FLOAT_EQ(4, filt.get());
+    EXPECT_EQ(5, filt.count());
+
+    filt.reset();
+    EXPECT_EQ(0, filt.count());
+    EXPECT_FLOAT_EQ(7, filt.apply(7));
+}
+
+TEST(SlidingQuantileFilterTest, MatchesSort)
+{
+    static const uint8_t windows[] { 1, 2, 3, 8, 31, 64 };
+    static const float quantiles[] { 0, 0.1f, 0.5f, 0.9f, 1 };
+    float samples[500];
+    srandom(1);
+    for (float q : quantiles) {
+        for (uint8_t w : windows) {
+            SlidingQuantileFilter filt;
+            filt.set_window(w, q);
+            for (uint32_t i=0; i<ARRAY_SIZE(samples); i++) {
+                // include plenty of repeated values
+                samples[i] = (random() % 200) * 0.05f;
+                const float out = filt.apply(samples[i]);
+                const uint8_t n = MIN(i+1, uint32_t(w));
+                EXPECT_FLOAT_EQ(brute_force(samples, i+1, n, q), out);
+            }
+        }
+    }
+}
+
+TEST(SlidingQuantileFilterTest, RejectsNaN)
+{
+    SlidingQuantileFilter filt;
+    filt.set_window(3);
+    filt.apply(1);
+    EXPECT_FLOAT_EQ(1, filt.apply(nanf("")));
+    EXPECT_EQ(1, filt.count());
+}
+
+AP_GTEST_MAIN()